@@ -0,0 +1,224 @@
+// Hossein Moein
+// October 18, 2026
+/*
+Copyright (c) 2023-2028, Hossein Moein
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+* Neither the name of Hossein Moein and/or the Leopard nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL Hossein Moein BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <Leopard/ThreadPool.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <future>
+#include <iostream>
+#include <new>
+#include <vector>
+
+using namespace hmthrp;
+using namespace std::chrono;
+
+// ----------------------------------------------------------------------------
+
+// Count every heap allocation in the process.
+// They are not inlined, so the compiler sees matching new/delete calls.
+//
+static std::atomic<std::size_t> ALLOC_COUNT { 0 };
+
+#if defined(__GNUC__)
+#  define BENCH_NOINLINE __attribute__((noinline))
+#else
+#  define BENCH_NOINLINE
+#endif // __GNUC__
+
+BENCH_NOINLINE void *operator new (std::size_t size)  {
+
+    ALLOC_COUNT.fetch_add(1, std::memory_order_relaxed);
+    if (void *ptr = ::malloc(size ? size : 1))
+        return (ptr);
+    throw std::bad_alloc { };
+}
+
+BENCH_NOINLINE void operator delete (void *ptr) noexcept  { ::free(ptr); }
+BENCH_NOINLINE void operator delete (void *ptr, std::size_t) noexcept  {
+
+    ::free(ptr);
+}
+
+// ----------------------------------------------------------------------------
+
+static std::atomic<std::size_t> TASK_COUNT { 0 };
+
+// ----------------------------------------------------------------------------
+
+static void report(const char *name, std::size_t n, std::size_t allocs,
+                   high_resolution_clock::time_point first,
+                   high_resolution_clock::time_point second)  {
+
+    const double    nanos =
+        double(duration_cast<nanoseconds>(second - first).count());
+
+    std::cout << name << ": " << double(allocs) / double(n)
+              << " allocations/dispatch -- " << nanos / double(n)
+              << " ns/dispatch" << std::endl;
+}
+
+// ----------------------------------------------------------------------------
+
+// Dispatch and wait for each task in turn. The futures are recycled, so the
+// steady state number of allocations is what a dispatch costs.
+//
+template<typename F>
+static void measure(const char *name, ThreadPool &thr_pool, F &&routine)  {
+
+    constexpr std::size_t   warm_up { 10'000 };
+    constexpr std::size_t   n { 500'000 };
+    constexpr std::size_t   batch { 64 };
+
+    std::vector<std::future<void>>  futs;
+
+    futs.reserve(batch);
+
+    auto    run = [&thr_pool, &routine, &futs](std::size_t count) -> void  {
+        for (std::size_t i = 0; i < count; i += batch)  {
+            for (std::size_t j = 0; j < batch; ++j)
+                futs.push_back(thr_pool.dispatch(false, routine, i + j));
+            // The last one is likely the last to finish, so the rest don't
+            // block
+            //
+            for (auto riter = futs.rbegin(); riter != futs.rend(); ++riter)
+                riter->get();
+            futs.clear();
+        }
+    };
+
+    run(warm_up);
+
+    const std::size_t   allocs_before { ALLOC_COUNT.load() };
+    const auto          first = high_resolution_clock::now();
+
+    run(n);
+
+    const auto          second = high_resolution_clock::now();
+    const std::size_t   allocs_after { ALLOC_COUNT.load() };
+
+    report(name, n, allocs_after - allocs_before, first, second);
+}
+
+// ----------------------------------------------------------------------------
+
+// Same as measure() with post() instead of dispatch()
+//
+template<typename F>
+static void
+measure_post(const char *name, ThreadPool &thr_pool, F &&routine)  {
+
+    constexpr std::size_t   warm_up { 10'000 };
+    constexpr std::size_t   n { 500'000 };
+    constexpr std::size_t   batch { 64 };
+
+    std::atomic<std::size_t>    done { 0 };
+    std::promise<void>          batch_done { };
+
+    auto    run = [&thr_pool, &routine, &done, &batch_done]
+                  (std::size_t count) -> void  {
+        for (std::size_t i = 0; i < count; i += batch)  {
+            done = 0;
+            batch_done = std::promise<void> {
+                std::allocator_arg, RecyclingAllocator<char> { }
+            };
+
+            std::future<void>   fut { batch_done.get_future() };
+
+            for (std::size_t j = 0; j < batch; ++j)
+                thr_pool.post([&routine, &done, &batch_done]
+                              (std::size_t v) -> void  {
+                                  routine(v);
+                                  if (done.fetch_add(1) + 1 == batch)
+                                      batch_done.set_value();
+                              },
+                              i + j);
+            fut.get();
+        }
+    };
+
+    run(warm_up);
+
+    const std::size_t   allocs_before { ALLOC_COUNT.load() };
+    const auto          first = high_resolution_clock::now();
+
+    run(n);
+
+    const auto          second = high_resolution_clock::now();
+    const std::size_t   allocs_after { ALLOC_COUNT.load() };
+
+    report(name, n, allocs_after - allocs_before, first, second);
+}
+
+// ----------------------------------------------------------------------------
+
+struct  Payload  {
+
+    std::size_t v1 { 0 };
+    std::size_t v2 { 0 };
+    std::size_t v3 { 0 };
+};
+
+// ----------------------------------------------------------------------------
+
+int main (int argc, char *argv[])  {
+
+    ThreadPool  thr_pool (argc > 1 ? ::atol(argv[1])
+                                   : std::thread::hardware_concurrency());
+
+    std::cout << "Thread pool capacity: " << thr_pool.capacity_threads()
+              << std::endl;
+
+    measure("Function pointer", thr_pool,
+            [](std::size_t) -> void { ++TASK_COUNT; });
+
+    const Payload   payload { 1, 2, 3 };
+
+    measure("Lambda with captures", thr_pool,
+            [payload](std::size_t i) -> void {
+                TASK_COUNT += payload.v1 + payload.v2 + payload.v3 + i;
+            });
+    measure_post("Posted function pointer", thr_pool,
+                 [](std::size_t) -> void { ++TASK_COUNT; });
+    measure_post("Posted lambda with captures", thr_pool,
+                 [payload](std::size_t i) -> void {
+                     TASK_COUNT += payload.v1 + payload.v2 + payload.v3 + i;
+                 });
+
+    return (EXIT_SUCCESS);
+}
+
+// ----------------------------------------------------------------------------
+
+// Local Variables:
+// mode:C++
+// tab-width:4
+// c-basic-offset:4
+// End:
@@ -0,0 +1,269 @@
+// Hossein Moein
+// October 18, 2026
+/*
+Copyright (c) 2023-2028, Hossein Moein
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+* Neither the name of Hossein Moein and/or the Leopard nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL Hossein Moein BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <Leopard/ThreadPool.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <future>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace hmthrp;
+using namespace std::chrono;
+
+// ----------------------------------------------------------------------------
+
+static std::atomic<std::size_t> NODE_COUNT { 0 };
+
+// ----------------------------------------------------------------------------
+
+static void report(const char *name, std::size_t nodes,
+                   high_resolution_clock::time_point first,
+                   high_resolution_clock::time_point second)  {
+
+    const double    secs =
+        double(duration_cast<nanoseconds>(second - first).count()) / 1e9;
+
+    std::cout << name << ": " << nodes << " nodes in " << secs << " secs -- "
+              << std::size_t(double(nodes) / secs) << " nodes/sec"
+              << std::endl;
+}
+
+// ----------------------------------------------------------------------------
+
+// Some busy work of the given size
+//
+static void work(std::size_t iterations)  {
+
+    volatile std::size_t    sink { 0 };
+
+    for (std::size_t i = 0; i < iterations; ++i)
+        sink = sink + i * i;
+    NODE_COUNT += 1;
+}
+
+// ----------------------------------------------------------------------------
+
+// Layers of nodes, each depending on a few random nodes of the layer above,
+// with uneven amounts of work
+//
+struct  LayeredDag  {
+
+    static constexpr std::size_t    layers { 100 };
+    static constexpr std::size_t    width { 100 };
+    static constexpr std::size_t    fan_in { 3 };
+
+    LayeredDag()  {
+
+        std::mt19937    gen { 4321 };
+
+        costs.resize(layers * width);
+        preds.resize(layers * width);
+        for (std::size_t i = 0; i < costs.size(); ++i)  {
+            costs[i] = gen() % 4000;
+            for (std::size_t e = 0; i >= width && e < fan_in; ++e)
+                preds[i].push_back((i / width - 1) * width + gen() % width);
+        }
+    }
+
+    std::vector<std::size_t>                costs { };
+    std::vector<std::vector<std::size_t>>   preds { };
+};
+
+// ----------------------------------------------------------------------------
+
+// Each node starts as soon as its own predecessors are done
+//
+static void layered_graph(ThreadPool &thr_pool, const LayeredDag &dag)  {
+
+    constexpr std::size_t   rounds { 20 };
+    TaskGraph               graph;
+
+    graph.reserve(dag.costs.size());
+    for (std::size_t i = 0; i < dag.costs.size(); ++i)  {
+        graph.add_node([cost = dag.costs[i]]() -> void  { work(cost); });
+        for (const std::size_t p : dag.preds[i])
+            graph.add_edge(p, i);
+    }
+
+    NODE_COUNT = 0;
+
+    const auto  first = high_resolution_clock::now();
+
+    for (std::size_t i = 0; i < rounds; ++i)
+        thr_pool.run_graph(graph);
+
+    const auto  second = high_resolution_clock::now();
+
+    report("layered_graph()", graph.nodes() * rounds, first, second);
+    if (NODE_COUNT != graph.nodes() * rounds)  {
+        std::cout << "ERROR: layered_graph() lost nodes" << std::endl;
+        ::exit(EXIT_FAILURE);
+    }
+}
+
+// --------------------------------------
+
+// The same dependencies without a graph: a whole layer is dispatched and
+// waited for, before the next one starts
+//
+static void layered_barrier(ThreadPool &thr_pool, const LayeredDag &dag)  {
+
+    constexpr std::size_t   rounds { 20 };
+
+    NODE_COUNT = 0;
+
+    const auto  first = high_resolution_clock::now();
+
+    for (std::size_t i = 0; i < rounds; ++i)  {
+        for (std::size_t l = 0; l < LayeredDag::layers; ++l)  {
+            const std::size_t   base { l * LayeredDag::width };
+            auto                futs =
+                thr_pool.dispatch_bulk(
+                    LayeredDag::width,
+                    [&dag, base](std::size_t j)  {
+                        return ([cost = dag.costs[base + j]]() -> void  {
+                                    work(cost);
+                                });
+                    });
+
+            for (auto &fut : futs)  fut.get();
+        }
+    }
+
+    const auto  second = high_resolution_clock::now();
+
+    report("layered_barrier()", dag.costs.size() * rounds, first, second);
+    if (NODE_COUNT != dag.costs.size() * rounds)  {
+        std::cout << "ERROR: layered_barrier() lost nodes" << std::endl;
+        ::exit(EXIT_FAILURE);
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+// One root, many independent nodes and one sink. It measures the cost of
+// readying and queueing nodes.
+//
+static void fan_out_in(ThreadPool &thr_pool)  {
+
+    constexpr std::size_t   rounds { 20 };
+    constexpr std::size_t   width { 10'000 };
+    TaskGraph               graph;
+    const auto              root = graph.add_node([]() { work(0); });
+    const auto              sink = graph.add_node([]() { work(0); });
+
+    for (std::size_t i = 0; i < width; ++i)  {
+        const auto  node = graph.add_node([]() { work(0); });
+
+        graph.add_edge(root, node);
+        graph.add_edge(node, sink);
+    }
+
+    NODE_COUNT = 0;
+
+    const auto  first = high_resolution_clock::now();
+
+    for (std::size_t i = 0; i < rounds; ++i)
+        thr_pool.run_graph(graph);
+
+    const auto  second = high_resolution_clock::now();
+
+    report("fan_out_in()", graph.nodes() * rounds, first, second);
+}
+
+// ----------------------------------------------------------------------------
+
+// A chain of nodes, as a graph and as continuations. It measures the cost
+// of one dependency.
+//
+static void chain(ThreadPool &thr_pool)  {
+
+    constexpr std::size_t   length { 10'000 };
+    constexpr std::size_t   rounds { 20 };
+    TaskGraph               graph;
+
+    for (std::size_t i = 0; i < length; ++i)  {
+        graph.add_node([]() { work(0); });
+        if (i > 0)  graph.add_edge(i - 1, i);
+    }
+
+    auto    first = high_resolution_clock::now();
+
+    for (std::size_t i = 0; i < rounds; ++i)
+        thr_pool.run_graph(graph);
+
+    auto    second = high_resolution_clock::now();
+
+    report("graph chain()", length * rounds, first, second);
+
+    first = high_resolution_clock::now();
+    for (std::size_t i = 0; i < rounds; ++i)  {
+        auto    fut = thr_pool.async([]() { work(0); });
+
+        for (std::size_t j = 1; j < length; ++j)
+            fut = fut.then([]() { work(0); });
+        fut.get();
+    }
+    second = high_resolution_clock::now();
+
+    report("then() chain()", length * rounds, first, second);
+}
+
+// ----------------------------------------------------------------------------
+
+int main (int argc, char *argv[])  {
+
+    // Optionally, the number of threads could be passed on the command line
+    //
+    ThreadPool  thr_pool (argc > 1 ? ::atol(argv[1])
+                                   : std::thread::hardware_concurrency());
+    LayeredDag  dag { };
+
+    std::cout << "Thread pool capacity: " << thr_pool.capacity_threads()
+              << std::endl;
+    layered_graph(thr_pool, dag);
+    layered_barrier(thr_pool, dag);
+    fan_out_in(thr_pool);
+    chain(thr_pool);
+
+    return (EXIT_SUCCESS);
+}
+
+// ----------------------------------------------------------------------------
+
+// Local Variables:
+// mode:C++
+// tab-width:4
+// c-basic-offset:4
+// End:
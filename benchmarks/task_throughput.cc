@@ -0,0 +1,439 @@
+// Hossein Moein
+// October 18, 2026
+/*
+Copyright (c) 2023-2028, Hossein Moein
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+* Neither the name of Hossein Moein and/or the Leopard nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL Hossein Moein BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <Leopard/ThreadPool.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <cstdlib>
+#include <future>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <thread>
+#include <vector>
+
+using namespace hmthrp;
+using namespace std::chrono;
+
+// ----------------------------------------------------------------------------
+
+static std::atomic<std::size_t> LEAF_COUNT { 0 };
+
+// ----------------------------------------------------------------------------
+
+static void report(const char *name, std::size_t tasks,
+                   high_resolution_clock::time_point first,
+                   high_resolution_clock::time_point second)  {
+
+    const double    secs =
+        double(duration_cast<nanoseconds>(second - first).count()) / 1e9;
+
+    std::cout << name << ": " << tasks << " tasks in " << secs << " secs -- "
+              << std::size_t(double(tasks) / secs) << " tasks/sec"
+              << std::endl;
+}
+
+// ----------------------------------------------------------------------------
+
+// Many tiny tasks dispatched from a thread outside the pool
+//
+static void flat_dispatch(ThreadPool &thr_pool)  {
+
+    constexpr std::size_t           n { 1'000'000 };
+    std::vector<std::future<void>>  futs;
+
+    futs.reserve(n);
+    LEAF_COUNT = 0;
+
+    const auto  first = high_resolution_clock::now();
+
+    for (std::size_t i = 0; i < n; ++i)
+        futs.push_back(thr_pool.dispatch(false,
+                                         []() -> void { ++LEAF_COUNT; }));
+    for (auto &fut : futs)
+        fut.get();
+
+    const auto  second = high_resolution_clock::now();
+
+    report("flat_dispatch()", n, first, second);
+    if (LEAF_COUNT != n)  {
+        std::cout << "ERROR: flat_dispatch() lost tasks" << std::endl;
+        ::exit(EXIT_FAILURE);
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+// Same as flat_dispatch(), but the tasks are queued in batches
+//
+static void bulk_dispatch(ThreadPool &thr_pool)  {
+
+    constexpr std::size_t           n { 1'000'000 };
+    constexpr std::size_t           batch { 1'000 };
+    std::vector<std::future<void>>  futs;
+
+    futs.reserve(n);
+    LEAF_COUNT = 0;
+
+    const auto  first = high_resolution_clock::now();
+
+    for (std::size_t i = 0; i < n; i += batch)  {
+        auto    bulk_futs =
+            thr_pool.dispatch_bulk(batch, [](ThreadPool::size_type)  {
+                                              return ([]() -> void  {
+                                                  ++LEAF_COUNT;
+                                              });
+                                          });
+
+        std::move(bulk_futs.begin(), bulk_futs.end(),
+                  std::back_inserter(futs));
+    }
+    for (auto &fut : futs)
+        fut.get();
+
+    const auto  second = high_resolution_clock::now();
+
+    report("bulk_dispatch()", n, first, second);
+    if (LEAF_COUNT != n)  {
+        std::cout << "ERROR: bulk_dispatch() lost tasks" << std::endl;
+        ::exit(EXIT_FAILURE);
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+// Recursive fork-join, similar to what parallel_sort() does. All tasks
+// except the root are dispatched from the pool threads themselves.
+//
+static void fork_join(ThreadPool &thr_pool, std::size_t depth)  {
+
+    if (depth == 0)  {
+        ++LEAF_COUNT;
+        return;
+    }
+
+    auto    lf = thr_pool.dispatch(false, fork_join,
+                                   std::ref(thr_pool), depth - 1);
+    auto    rf = thr_pool.dispatch(false, fork_join,
+                                   std::ref(thr_pool), depth - 1);
+
+    while (lf.wait_for(seconds(0)) == std::future_status::timeout)
+        thr_pool.run_task();
+    while (rf.wait_for(seconds(0)) == std::future_status::timeout)
+        thr_pool.run_task();
+}
+
+// --------------------------------------
+
+static void nested_dispatch(ThreadPool &thr_pool)  {
+
+    constexpr std::size_t   depth { 11 };
+    constexpr std::size_t   rounds { 250 };
+    constexpr std::size_t   leaves { std::size_t(1) << depth };
+
+    LEAF_COUNT = 0;
+
+    const auto  first = high_resolution_clock::now();
+
+    for (std::size_t i = 0; i < rounds; ++i)
+        thr_pool.dispatch(false, fork_join, std::ref(thr_pool), depth).get();
+
+    const auto  second = high_resolution_clock::now();
+
+    report("nested_dispatch()", (leaves * 2 - 1) * rounds, first, second);
+    if (LEAF_COUNT != leaves * rounds)  {
+        std::cout << "ERROR: nested_dispatch() lost tasks" << std::endl;
+        ::exit(EXIT_FAILURE);
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+// How much CPU an idle pool burns and how long it takes a parked thread to
+// pick up a task
+//
+static void idle_wakeup(ThreadPool &thr_pool)  {
+
+    const std::clock_t  cpu_first = std::clock();
+
+    std::this_thread::sleep_for(seconds(1));
+
+    const std::clock_t  cpu_second = std::clock();
+
+    std::cout << "idle_wakeup(): idle CPU usage: "
+              << 100.0 * double(cpu_second - cpu_first) / CLOCKS_PER_SEC
+              << "% of one core" << std::endl;
+
+    constexpr std::size_t   n { 200 };
+    nanoseconds             total { 0 };
+    nanoseconds             worst { 0 };
+
+    for (std::size_t i = 0; i < n; ++i)  {
+        std::this_thread::sleep_for(milliseconds(5));  // Let threads park
+
+        const auto  first = high_resolution_clock::now();
+
+        thr_pool.dispatch(false, []() -> void {   }).get();
+
+        const auto  elapsed = high_resolution_clock::now() - first;
+
+        total += elapsed;
+        worst = std::max(worst, duration_cast<nanoseconds>(elapsed));
+    }
+    std::cout << "idle_wakeup(): wake latency: mean "
+              << total.count() / n << " ns, max " << worst.count() << " ns"
+              << std::endl;
+}
+
+// ----------------------------------------------------------------------------
+
+// Queue wait of latency critical tasks while the pool is flooded with
+// background work
+//
+static void priority_latency(std::size_t threads, PoolOptions options)  {
+
+    options.track_queue_wait = true;
+
+    ThreadPool                  thr_pool (threads, options);
+    constexpr std::size_t       n { 200'000 };
+    constexpr std::size_t       every { 100 };
+    std::atomic<std::size_t>    done { 0 };
+    const auto                  busy = [&done]() -> void  {
+        for (std::size_t i = 0; i < 500; ++i)
+            cpu_relax();
+        ++done;
+    };
+
+    for (std::size_t i = 0; i < n; ++i)  {
+        thr_pool.post(TASK_PRIORITY::_background_, busy);
+        if (i % every == 0)  {
+            thr_pool.post(TASK_PRIORITY::_high_, busy);
+            thr_pool.post(busy);
+        }
+    }
+    while (done < n + 2 * (n / every))
+        std::this_thread::yield();
+
+    const char  *names[] = { "high", "normal", "background" };
+
+    for (std::size_t i = 0; i < TASK_PRIORITY_COUNT; ++i)  {
+        const QueueWaitStats    stats =
+            thr_pool.queue_wait_stats(TASK_PRIORITY(i));
+
+        std::cout << "priority_latency(): " << names[i] << ": "
+                  << stats.count << " tasks, queue wait mean "
+                  << std::size_t(stats.mean_ns()) << " ns, p50 <= "
+                  << stats.percentile_ns(0.5) << " ns, p99 <= "
+                  << stats.percentile_ns(0.99) << " ns" << std::endl;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+// Same fork-join as nested_dispatch(), with a TaskGroup instead of futures
+//
+static void group_fork_join(ThreadPool &thr_pool, std::size_t depth)  {
+
+    if (depth == 0)  {
+        ++LEAF_COUNT;
+        return;
+    }
+
+    TaskGroup   group { thr_pool.make_group() };
+
+    group.run(group_fork_join, std::ref(thr_pool), depth - 1);
+    group_fork_join(thr_pool, depth - 1);
+    group.wait();
+}
+
+// --------------------------------------
+
+static void nested_group(ThreadPool &thr_pool)  {
+
+    constexpr std::size_t   depth { 11 };
+    constexpr std::size_t   rounds { 250 };
+    constexpr std::size_t   leaves { std::size_t(1) << depth };
+
+    LEAF_COUNT = 0;
+
+    const auto  first = high_resolution_clock::now();
+
+    for (std::size_t i = 0; i < rounds; ++i)
+        thr_pool.dispatch(false, group_fork_join,
+                          std::ref(thr_pool), depth).get();
+
+    const auto  second = high_resolution_clock::now();
+
+    report("nested_group()", (leaves - 1) * rounds, first, second);
+    if (LEAF_COUNT != leaves * rounds)  {
+        std::cout << "ERROR: nested_group() lost tasks" << std::endl;
+        ::exit(EXIT_FAILURE);
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+// A coroutine moving onto the pool over and over. Every hop is one queued
+// task, with no future and no thread blocked on it.
+//
+static task<std::size_t> hop(ThreadPool &thr_pool, std::size_t n)  {
+
+    for (std::size_t i = 0; i < n; ++i)  {
+        co_await thr_pool.schedule();
+        ++LEAF_COUNT;
+    }
+    co_return (n);
+}
+
+// --------------------------------------
+
+static void coroutine_hops(ThreadPool &thr_pool)  {
+
+    constexpr std::size_t   n { 1'000'000 };
+
+    LEAF_COUNT = 0;
+
+    const auto  first = high_resolution_clock::now();
+    const auto  hops = sync_wait(hop(thr_pool, n));
+    const auto  second = high_resolution_clock::now();
+
+    report("coroutine_hops()", hops, first, second);
+    if (LEAF_COUNT != n)  {
+        std::cout << "ERROR: coroutine_hops() lost hops" << std::endl;
+        ::exit(EXIT_FAILURE);
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+// A loop whose iterations get more expensive towards the end, with every
+// scheduling policy
+//
+static void irregular_loop(ThreadPool &thr_pool)  {
+
+    constexpr std::size_t   n { 20'000 };
+    auto                    body =
+        [](std::size_t begin, std::size_t end) -> std::size_t  {
+            volatile std::size_t    sink { 0 };
+
+            for (std::size_t i = begin; i < end; ++i)
+                for (std::size_t j = 0; j < i / 8; ++j)
+                    sink = sink + j;
+            return (end - begin);
+        };
+    const std::pair<const char *, LOOP_SCHEDULE>    schedules[] {
+        { "irregular_loop(static)", LOOP_SCHEDULE::_static_ },
+        { "irregular_loop(dynamic)", LOOP_SCHEDULE::_dynamic_ },
+        { "irregular_loop(guided)", LOOP_SCHEDULE::_guided_ },
+        { "irregular_loop(auto)", LOOP_SCHEDULE::_auto_ },
+    };
+
+    for (const auto &[name, schedule] : schedules)  {
+        std::size_t done { 0 };
+        const auto  first = high_resolution_clock::now();
+
+        for (auto &fut : thr_pool.parallel_loop(schedule, 0,
+                                                std::size_t(0), n, body))
+            done += fut.get();
+
+        const auto  second = high_resolution_clock::now();
+
+        report(name, done, first, second);
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+// How evenly the work was spread between the pool threads
+//
+static void print_worker_stats(const ThreadPool &thr_pool)  {
+
+    const auto  stats = thr_pool.worker_stats();
+    std::size_t min_executed { std::numeric_limits<std::size_t>::max() };
+    std::size_t max_executed { 0 };
+
+    for (std::size_t i = 0; i < stats.size(); ++i)  {
+        std::cout << "Thread " << i << ": executed: " << stats[i].executed
+                  << ", steals: " << stats[i].steals
+                  << ", stolen: " << stats[i].stolen
+                  << ", stolen_from: " << stats[i].stolen_from << std::endl;
+        min_executed = std::min(min_executed, stats[i].executed);
+        max_executed = std::max(max_executed, stats[i].executed);
+    }
+    if (max_executed > 0)
+        std::cout << "Min/max executed: "
+                  << double(min_executed) / double(max_executed)
+                  << std::endl;
+}
+
+// ----------------------------------------------------------------------------
+
+int main (int argc, char *argv[])  {
+
+    // Optionally, the number of threads, the capacity of the global
+    // lock-free ring buffer, steal-half (0/1), the idle spin count and
+    // thread affinity (0: none, 1: pin, 2: spread) could be passed on the
+    // command line
+    //
+    PoolOptions options { };
+
+    if (argc > 2)  options.global_queue_capacity = ::atol(argv[2]);
+    if (argc > 3)  options.steal_half = ::atol(argv[3]) != 0;
+    if (argc > 4)  options.spin_count = ::atol(argv[4]);
+    if (argc > 5)  options.affinity = THREAD_AFFINITY(::atol(argv[5]));
+
+    ThreadPool  thr_pool (argc > 1 ? ::atol(argv[1])
+                                   : std::thread::hardware_concurrency(),
+                          options);
+
+    std::cout << "Thread pool capacity: " << thr_pool.capacity_threads()
+              << ", NUMA nodes: " << thr_pool.node_count() << std::endl;
+    flat_dispatch(thr_pool);
+    bulk_dispatch(thr_pool);
+    nested_dispatch(thr_pool);
+    nested_group(thr_pool);
+    coroutine_hops(thr_pool);
+    irregular_loop(thr_pool);
+    print_worker_stats(thr_pool);
+    idle_wakeup(thr_pool);
+    priority_latency(thr_pool.capacity_threads(), options);
+
+    return (EXIT_SUCCESS);
+}
+
+// ----------------------------------------------------------------------------
+
+// Local Variables:
+// mode:C++
+// tab-width:4
+// c-basic-offset:4
+// End:
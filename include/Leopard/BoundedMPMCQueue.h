@@ -0,0 +1,121 @@
+// Hossein Moein
+// October 18, 2026
+/*
+Copyright (c) 2023-2028, Hossein Moein
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+* Neither the name of Hossein Moein and/or the Leopard nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL Hossein Moein BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include <Leopard/Common.h>
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <type_traits>
+
+// ----------------------------------------------------------------------------
+
+namespace hmthrp
+{
+
+// This is a lock-free, bounded, multi-producer/multi-consumer queue.
+// It is a ring buffer in which every slot carries a sequence number
+// (Dmitry Vyukov's design). The sequence number tells a producer whether the
+// slot is free for the current lap and tells a consumer whether the slot has
+// been filled. So producers and consumers only contend on the head or tail
+// index they advance, and those are on separate cache lines.
+//
+template<typename T>
+class   BoundedMPMCQueue  {
+
+public:
+
+    using value_type = T;
+    using size_type = std::size_t;
+    using optional_ret = std::optional<value_type>;
+
+    static_assert(std::is_nothrow_move_constructible_v<value_type>,
+                  "BoundedMPMCQueue: value_type must be nothrow movable");
+
+    // Capacity is rounded up to a power of 2
+    //
+    explicit
+    BoundedMPMCQueue(size_type capacity);
+    ~BoundedMPMCQueue();
+
+    BoundedMPMCQueue(const BoundedMPMCQueue &) = delete;
+    BoundedMPMCQueue &operator = (const BoundedMPMCQueue &) = delete;
+
+    // It returns false, if the queue is full. In that case element is left
+    // untouched.
+    //
+    bool try_push(value_type &&element) noexcept;
+    bool try_push(const value_type &element) noexcept;
+
+    // It returns an empty optional, if the queue is empty
+    //
+    optional_ret try_pop() noexcept;
+
+    // These are approximations, if other threads are operating on the queue
+    //
+    bool empty() const noexcept;
+    size_type size() const noexcept;
+
+    size_type capacity() const noexcept;
+
+private:
+
+    struct  Slot  {
+
+        std::atomic<size_type>                      sequence { 0 };
+        alignas(value_type) unsigned char           storage[sizeof(value_type)];
+    };
+
+    template<typename V>
+    bool push_(V &&element) noexcept;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<size_type> head_ { 0 };  // Pop side
+    alignas(CACHE_LINE_SIZE) std::atomic<size_type> tail_ { 0 };  // Push side
+    alignas(CACHE_LINE_SIZE) const size_type        mask_;
+    std::unique_ptr<Slot[]>                         slots_;
+};
+
+} // namespace hmthrp
+
+// ----------------------------------------------------------------------------
+
+#ifndef HMTHRP_DO_NOT_INCLUDE_TCC_FILES
+#  include <Leopard/BoundedMPMCQueue.tcc>
+#endif // HMTHRP_DO_NOT_INCLUDE_TCC_FILES
+
+// ----------------------------------------------------------------------------
+
+// Local Variables:
+// mode:C++
+// tab-width:4
+// c-basic-offset:4
+// End:
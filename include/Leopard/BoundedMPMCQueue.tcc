@@ -0,0 +1,176 @@
+// Hossein Moein
+// October 18, 2026
+/*
+Copyright (c) 2023-2028, Hossein Moein
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+* Neither the name of Hossein Moein and/or the Leopard nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL Hossein Moein BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <Leopard/BoundedMPMCQueue.h>
+
+#include <bit>
+#include <new>
+
+// ----------------------------------------------------------------------------
+
+namespace hmthrp
+{
+
+template<typename T>
+BoundedMPMCQueue<T>::BoundedMPMCQueue(size_type capacity)
+    : mask_(std::bit_ceil(capacity < 2 ? size_type(2) : capacity) - 1),
+      slots_(std::make_unique<Slot[]>(mask_ + 1))  {
+
+    for (size_type i = 0; i <= mask_; ++i)
+        slots_[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename T>
+BoundedMPMCQueue<T>::~BoundedMPMCQueue()  {
+
+    while (try_pop().has_value())  ;  // Destruct the leftovers
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename T>
+template<typename V>
+bool BoundedMPMCQueue<T>::push_(V &&element) noexcept  {
+
+    using diff_type = std::make_signed_t<size_type>;
+
+    size_type   pos { tail_.load(std::memory_order_relaxed) };
+    Slot        *slot { nullptr };
+
+    while (true)  {
+        slot = &(slots_[pos & mask_]);
+
+        const size_type seq { slot->sequence.load(std::memory_order_acquire) };
+        const diff_type diff { diff_type(seq) - diff_type(pos) };
+
+        if (diff == 0)  {  // The slot is free in this lap
+            if (tail_.compare_exchange_weak(pos, pos + 1,
+                                            std::memory_order_relaxed))
+                break;
+        }
+        else if (diff < 0)  // The slot is still occupied from the last lap
+            return (false);
+        else
+            pos = tail_.load(std::memory_order_relaxed);
+    }
+
+    ::new (static_cast<void *>(slot->storage))
+        value_type(std::forward<V>(element));
+    slot->sequence.store(pos + 1, std::memory_order_release);
+    return (true);
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename T>
+bool BoundedMPMCQueue<T>::try_push(value_type &&element) noexcept  {
+
+    return (push_(std::move(element)));
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename T>
+bool BoundedMPMCQueue<T>::try_push(const value_type &element) noexcept  {
+
+    return (push_(element));
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename T>
+typename BoundedMPMCQueue<T>::optional_ret
+BoundedMPMCQueue<T>::try_pop() noexcept  {
+
+    using diff_type = std::make_signed_t<size_type>;
+
+    size_type   pos { head_.load(std::memory_order_relaxed) };
+    Slot        *slot { nullptr };
+
+    while (true)  {
+        slot = &(slots_[pos & mask_]);
+
+        const size_type seq { slot->sequence.load(std::memory_order_acquire) };
+        const diff_type diff { diff_type(seq) - diff_type(pos + 1) };
+
+        if (diff == 0)  {  // The slot is filled in this lap
+            if (head_.compare_exchange_weak(pos, pos + 1,
+                                            std::memory_order_relaxed))
+                break;
+        }
+        else if (diff < 0)  // Empty
+            return (optional_ret { });
+        else
+            pos = head_.load(std::memory_order_relaxed);
+    }
+
+    value_type      *value {
+        std::launder(reinterpret_cast<value_type *>(slot->storage))
+    };
+    optional_ret    ret { std::move(*value) };
+
+    value->~value_type();
+    slot->sequence.store(pos + mask_ + 1, std::memory_order_release);
+    return (ret);
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename T>
+bool BoundedMPMCQueue<T>::empty() const noexcept  { return (size() == 0); }
+
+// ----------------------------------------------------------------------------
+
+template<typename T>
+typename BoundedMPMCQueue<T>::size_type
+BoundedMPMCQueue<T>::size() const noexcept  {
+
+    const size_type head { head_.load(std::memory_order_acquire) };
+    const size_type tail { tail_.load(std::memory_order_acquire) };
+
+    return ((tail > head) ? tail - head : 0);
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename T>
+typename BoundedMPMCQueue<T>::size_type
+BoundedMPMCQueue<T>::capacity() const noexcept  { return (mask_ + 1); }
+
+} // namespace hmthrp
+
+// ----------------------------------------------------------------------------
+
+// Local Variables:
+// mode:C++
+// tab-width:4
+// c-basic-offset:4
+// End:
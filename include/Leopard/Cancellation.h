@@ -0,0 +1,132 @@
+// Hossein Moein
+// October 18, 2026
+/*
+Copyright (c) 2023-2028, Hossein Moein
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+* Neither the name of Hossein Moein and/or the Leopard nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL Hossein Moein BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+
+// ----------------------------------------------------------------------------
+
+namespace hmthrp
+{
+
+// It is set in the futures of tasks that were dropped, because their token
+// was cancelled before they started
+//
+class   TaskCancelled : public std::runtime_error  {
+
+public:
+
+    TaskCancelled() : std::runtime_error("Task was cancelled.")  {   }
+};
+
+// ----------------------------------------------------------------------------
+
+// A read-only view of the state of a CancellationSource. It is cheap to copy,
+// and is_cancelled() is one atomic load, so running tasks can poll it often:
+//
+//     CancellationSource  source;
+//     auto                fut =
+//         pool.dispatch(source.token(), false,
+//                       [token = source.token()]() -> void  {
+//                           while (! token.is_cancelled())  do_some_work();
+//                       });
+//
+//     source.cancel();
+//
+// A default constructed token is never cancelled.
+//
+class   CancellationToken  {
+
+public:
+
+    CancellationToken() noexcept = default;
+
+    bool is_cancelled() const noexcept;
+    bool can_be_cancelled() const noexcept;  // Has a source
+
+    // It throws TaskCancelled, if the token is cancelled
+    //
+    void throw_if_cancelled() const;
+
+private:
+
+    friend class    CancellationSource;
+
+    struct  State  {
+
+        std::atomic_bool    cancelled { false };
+    };
+
+    explicit CancellationToken(std::shared_ptr<State> state) noexcept;
+
+    std::shared_ptr<State>  state_ { };
+};
+
+// ----------------------------------------------------------------------------
+
+// It cancels all the tokens it has handed out. Cancelling can't be undone.
+// Tasks that haven't started yet are dropped. Running ones are not stopped,
+// unless they poll their token.
+//
+class   CancellationSource  {
+
+public:
+
+    CancellationSource();
+
+    CancellationToken token() const noexcept;
+
+    // It returns true, if this call cancelled the source
+    //
+    bool cancel() noexcept;
+    bool is_cancelled() const noexcept;
+
+private:
+
+    std::shared_ptr<CancellationToken::State>   state_;
+};
+
+} // namespace hmthrp
+
+// ----------------------------------------------------------------------------
+
+#ifndef HMTHRP_DO_NOT_INCLUDE_TCC_FILES
+#  include <Leopard/Cancellation.tcc>
+#endif // HMTHRP_DO_NOT_INCLUDE_TCC_FILES
+
+// ----------------------------------------------------------------------------
+
+// Local Variables:
+// mode:C++
+// tab-width:4
+// c-basic-offset:4
+// End:
@@ -0,0 +1,98 @@
+// Hossein Moein
+// October 18, 2026
+/*
+Copyright (c) 2023-2028, Hossein Moein
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+* Neither the name of Hossein Moein and/or the Leopard nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL Hossein Moein BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <Leopard/Cancellation.h>
+
+#include <utility>
+
+// ----------------------------------------------------------------------------
+
+namespace hmthrp
+{
+
+inline CancellationToken::
+CancellationToken(std::shared_ptr<State> state) noexcept
+    : state_(std::move(state))  {   }
+
+// ----------------------------------------------------------------------------
+
+inline bool CancellationToken::is_cancelled() const noexcept  {
+
+    return (state_ && state_->cancelled.load(std::memory_order_acquire));
+}
+
+// ----------------------------------------------------------------------------
+
+inline bool CancellationToken::can_be_cancelled() const noexcept  {
+
+    return (state_ != nullptr);
+}
+
+// ----------------------------------------------------------------------------
+
+inline void CancellationToken::throw_if_cancelled() const  {
+
+    if (is_cancelled())  throw TaskCancelled { };
+}
+
+// ----------------------------------------------------------------------------
+
+inline CancellationSource::CancellationSource()
+    : state_(std::make_shared<CancellationToken::State>())  {   }
+
+// ----------------------------------------------------------------------------
+
+inline CancellationToken CancellationSource::token() const noexcept  {
+
+    return (CancellationToken { state_ });
+}
+
+// ----------------------------------------------------------------------------
+
+inline bool CancellationSource::cancel() noexcept  {
+
+    return (! state_->cancelled.exchange(true, std::memory_order_acq_rel));
+}
+
+// ----------------------------------------------------------------------------
+
+inline bool CancellationSource::is_cancelled() const noexcept  {
+
+    return (state_->cancelled.load(std::memory_order_acquire));
+}
+
+} // namespace hmthrp
+
+// ----------------------------------------------------------------------------
+
+// Local Variables:
+// mode:C++
+// tab-width:4
+// c-basic-offset:4
+// End:
@@ -0,0 +1,122 @@
+// Hossein Moein
+// October 18, 2026
+/*
+Copyright (c) 2023-2028, Hossein Moein
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+* Neither the name of Hossein Moein and/or the Leopard nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL Hossein Moein BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include <Leopard/Common.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+// ----------------------------------------------------------------------------
+
+namespace hmthrp
+{
+
+// An eventcount lets threads sleep until a condition, that is checked
+// without any lock, becomes true. A waiter does:
+//
+//     const auto  key = ec.prepare_wait();
+//
+//     if (condition())  ec.cancel_wait();
+//     else  ec.commit_wait(key);
+//
+// And a notifier makes the condition true and then calls notify_one().
+// A notification that comes after prepare_wait() is never lost. Notifying
+// is just a fence and a load, if nobody is waiting.
+//
+class   EventCount  {
+
+public:
+
+    using key_type = std::uint32_t;
+    using size_type = std::size_t;
+
+    EventCount() = default;
+    EventCount(const EventCount &) = delete;
+    EventCount &operator = (const EventCount &) = delete;
+
+    key_type prepare_wait() noexcept;
+    void cancel_wait() noexcept;
+    void commit_wait(key_type key) noexcept;
+
+    // Same as commit_wait(), but it gives up at deadline. It returns false,
+    // if it timed out without being notified.
+    //
+    template<typename C, typename D>
+    bool commit_wait_until(key_type key,
+                           const std::chrono::time_point<C, D> &deadline)
+        noexcept;
+
+    // They wake up at most one / n / all waiting threads.
+    // notify() returns how many threads it woke up (at most n).
+    //
+    void notify_one() noexcept;
+    size_type notify(size_type n) noexcept;
+    void notify_all() noexcept;
+
+    // Number of threads between prepare_wait() and the end of
+    // cancel_wait()/commit_wait()
+    //
+    size_type waiters() const noexcept;
+
+private:
+
+    // The upper 32 bits are the epoch, and the lower 32 bits are the number
+    // of waiters. The epoch only changes while holding mutex_, so a waiter
+    // cannot miss it between checking it and going to sleep.
+    //
+    inline static constexpr std::uint64_t   WAITER_MASK = 0xFFFFFFFFULL;
+    inline static constexpr int             EPOCH_SHIFT = 32;
+
+    size_type notify_(size_type n) noexcept;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<std::uint64_t> state_ { 0 };
+    std::mutex                                          mutex_ { };
+    std::condition_variable                             cvx_ { };
+};
+
+} // namespace hmthrp
+
+// ----------------------------------------------------------------------------
+
+#ifndef HMTHRP_DO_NOT_INCLUDE_TCC_FILES
+#  include <Leopard/EventCount.tcc>
+#endif // HMTHRP_DO_NOT_INCLUDE_TCC_FILES
+
+// ----------------------------------------------------------------------------
+
+// Local Variables:
+// mode:C++
+// tab-width:4
+// c-basic-offset:4
+// End:
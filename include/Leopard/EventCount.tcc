@@ -0,0 +1,155 @@
+// Hossein Moein
+// October 18, 2026
+/*
+Copyright (c) 2023-2028, Hossein Moein
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+* Neither the name of Hossein Moein and/or the Leopard nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL Hossein Moein BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <Leopard/EventCount.h>
+
+// ----------------------------------------------------------------------------
+
+namespace hmthrp
+{
+
+inline EventCount::key_type EventCount::prepare_wait() noexcept  {
+
+    const std::uint64_t prev {
+        state_.fetch_add(1, std::memory_order_seq_cst) };
+
+    // The caller's check of the condition must not move above this.
+    // It pairs with the fence in notify_().
+    //
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    return (key_type(prev >> EPOCH_SHIFT));
+}
+
+// ----------------------------------------------------------------------------
+
+inline void EventCount::cancel_wait() noexcept  {
+
+    state_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+// ----------------------------------------------------------------------------
+
+inline void EventCount::commit_wait(key_type key) noexcept  {
+
+    {
+        std::unique_lock<std::mutex>    ul { mutex_ };
+
+        while (key_type(state_.load(std::memory_order_relaxed) >>
+                        EPOCH_SHIFT) == key)
+            cvx_.wait(ul);
+    }
+    state_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename C, typename D>
+bool
+EventCount::commit_wait_until(key_type key,
+                              const std::chrono::time_point<C, D> &deadline)
+    noexcept  {
+
+    bool    notified { true };
+
+    {
+        std::unique_lock<std::mutex>    ul { mutex_ };
+
+        while (key_type(state_.load(std::memory_order_relaxed) >>
+                        EPOCH_SHIFT) == key)
+            if (cvx_.wait_until(ul, deadline) == std::cv_status::timeout)  {
+                notified = key_type(state_.load(std::memory_order_relaxed) >>
+                                    EPOCH_SHIFT) != key;
+                break;
+            }
+    }
+    state_.fetch_sub(1, std::memory_order_relaxed);
+    return (notified);
+}
+
+// ----------------------------------------------------------------------------
+
+inline EventCount::size_type EventCount::notify_(size_type n) noexcept  {
+
+    // This pairs with the fence in prepare_wait(). Either we see the
+    // waiter, or the waiter sees what we did before notifying.
+    //
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    const size_type waiting {
+        size_type(state_.load(std::memory_order_relaxed) & WAITER_MASK)
+    };
+
+    if (waiting == 0)  return (0);
+
+    {
+        const std::lock_guard<std::mutex>   guard { mutex_ };
+
+        state_.fetch_add(std::uint64_t(1) << EPOCH_SHIFT,
+                         std::memory_order_relaxed);
+    }
+    if (n >= waiting)  {
+        cvx_.notify_all();
+        return (waiting);
+    }
+    for (size_type i = 0; i < n; ++i)
+        cvx_.notify_one();
+    return (n);
+}
+
+// ----------------------------------------------------------------------------
+
+inline void EventCount::notify_one() noexcept  { notify_(1); }
+
+// ----------------------------------------------------------------------------
+
+inline EventCount::size_type EventCount::notify(size_type n) noexcept  {
+
+    return (n > 0 ? notify_(n) : 0);
+}
+
+// ----------------------------------------------------------------------------
+
+inline void EventCount::notify_all() noexcept  { notify_(WAITER_MASK); }
+
+// ----------------------------------------------------------------------------
+
+inline EventCount::size_type EventCount::waiters() const noexcept  {
+
+    return (size_type(state_.load(std::memory_order_relaxed) & WAITER_MASK));
+}
+
+} // namespace hmthrp
+
+// ----------------------------------------------------------------------------
+
+// Local Variables:
+// mode:C++
+// tab-width:4
+// c-basic-offset:4
+// End:
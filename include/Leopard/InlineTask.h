@@ -0,0 +1,134 @@
+// Hossein Moein
+// October 18, 2026
+/*
+Copyright (c) 2023-2028, Hossein Moein
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+* Neither the name of Hossein Moein and/or the Leopard nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL Hossein Moein BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include <Leopard/Common.h>
+
+#include <concepts>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+// ----------------------------------------------------------------------------
+
+namespace hmthrp
+{
+
+// A move-only wrapper around a callable with void() signature.
+// Unlike std::function, it does not require the callable to be copyable,
+// and callables up to INLINE_SIZE bytes are stored inside the object, so
+// wrapping them doesn't allocate. Bigger callables, or ones that may throw
+// when moved, are stored on the heap.
+//
+class   InlineTask  {
+
+public:
+
+    // Two cache lines including the vtable pointer.
+    // That is enough for a lambda capturing a std::promise, a member
+    // function pointer and a few arguments.
+    //
+    inline static constexpr std::size_t INLINE_SIZE =
+        2 * CACHE_LINE_SIZE - sizeof(void *);
+
+    InlineTask() noexcept = default;
+    InlineTask(const InlineTask &) = delete;
+    InlineTask &operator = (const InlineTask &) = delete;
+    InlineTask(InlineTask &&that) noexcept;
+    InlineTask &operator = (InlineTask &&that) noexcept;
+    ~InlineTask();
+
+    template<typename F>
+    requires (! std::same_as<std::decay_t<F>, InlineTask>) &&
+             std::invocable<std::decay_t<F> &>
+    InlineTask(F &&routine);
+
+    void operator () ();
+
+    explicit operator bool () const noexcept  { return (vtable_ != nullptr); }
+
+    void reset() noexcept;
+
+    // Is a callable of type F stored inside the object
+    //
+    template<typename F>
+    inline static constexpr bool is_inline_v =
+        sizeof(F) <= INLINE_SIZE &&
+        alignof(F) <= alignof(std::max_align_t) &&
+        std::is_nothrow_move_constructible_v<F>;
+
+private:
+
+    struct  VTable  {
+
+        void (*invoke)(void *storage);
+        void (*move)(void *dst_storage, void *src_storage) noexcept;
+        void (*destroy)(void *storage) noexcept;
+    };
+
+    template<typename F>
+    struct  InlineOps  {
+
+        static void invoke(void *storage);
+        static void move(void *dst_storage, void *src_storage) noexcept;
+        static void destroy(void *storage) noexcept;
+
+        inline static constexpr VTable  vtable { invoke, move, destroy };
+    };
+
+    template<typename F>
+    struct  HeapOps  {
+
+        static void invoke(void *storage);
+        static void move(void *dst_storage, void *src_storage) noexcept;
+        static void destroy(void *storage) noexcept;
+
+        inline static constexpr VTable  vtable { invoke, move, destroy };
+    };
+
+    const VTable                                    *vtable_ { nullptr };
+    alignas(std::max_align_t) unsigned char         storage_[INLINE_SIZE];
+};
+
+} // namespace hmthrp
+
+// ----------------------------------------------------------------------------
+
+#ifndef HMTHRP_DO_NOT_INCLUDE_TCC_FILES
+#  include <Leopard/InlineTask.tcc>
+#endif // HMTHRP_DO_NOT_INCLUDE_TCC_FILES
+
+// ----------------------------------------------------------------------------
+
+// Local Variables:
+// mode:C++
+// tab-width:4
+// c-basic-offset:4
+// End:
@@ -0,0 +1,162 @@
+// Hossein Moein
+// October 18, 2026
+/*
+Copyright (c) 2023-2028, Hossein Moein
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+* Neither the name of Hossein Moein and/or the Leopard nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL Hossein Moein BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <Leopard/InlineTask.h>
+
+#include <new>
+
+// ----------------------------------------------------------------------------
+
+namespace hmthrp
+{
+
+template<typename F>
+void InlineTask::InlineOps<F>::invoke(void *storage)  {
+
+    (*std::launder(reinterpret_cast<F *>(storage)))();
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename F>
+void
+InlineTask::InlineOps<F>::move(void *dst_storage, void *src_storage) noexcept {
+
+    F   *src { std::launder(reinterpret_cast<F *>(src_storage)) };
+
+    ::new (dst_storage) F(std::move(*src));
+    src->~F();
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename F>
+void InlineTask::InlineOps<F>::destroy(void *storage) noexcept  {
+
+    std::launder(reinterpret_cast<F *>(storage))->~F();
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename F>
+void InlineTask::HeapOps<F>::invoke(void *storage)  {
+
+    (**reinterpret_cast<F **>(storage))();
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename F>
+void
+InlineTask::HeapOps<F>::move(void *dst_storage, void *src_storage) noexcept  {
+
+    *reinterpret_cast<F **>(dst_storage) = *reinterpret_cast<F **>(src_storage);
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename F>
+void InlineTask::HeapOps<F>::destroy(void *storage) noexcept  {
+
+    delete *reinterpret_cast<F **>(storage);
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename F>
+requires (! std::same_as<std::decay_t<F>, InlineTask>) &&
+         std::invocable<std::decay_t<F> &>
+InlineTask::InlineTask(F &&routine)  {
+
+    using func_t = std::decay_t<F>;
+
+    if constexpr (is_inline_v<func_t>)  {
+        ::new (static_cast<void *>(storage_)) func_t(std::forward<F>(routine));
+        vtable_ = &InlineOps<func_t>::vtable;
+    }
+    else  {
+        ::new (static_cast<void *>(storage_))
+            func_t *(new func_t(std::forward<F>(routine)));
+        vtable_ = &HeapOps<func_t>::vtable;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+inline InlineTask::InlineTask(InlineTask &&that) noexcept
+    : vtable_(that.vtable_)  {
+
+    if (vtable_)  {
+        vtable_->move(storage_, that.storage_);
+        that.vtable_ = nullptr;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+inline InlineTask &InlineTask::operator = (InlineTask &&that) noexcept  {
+
+    if (this != &that)  {
+        reset();
+        if (that.vtable_)  {
+            that.vtable_->move(storage_, that.storage_);
+            vtable_ = that.vtable_;
+            that.vtable_ = nullptr;
+        }
+    }
+    return (*this);
+}
+
+// ----------------------------------------------------------------------------
+
+inline InlineTask::~InlineTask()  { reset(); }
+
+// ----------------------------------------------------------------------------
+
+inline void InlineTask::operator () ()  { vtable_->invoke(storage_); }
+
+// ----------------------------------------------------------------------------
+
+inline void InlineTask::reset() noexcept  {
+
+    if (vtable_)  {
+        vtable_->destroy(storage_);
+        vtable_ = nullptr;
+    }
+}
+
+} // namespace hmthrp
+
+// ----------------------------------------------------------------------------
+
+// Local Variables:
+// mode:C++
+// tab-width:4
+// c-basic-offset:4
+// End:
@@ -0,0 +1,179 @@
+// Hossein Moein
+// October 18, 2026
+/*
+Copyright (c) 2023-2028, Hossein Moein
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+* Neither the name of Hossein Moein and/or the Leopard nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL Hossein Moein BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include <Leopard/Common.h>
+
+#include <cstddef>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+// ----------------------------------------------------------------------------
+
+namespace hmthrp
+{
+
+class   ThreadPool;
+
+// ----------------------------------------------------------------------------
+
+// Results of a map-reduce over key/value pairs. ThreadPool::run_map_reduce()
+// fills it:
+//
+//     using WordCount = MapReduce<std::string, std::size_t>;
+//
+//     WordCount   counts;
+//
+//     pool.run_map_reduce(
+//         counts, lines.begin(), lines.end(),
+//         [](const Line &line, WordCount::Emitter &emitter) -> void  {
+//             for (const auto &word : line)  emitter.emit(word, 1);
+//         });
+//
+// Each worker combines its pairs into its own map as they are emitted.
+// When it runs out of items, it splits that map into partitions by the hash
+// of the keys. Then each partition is merged from the workers' parts by one
+// worker, so there is no global merge.
+// A key is in exactly one partition. reduce_op must be associative and
+// commutative, since the order values are combined in is not known.
+//
+template<typename K, typename V,
+         typename BOP = std::plus<>,
+         typename H = std::hash<K>,
+         typename KE = std::equal_to<K>>
+class   MapReduce  {
+
+public:
+
+    using key_type = K;
+    using mapped_type = V;
+    using size_type = std::size_t;
+    using map_type = std::unordered_map<K, V, H, KE>;
+
+    // The map function emits its pairs through it. Values emitted for a key
+    // the worker has already seen are combined right away.
+    //
+    class   Emitter  {
+
+    public:
+
+        template<typename T>
+        void emit(const key_type &key, T &&value);
+        template<typename T>
+        void emit(key_type &&key, T &&value);
+
+    private:
+
+        friend class    ThreadPool;
+
+        Emitter(MapReduce &engine, map_type &map) noexcept
+            : engine_(engine), map_(map)  {   }
+
+        template<typename KK, typename T>
+        void emit_(KK &&key, T &&value);
+
+        MapReduce   &engine_;
+        map_type    &map_;  // The worker's combiner
+    };
+
+    // With 0 partitions, there are 4 for every worker of the pool
+    //
+    explicit
+    MapReduce(size_type partitions = 0, BOP reduce_op = { }, H hash = { });
+    MapReduce(MapReduce &&) = default;
+    MapReduce &operator = (MapReduce &&) = default;
+    MapReduce(const MapReduce &) = delete;
+    MapReduce &operator = (const MapReduce &) = delete;
+
+    size_type partitions() const noexcept;  // Of the last run
+    const map_type &partition(size_type index) const;
+    size_type size() const noexcept;  // Number of keys
+    bool empty() const noexcept;
+
+    // It returns nullptr, if key is not there
+    //
+    const mapped_type *find(const key_type &key) const;
+
+    // func is called with every key and its value
+    //
+    template<typename F>
+    void for_each(F &&func) const;
+
+    void clear() noexcept;
+
+private:
+
+    friend class    ThreadPool;
+
+    // Each worker's maps are apart from other workers'
+    //
+    struct  alignas(CACHE_LINE_SIZE) Local  {
+
+        map_type                combined { };
+        std::vector<map_type>   parts { };  // One per partition
+    };
+
+    size_type partition_of_(const key_type &key) const;
+
+    // It sets up the workers' maps and the partitions for a run
+    //
+    void prepare_(size_type workers);
+
+    // It moves a worker's combined pairs into its parts
+    //
+    void split_(size_type worker);
+
+    // It moves the workers' pairs of one partition into it
+    //
+    void reduce_partition_(size_type index);
+
+    size_type               requested_partitions_;
+    BOP                     reduce_op_;
+    H                       hash_;
+    std::vector<Local>      locals_ { };
+    std::vector<map_type>   partitions_ { };
+};
+
+} // namespace hmthrp
+
+// ----------------------------------------------------------------------------
+
+#ifndef HMTHRP_DO_NOT_INCLUDE_TCC_FILES
+#  include <Leopard/MapReduce.tcc>
+#endif // HMTHRP_DO_NOT_INCLUDE_TCC_FILES
+
+// ----------------------------------------------------------------------------
+
+// Local Variables:
+// mode:C++
+// tab-width:4
+// c-basic-offset:4
+// End:
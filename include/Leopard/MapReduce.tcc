@@ -0,0 +1,249 @@
+// Hossein Moein
+// October 18, 2026
+/*
+Copyright (c) 2023-2028, Hossein Moein
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+* Neither the name of Hossein Moein and/or the Leopard nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL Hossein Moein BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <Leopard/MapReduce.h>
+
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+
+// ----------------------------------------------------------------------------
+
+namespace hmthrp
+{
+
+template<typename K, typename V, typename BOP, typename H, typename KE>
+template<typename T>
+void
+MapReduce<K, V, BOP, H, KE>::Emitter::emit(const key_type &key, T &&value)  {
+
+    emit_(key, std::forward<T>(value));
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename K, typename V, typename BOP, typename H, typename KE>
+template<typename T>
+void MapReduce<K, V, BOP, H, KE>::Emitter::emit(key_type &&key, T &&value)  {
+
+    emit_(std::move(key), std::forward<T>(value));
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename K, typename V, typename BOP, typename H, typename KE>
+template<typename KK, typename T>
+void MapReduce<K, V, BOP, H, KE>::Emitter::emit_(KK &&key, T &&value)  {
+
+    // try_emplace() leaves value alone, if key is already there
+    //
+    auto [iter, inserted] =
+        map_.try_emplace(std::forward<KK>(key), std::forward<T>(value));
+
+    if (! inserted)
+        iter->second = engine_.reduce_op_(std::move(iter->second),
+                                          std::forward<T>(value));
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename K, typename V, typename BOP, typename H, typename KE>
+MapReduce<K, V, BOP, H, KE>::
+MapReduce(size_type partitions, BOP reduce_op, H hash)
+    : requested_partitions_(partitions),
+      reduce_op_(std::move(reduce_op)),
+      hash_(std::move(hash))  {   }
+
+// ----------------------------------------------------------------------------
+
+template<typename K, typename V, typename BOP, typename H, typename KE>
+typename MapReduce<K, V, BOP, H, KE>::size_type
+MapReduce<K, V, BOP, H, KE>::partitions() const noexcept  {
+
+    return (partitions_.size());
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename K, typename V, typename BOP, typename H, typename KE>
+const typename MapReduce<K, V, BOP, H, KE>::map_type &
+MapReduce<K, V, BOP, H, KE>::partition(size_type index) const  {
+
+    if (index >= partitions_.size())
+        throw std::runtime_error("MapReduce::partition(): "
+                                 "Partition index is out of range.");
+    return (partitions_[index]);
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename K, typename V, typename BOP, typename H, typename KE>
+typename MapReduce<K, V, BOP, H, KE>::size_type
+MapReduce<K, V, BOP, H, KE>::size() const noexcept  {
+
+    size_type   result { 0 };
+
+    for (const auto &map : partitions_)  result += map.size();
+    return (result);
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename K, typename V, typename BOP, typename H, typename KE>
+bool MapReduce<K, V, BOP, H, KE>::empty() const noexcept  {
+
+    return (size() == 0);
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename K, typename V, typename BOP, typename H, typename KE>
+const typename MapReduce<K, V, BOP, H, KE>::mapped_type *
+MapReduce<K, V, BOP, H, KE>::find(const key_type &key) const  {
+
+    if (partitions_.empty())  return (nullptr);
+
+    const map_type  &map { partitions_[partition_of_(key)] };
+    const auto      iter { map.find(key) };
+
+    return (iter != map.end() ? &(iter->second) : nullptr);
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename K, typename V, typename BOP, typename H, typename KE>
+template<typename F>
+void MapReduce<K, V, BOP, H, KE>::for_each(F &&func) const  {
+
+    for (const auto &map : partitions_)
+        for (const auto &[key, value] : map)
+            func(key, value);
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename K, typename V, typename BOP, typename H, typename KE>
+void MapReduce<K, V, BOP, H, KE>::clear() noexcept  {
+
+    locals_.clear();
+    partitions_.clear();
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename K, typename V, typename BOP, typename H, typename KE>
+typename MapReduce<K, V, BOP, H, KE>::size_type
+MapReduce<K, V, BOP, H, KE>::partition_of_(const key_type &key) const  {
+
+    // The maps use the low bits of the same hash to pick buckets. So, the
+    // partition is taken from the high bits of a scrambled hash.
+    //
+    const std::uint64_t scrambled {
+        std::uint64_t(hash_(key)) * 0x9E3779B97F4A7C15ULL
+    };
+
+    return (size_type(scrambled >> 32) % partitions_.size());
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename K, typename V, typename BOP, typename H, typename KE>
+void MapReduce<K, V, BOP, H, KE>::prepare_(size_type workers)  {
+
+    const size_type partition_count {
+        requested_partitions_ > 0 ? requested_partitions_ : workers * 4
+    };
+
+    partitions_.clear();
+    partitions_.resize(partition_count);
+    locals_.resize(workers);
+    for (auto &local : locals_)  {
+        local.combined.clear();
+        local.parts.resize(partition_count);
+        for (auto &map : local.parts)  map.clear();
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename K, typename V, typename BOP, typename H, typename KE>
+void MapReduce<K, V, BOP, H, KE>::split_(size_type worker)  {
+
+    Local   &local { locals_[worker] };
+
+    // Nodes are moved, not copied
+    //
+    while (! local.combined.empty())  {
+        auto    node = local.combined.extract(local.combined.begin());
+
+        local.parts[partition_of_(node.key())].insert(std::move(node));
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename K, typename V, typename BOP, typename H, typename KE>
+void MapReduce<K, V, BOP, H, KE>::reduce_partition_(size_type index)  {
+
+    map_type    &result { partitions_[index] };
+
+    // The biggest map is taken whole, and the others are merged into it
+    //
+    Local       *biggest { &(locals_[0]) };
+
+    for (auto &local : locals_)
+        if (local.parts[index].size() > biggest->parts[index].size())
+            biggest = &local;
+    result.swap(biggest->parts[index]);
+
+    for (auto &local : locals_)  {
+        map_type    &map { local.parts[index] };
+
+        // Only the values of keys already in result are combined
+        //
+        while (! map.empty())  {
+            auto    ret = result.insert(map.extract(map.begin()));
+
+            if (! ret.inserted)
+                ret.position->second =
+                    reduce_op_(std::move(ret.position->second),
+                               std::move(ret.node.mapped()));
+        }
+    }
+}
+
+} // namespace hmthrp
+
+// ----------------------------------------------------------------------------
+
+// Local Variables:
+// mode:C++
+// tab-width:4
+// c-basic-offset:4
+// End:
@@ -0,0 +1,146 @@
+// Hossein Moein
+// October 18, 2026
+/*
+Copyright (c) 2023-2028, Hossein Moein
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+* Neither the name of Hossein Moein and/or the Leopard nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL Hossein Moein BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <vector>
+
+// ----------------------------------------------------------------------------
+
+namespace hmthrp
+{
+
+// BlockCache hands out small memory blocks in a few size classes.
+// Freed blocks are kept in a per-thread free-list, so in the steady state
+// allocating and freeing doesn't call the global allocator or take a lock.
+// When a thread frees more blocks than it allocates (e.g. a pool thread
+// destroying what a client thread created), the surplus is moved in batches
+// to a global depot, where threads that allocate more than they free can
+// pick it up.
+//
+class   BlockCache  {
+
+public:
+
+    inline static constexpr std::size_t CLASS_BYTES = 64;
+    inline static constexpr std::size_t CLASS_COUNT = 8;
+    inline static constexpr std::size_t MAX_BYTES = CLASS_BYTES * CLASS_COUNT;
+
+    // Number of free blocks per class a thread keeps, before sending a
+    // batch of them to the depot
+    //
+    inline static constexpr std::size_t THREAD_LIMIT = 256;
+    inline static constexpr std::size_t BATCH_SIZE = THREAD_LIMIT / 2;
+
+    // Blocks bigger than MAX_BYTES or over-aligned go to the global
+    // allocator
+    //
+    static void *allocate(std::size_t bytes, std::size_t alignment);
+    static void
+    deallocate(void *ptr, std::size_t bytes, std::size_t alignment) noexcept;
+
+private:
+
+    struct  FreeBlock  {
+
+        FreeBlock   *next { nullptr };
+    };
+
+    struct  FreeList  {
+
+        FreeBlock   *head { nullptr };
+        std::size_t count { 0 };
+    };
+
+    struct  Depot  {
+
+        std::mutex              mutex { };
+        std::vector<FreeList>   batches[CLASS_COUNT] { };
+    };
+
+    struct  ThreadCache  {
+
+        ThreadCache();
+        ~ThreadCache();
+
+        FreeList    lists[CLASS_COUNT] { };
+    };
+
+    static Depot &depot_() noexcept;
+    static ThreadCache *thread_cache_() noexcept;
+    static void release_batch_(FreeList &list, std::size_t cls) noexcept;
+    static bool acquire_batch_(FreeList &list, std::size_t cls) noexcept;
+
+    inline static thread_local bool thread_cache_gone_ { false };
+};
+
+// ----------------------------------------------------------------------------
+
+// A stateless allocator on top of BlockCache. It is used for the shared state
+// of the futures returned by ThreadPool::dispatch().
+//
+template<typename T>
+class   RecyclingAllocator  {
+
+public:
+
+    using value_type = T;
+
+    RecyclingAllocator() noexcept = default;
+    template<typename U>
+    RecyclingAllocator(const RecyclingAllocator<U> &) noexcept  {   }
+
+    T *allocate(std::size_t n);
+    void deallocate(T *ptr, std::size_t n) noexcept;
+
+    template<typename U>
+    bool operator == (const RecyclingAllocator<U> &) const noexcept  {
+
+        return (true);
+    }
+};
+
+} // namespace hmthrp
+
+// ----------------------------------------------------------------------------
+
+#ifndef HMTHRP_DO_NOT_INCLUDE_TCC_FILES
+#  include <Leopard/RecyclingAllocator.tcc>
+#endif // HMTHRP_DO_NOT_INCLUDE_TCC_FILES
+
+// ----------------------------------------------------------------------------
+
+// Local Variables:
+// mode:C++
+// tab-width:4
+// c-basic-offset:4
+// End:
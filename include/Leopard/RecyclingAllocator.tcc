@@ -0,0 +1,205 @@
+// Hossein Moein
+// October 18, 2026
+/*
+Copyright (c) 2023-2028, Hossein Moein
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+* Neither the name of Hossein Moein and/or the Leopard nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL Hossein Moein BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <Leopard/RecyclingAllocator.h>
+
+// ----------------------------------------------------------------------------
+
+namespace hmthrp
+{
+
+inline BlockCache::ThreadCache::ThreadCache()  {
+
+    depot_();  // Make sure the depot is constructed first
+}
+
+// ----------------------------------------------------------------------------
+
+inline BlockCache::ThreadCache::~ThreadCache()  {
+
+    for (std::size_t cls = 0; cls < CLASS_COUNT; ++cls)
+        while (lists[cls].count > 0)
+            release_batch_(lists[cls], cls);
+    thread_cache_gone_ = true;
+}
+
+// ----------------------------------------------------------------------------
+
+inline BlockCache::Depot &BlockCache::depot_() noexcept  {
+
+    // It is never destructed. Threads may free blocks during static
+    // destruction (e.g. a static ThreadPool joining its threads).
+    //
+    static Depot    *depot { new Depot };
+
+    return (*depot);
+}
+
+// ----------------------------------------------------------------------------
+
+inline BlockCache::ThreadCache *BlockCache::thread_cache_() noexcept  {
+
+    if (thread_cache_gone_)  return (nullptr);
+
+    thread_local ThreadCache    cache;
+
+    return (&cache);
+}
+
+// ----------------------------------------------------------------------------
+
+inline void
+BlockCache::release_batch_(FreeList &list, std::size_t cls) noexcept  {
+
+    FreeList    batch { };
+
+    while (list.head && batch.count < BATCH_SIZE)  {
+        FreeBlock   *block { list.head };
+
+        list.head = block->next;
+        list.count -= 1;
+        block->next = batch.head;
+        batch.head = block;
+        batch.count += 1;
+    }
+
+    Depot               &depot { depot_() };
+    const std::lock_guard<std::mutex>   guard { depot.mutex };
+
+    try  {
+        depot.batches[cls].push_back(batch);
+    }
+    catch (...)  {  // Out of memory. Give them back to the global allocator
+        while (batch.head)  {
+            FreeBlock   *block { batch.head };
+
+            batch.head = block->next;
+            ::operator delete(block);
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+inline bool
+BlockCache::acquire_batch_(FreeList &list, std::size_t cls) noexcept  {
+
+    Depot                               &depot { depot_() };
+    const std::lock_guard<std::mutex>   guard { depot.mutex };
+
+    if (depot.batches[cls].empty())  return (false);
+
+    list = depot.batches[cls].back();
+    depot.batches[cls].pop_back();
+    return (true);
+}
+
+// ----------------------------------------------------------------------------
+
+inline void *BlockCache::allocate(std::size_t bytes, std::size_t alignment)  {
+
+    if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+        return (::operator new(bytes, std::align_val_t(alignment)));
+    if (bytes == 0 || bytes > MAX_BYTES)
+        return (::operator new(bytes));
+
+    const std::size_t   cls { (bytes - 1) / CLASS_BYTES };
+    ThreadCache         *cache { thread_cache_() };
+
+    if (cache)  {
+        FreeList    &list { cache->lists[cls] };
+
+        if (list.head || acquire_batch_(list, cls))  {
+            FreeBlock   *block { list.head };
+
+            list.head = block->next;
+            list.count -= 1;
+            return (block);
+        }
+    }
+    return (::operator new((cls + 1) * CLASS_BYTES));
+}
+
+// ----------------------------------------------------------------------------
+
+inline void
+BlockCache::deallocate(void *ptr,
+                       std::size_t bytes,
+                       std::size_t alignment) noexcept  {
+
+    if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__)  {
+        ::operator delete(ptr, std::align_val_t(alignment));
+        return;
+    }
+    if (bytes == 0 || bytes > MAX_BYTES)  {
+        ::operator delete(ptr);
+        return;
+    }
+
+    ThreadCache *cache { thread_cache_() };
+
+    if (! cache)  {
+        ::operator delete(ptr);
+        return;
+    }
+
+    const std::size_t   cls { (bytes - 1) / CLASS_BYTES };
+    FreeList            &list { cache->lists[cls] };
+
+    list.head = ::new (ptr) FreeBlock { list.head };
+    list.count += 1;
+    if (list.count > THREAD_LIMIT)
+        release_batch_(list, cls);
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename T>
+T *RecyclingAllocator<T>::allocate(std::size_t n)  {
+
+    return (static_cast<T *>(BlockCache::allocate(n * sizeof(T), alignof(T))));
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename T>
+void RecyclingAllocator<T>::deallocate(T *ptr, std::size_t n) noexcept  {
+
+    BlockCache::deallocate(ptr, n * sizeof(T), alignof(T));
+}
+
+} // namespace hmthrp
+
+// ----------------------------------------------------------------------------
+
+// Local Variables:
+// mode:C++
+// tab-width:4
+// c-basic-offset:4
+// End:
@@ -29,9 +29,15 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #pragma once
 
+#include <Leopard/BoundedMPMCQueue.h>
+#include <Leopard/RecyclingAllocator.h>
+
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <condition_variable>
 #include <deque>
+#include <memory>
 #include <mutex>
 #include <optional>
 #include <queue>
@@ -51,12 +57,30 @@ public:
     using optional_ret = std::optional<value_type>;
 
     SharedQueue() = default;
+
+    // If ring_capacity is not 0, a lock-free bounded ring buffer
+    // (BoundedMPMCQueue) with that capacity becomes the primary storage.
+    // Then push() and pop_front() only take the mutex when the ring is full,
+    // or when they have to wait. Elements that don't fit in the ring
+    // overflow into the mutex guarded queue. So FIFO order is not strictly
+    // kept when the ring overflows.
+    //
+    explicit
+    SharedQueue(size_type ring_capacity);
     SharedQueue(SharedQueue &&) = default;
     SharedQueue &operator = (SharedQueue &&) = default;
     SharedQueue(const SharedQueue &) = delete;
     SharedQueue &operator = (const SharedQueue &) = delete;
 
     inline void push(const value_type &element) noexcept;
+    inline void push(value_type &&element) noexcept;
+
+    // It moves all the elements in [first, last) into the queue with one
+    // lock acquisition (none in the ring buffer mode, unless it overflows).
+    // It wakes up at most as many waiting threads as elements were pushed.
+    //
+    template<typename I>
+    inline void push_bulk(I first, I last) noexcept;
 
     // NOTE: The following method returns the data by value.
     //       Therefore, it is not as efficient as front().
@@ -70,12 +94,31 @@ public:
 
 private:
 
-    using QueueType = std::queue<value_type, std::deque<value_type>>;
+    // Deque chunks are recycled, so a steady flow of tasks doesn't keep
+    // calling the global allocator
+    //
+    using QueueType =
+        std::queue<value_type,
+                   std::deque<value_type, RecyclingAllocator<value_type>>>;
     using AutoLockable = std::lock_guard<std::mutex>;
+    using RingType = BoundedMPMCQueue<value_type>;
+
+    template<typename V>
+    inline void push_(V &&element) noexcept;
+    inline optional_ret ring_pop_front_(bool wait_on_front) noexcept;
 
     mutable std::mutex              mutex_ { };
     mutable std::condition_variable cvx_ { };
     QueueType                       queue_ { };
+
+    // Number of threads waiting in pop_front()
+    //
+    std::atomic<size_type>          waiters_ { 0 };
+
+    // These are only used when the ring buffer is in use
+    //
+    std::unique_ptr<RingType>       ring_ { };
+    std::atomic<size_type>          overflow_size_ { 0 };
 };
 
 } // namespace hmthrp
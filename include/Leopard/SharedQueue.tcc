@@ -37,14 +37,139 @@ namespace hmthrp
 {
 
 template<typename T>
+SharedQueue<T>::SharedQueue(size_type ring_capacity)
+    : ring_(ring_capacity > 0 ? std::make_unique<RingType>(ring_capacity)
+                              : nullptr)  {   }
+
+// ----------------------------------------------------------------------------
+
+template<typename T>
+template<typename V>
+inline void
+SharedQueue<T>::push_(V &&element) noexcept  {
+
+    if (ring_)  {
+        if (! ring_->try_push(std::forward<V>(element)))  {  // Ring is full
+            const AutoLockable  lock { mutex_ };
+
+            queue_.push(std::forward<V>(element));
+            overflow_size_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        // This pairs with the waiters_ increment in ring_pop_front_(). Either
+        // we see the waiter here, or the waiter sees our element.
+        //
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters_.load(std::memory_order_relaxed) > 0)  {
+            const AutoLockable  lock { mutex_ };
+
+            cvx_.notify_one();
+        }
+        return;
+    }
+
+    const AutoLockable  lock { mutex_ };
+
+    queue_.push (std::forward<V>(element));
+    if (waiters_.load(std::memory_order_relaxed) > 0)  cvx_.notify_one();
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename T>
+inline void
+SharedQueue<T>::push(const value_type &element) noexcept  { push_(element); }
+
+// ----------------------------------------------------------------------------
+
+template<typename T>
+inline void
+SharedQueue<T>::push(value_type &&element) noexcept  {
+
+    push_(std::move(element));
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename T>
+template<typename I>
 inline void
-SharedQueue<T>::push(const value_type &element) noexcept  {
+SharedQueue<T>::push_bulk(I first, I last) noexcept  {
+
+    size_type   count { 0 };
+
+    if (ring_)  {
+        std::unique_lock<std::mutex>    ul { mutex_, std::defer_lock };
+
+        for (; first != last; ++first, ++count)
+            if (! ring_->try_push(std::move(*first)))  {  // Ring is full
+                if (! ul.owns_lock())  ul.lock();
+                queue_.push(std::move(*first));
+                overflow_size_.fetch_add(1, std::memory_order_relaxed);
+            }
+        if (ul.owns_lock())  ul.unlock();
+
+        // See push_()
+        //
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters_.load(std::memory_order_relaxed) == 0)  return;
+
+        const AutoLockable  lock { mutex_ };
+        const size_type     wakeups {
+            std::min(count, waiters_.load(std::memory_order_relaxed))
+        };
+
+        for (size_type i = 0; i < wakeups; ++i)
+            cvx_.notify_one();
+        return;
+    }
 
     const AutoLockable  lock { mutex_ };
-    const bool          was_empty { queue_.empty() };
 
-    queue_.push (element);
-    if (was_empty)  cvx_.notify_all();
+    for (; first != last; ++first, ++count)
+        queue_.push(std::move(*first));
+
+    const size_type wakeups {
+        std::min(count, waiters_.load(std::memory_order_relaxed))
+    };
+
+    for (size_type i = 0; i < wakeups; ++i)
+        cvx_.notify_one();
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename T>
+inline typename SharedQueue<T>::optional_ret
+SharedQueue<T>::ring_pop_front_(bool wait_on_front) noexcept  {
+
+    optional_ret    ret { ring_->try_pop() };
+
+    if (ret.has_value() ||
+        (! wait_on_front &&
+         overflow_size_.load(std::memory_order_relaxed) == 0))
+        return (ret);
+
+    std::unique_lock<std::mutex>    ul { mutex_ };
+
+    if (queue_.empty() && wait_on_front)  {
+        waiters_.fetch_add(1, std::memory_order_seq_cst);
+        ret = ring_->try_pop();
+        if (! ret.has_value() && queue_.empty())
+            cvx_.wait_for(ul, 2s);
+        waiters_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    if (! ret.has_value())  {
+        if (! queue_.empty())  {
+            ret = std::move(queue_.front());
+            queue_.pop();
+            overflow_size_.fetch_sub(1, std::memory_order_relaxed);
+        }
+        else
+            ret = ring_->try_pop();
+    }
+    return (ret);
 }
 
 // ----------------------------------------------------------------------------
@@ -53,14 +178,19 @@ template<typename T>
 inline typename SharedQueue<T>::optional_ret
 SharedQueue<T>::pop_front(bool wait_on_front) noexcept  {
 
+    if (ring_)  return (ring_pop_front_(wait_on_front));
+
     optional_ret                    ret { };
     std::unique_lock<std::mutex>    ul { mutex_ };
 
-    if (queue_.empty() && wait_on_front)
+    if (queue_.empty() && wait_on_front)  {
+        waiters_.fetch_add(1, std::memory_order_relaxed);
         cvx_.wait_for(ul, 2s);
+        waiters_.fetch_sub(1, std::memory_order_relaxed);
+    }
 
     if (! queue_.empty())  {
-        ret = queue_.front();
+        ret = std::move(queue_.front());
         queue_.pop();
     }
     return (ret);
@@ -71,6 +201,8 @@ SharedQueue<T>::pop_front(bool wait_on_front) noexcept  {
 template<typename T>
 bool SharedQueue<T>::empty() const noexcept  {
 
+    if (ring_)  return (size() == 0);
+
     const AutoLockable  lock { mutex_ };
 
     return (queue_.empty());
@@ -82,6 +214,10 @@ template<typename T>
 typename SharedQueue<T>::size_type
 SharedQueue<T>::size() const noexcept  {
 
+    if (ring_)
+        return (ring_->size() +
+                overflow_size_.load(std::memory_order_relaxed));
+
     const AutoLockable  lock { mutex_ };
 
     return (queue_.size());
@@ -0,0 +1,89 @@
+// Hossein Moein
+// October 18, 2026
+/*
+Copyright (c) 2023-2028, Hossein Moein
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+* Neither the name of Hossein Moein and/or the Leopard nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL Hossein Moein BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// On x86 with GCC or Clang, vector kernels are compiled for AVX2 and
+// AVX-512 through function target attributes, whatever -m flags are used.
+// The CPU is checked at run time before they are called.
+//
+#if (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__x86_64__) || defined(__i386__))
+#  define HMTHRP_X86_SIMD 1
+#endif // __GNUC__ || __clang__
+
+// ----------------------------------------------------------------------------
+
+namespace hmthrp
+{
+
+// Widest vector instructions a kernel may use
+//
+enum class  SIMD_LEVEL : unsigned char  {
+    _scalar_ = 0,  // Plain C++
+    _avx2_ = 1,    // AVX2 and FMA
+    _avx512_ = 2,  // AVX-512F
+};
+
+// The best level this CPU supports. It is found once.
+//
+SIMD_LEVEL simd_level() noexcept;
+
+// Dot products of [a, a + n) and [b, b + n). Each kernel keeps several
+// independent accumulators, so consecutive adds don't wait on each other.
+// Floating point sums are reassociated, as in any parallel reduce. int32
+// products are summed in 64 bits. A level above simd_level() is lowered to
+// it.
+//
+float simd_dot(const float *a, const float *b, std::size_t n,
+               SIMD_LEVEL level = simd_level()) noexcept;
+double simd_dot(const double *a, const double *b, std::size_t n,
+                SIMD_LEVEL level = simd_level()) noexcept;
+std::int64_t simd_dot(const std::int32_t *a, const std::int32_t *b,
+                      std::size_t n,
+                      SIMD_LEVEL level = simd_level()) noexcept;
+
+} // namespace hmthrp
+
+// ----------------------------------------------------------------------------
+
+#ifndef HMTHRP_DO_NOT_INCLUDE_TCC_FILES
+#  include <Leopard/Simd.tcc>
+#endif // HMTHRP_DO_NOT_INCLUDE_TCC_FILES
+
+// ----------------------------------------------------------------------------
+
+// Local Variables:
+// mode:C++
+// tab-width:4
+// c-basic-offset:4
+// End:
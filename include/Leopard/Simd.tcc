@@ -0,0 +1,358 @@
+// Hossein Moein
+// October 18, 2026
+/*
+Copyright (c) 2023-2028, Hossein Moein
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+* Neither the name of Hossein Moein and/or the Leopard nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL Hossein Moein BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <Leopard/Simd.h>
+
+#include <algorithm>
+
+#ifdef HMTHRP_X86_SIMD
+#  include <immintrin.h>
+#endif // HMTHRP_X86_SIMD
+
+// ----------------------------------------------------------------------------
+
+namespace hmthrp
+{
+
+inline SIMD_LEVEL simd_level() noexcept  {
+
+#ifdef HMTHRP_X86_SIMD
+    static const SIMD_LEVEL level =
+        [] () -> SIMD_LEVEL  {
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx512f"))
+                return (SIMD_LEVEL::_avx512_);
+            if (__builtin_cpu_supports("avx2") &&
+                __builtin_cpu_supports("fma"))
+                return (SIMD_LEVEL::_avx2_);
+            return (SIMD_LEVEL::_scalar_);
+        } ();
+
+    return (level);
+#else
+    return (SIMD_LEVEL::_scalar_);
+#endif // HMTHRP_X86_SIMD
+}
+
+// ----------------------------------------------------------------------------
+
+// Four accumulators, for the same reason as the vector kernels
+//
+template<typename T, typename A>
+static inline A
+_scalar_dot_(const T *a, const T *b, std::size_t n) noexcept  {
+
+    A           sums[4] { };
+    std::size_t i { 0 };
+
+    for (; i + 4 <= n; i += 4)  {
+        sums[0] += A(a[i] * b[i]);
+        sums[1] += A(a[i + 1] * b[i + 1]);
+        sums[2] += A(a[i + 2] * b[i + 2]);
+        sums[3] += A(a[i + 3] * b[i + 3]);
+    }
+    if (i < n)  sums[0] += A(a[i] * b[i]);
+    if (i + 1 < n)  sums[1] += A(a[i + 1] * b[i + 1]);
+    if (i + 2 < n)  sums[2] += A(a[i + 2] * b[i + 2]);
+    return ((sums[0] + sums[1]) + (sums[2] + sums[3]));
+}
+
+// ----------------------------------------------------------------------------
+
+#ifdef HMTHRP_X86_SIMD
+
+// Each loop step does four vectors, one into each accumulator
+//
+__attribute__((target("avx2,fma")))
+static inline float
+_avx2_dot_(const float *a, const float *b, std::size_t n) noexcept  {
+
+    __m256      sums[4] {
+        _mm256_setzero_ps(), _mm256_setzero_ps(),
+        _mm256_setzero_ps(), _mm256_setzero_ps()
+    };
+    std::size_t i { 0 };
+
+    for (; i + 32 <= n; i += 32)
+        for (std::size_t k = 0; k < 4; ++k)
+            sums[k] = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + k * 8),
+                                      _mm256_loadu_ps(b + i + k * 8),
+                                      sums[k]);
+    for (; i + 8 <= n; i += 8)
+        sums[0] = _mm256_fmadd_ps(_mm256_loadu_ps(a + i),
+                                  _mm256_loadu_ps(b + i),
+                                  sums[0]);
+
+    alignas(32) float   lanes[8];
+
+    _mm256_store_ps(lanes,
+                    _mm256_add_ps(_mm256_add_ps(sums[0], sums[1]),
+                                  _mm256_add_ps(sums[2], sums[3])));
+
+    float   result { 0 };
+
+    for (const float lane : lanes)  result += lane;
+    return (result + _scalar_dot_<float, float>(a + i, b + i, n - i));
+}
+
+// --------------------------------------
+
+__attribute__((target("avx2,fma")))
+static inline double
+_avx2_dot_(const double *a, const double *b, std::size_t n) noexcept  {
+
+    __m256d     sums[4] {
+        _mm256_setzero_pd(), _mm256_setzero_pd(),
+        _mm256_setzero_pd(), _mm256_setzero_pd()
+    };
+    std::size_t i { 0 };
+
+    for (; i + 16 <= n; i += 16)
+        for (std::size_t k = 0; k < 4; ++k)
+            sums[k] = _mm256_fmadd_pd(_mm256_loadu_pd(a + i + k * 4),
+                                      _mm256_loadu_pd(b + i + k * 4),
+                                      sums[k]);
+    for (; i + 4 <= n; i += 4)
+        sums[0] = _mm256_fmadd_pd(_mm256_loadu_pd(a + i),
+                                  _mm256_loadu_pd(b + i),
+                                  sums[0]);
+
+    alignas(32) double  lanes[4];
+
+    _mm256_store_pd(lanes,
+                    _mm256_add_pd(_mm256_add_pd(sums[0], sums[1]),
+                                  _mm256_add_pd(sums[2], sums[3])));
+    return (((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) +
+            _scalar_dot_<double, double>(a + i, b + i, n - i));
+}
+
+// --------------------------------------
+
+// Products of eight int32 are widened to two vectors of four int64
+//
+__attribute__((target("avx2")))
+static inline std::int64_t
+_avx2_dot_(const std::int32_t *a, const std::int32_t *b,
+           std::size_t n) noexcept  {
+
+    __m256i     sums[2] { _mm256_setzero_si256(), _mm256_setzero_si256() };
+    std::size_t i { 0 };
+
+    for (; i + 8 <= n; i += 8)  {
+        const __m256i   products =
+            _mm256_mullo_epi32(
+                _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i)),
+                _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i)));
+
+        sums[0] = _mm256_add_epi64(
+            sums[0],
+            _mm256_cvtepi32_epi64(_mm256_castsi256_si128(products)));
+        sums[1] = _mm256_add_epi64(
+            sums[1],
+            _mm256_cvtepi32_epi64(_mm256_extracti128_si256(products, 1)));
+    }
+
+    alignas(32) std::int64_t    lanes[4];
+
+    _mm256_store_si256(reinterpret_cast<__m256i *>(lanes),
+                       _mm256_add_epi64(sums[0], sums[1]));
+    return (lanes[0] + lanes[1] + lanes[2] + lanes[3] +
+            _scalar_dot_<std::int32_t, std::int64_t>(a + i, b + i, n - i));
+}
+
+// ----------------------------------------------------------------------------
+
+__attribute__((target("avx512f")))
+static inline float
+_avx512_dot_(const float *a, const float *b, std::size_t n) noexcept  {
+
+    __m512      sums[4] {
+        _mm512_setzero_ps(), _mm512_setzero_ps(),
+        _mm512_setzero_ps(), _mm512_setzero_ps()
+    };
+    std::size_t i { 0 };
+
+    for (; i + 64 <= n; i += 64)
+        for (std::size_t k = 0; k < 4; ++k)
+            sums[k] = _mm512_fmadd_ps(_mm512_loadu_ps(a + i + k * 16),
+                                      _mm512_loadu_ps(b + i + k * 16),
+                                      sums[k]);
+    for (; i + 16 <= n; i += 16)
+        sums[0] = _mm512_fmadd_ps(_mm512_loadu_ps(a + i),
+                                  _mm512_loadu_ps(b + i),
+                                  sums[0]);
+
+    // Stored and added here, since _mm512_reduce_add_ps() starts from an
+    // undefined vector that GCC warns about
+    //
+    alignas(64) float   lanes[16];
+
+    _mm512_store_ps(lanes,
+                    _mm512_add_ps(_mm512_add_ps(sums[0], sums[1]),
+                                  _mm512_add_ps(sums[2], sums[3])));
+
+    float   result { 0 };
+
+    for (const float lane : lanes)  result += lane;
+    return (result + _scalar_dot_<float, float>(a + i, b + i, n - i));
+}
+
+// --------------------------------------
+
+__attribute__((target("avx512f")))
+static inline double
+_avx512_dot_(const double *a, const double *b, std::size_t n) noexcept  {
+
+    __m512d     sums[4] {
+        _mm512_setzero_pd(), _mm512_setzero_pd(),
+        _mm512_setzero_pd(), _mm512_setzero_pd()
+    };
+    std::size_t i { 0 };
+
+    for (; i + 32 <= n; i += 32)
+        for (std::size_t k = 0; k < 4; ++k)
+            sums[k] = _mm512_fmadd_pd(_mm512_loadu_pd(a + i + k * 8),
+                                      _mm512_loadu_pd(b + i + k * 8),
+                                      sums[k]);
+    for (; i + 8 <= n; i += 8)
+        sums[0] = _mm512_fmadd_pd(_mm512_loadu_pd(a + i),
+                                  _mm512_loadu_pd(b + i),
+                                  sums[0]);
+
+    alignas(64) double  lanes[8];
+
+    _mm512_store_pd(lanes,
+                    _mm512_add_pd(_mm512_add_pd(sums[0], sums[1]),
+                                  _mm512_add_pd(sums[2], sums[3])));
+
+    double  result { 0 };
+
+    for (const double lane : lanes)  result += lane;
+    return (result + _scalar_dot_<double, double>(a + i, b + i, n - i));
+}
+
+// --------------------------------------
+
+__attribute__((target("avx512f")))
+static inline std::int64_t
+_avx512_dot_(const std::int32_t *a, const std::int32_t *b,
+             std::size_t n) noexcept  {
+
+    __m512i     sums[2] { _mm512_setzero_si512(), _mm512_setzero_si512() };
+    std::size_t i { 0 };
+
+    for (; i + 16 <= n; i += 16)  {
+        const __m512i   products =
+            _mm512_mullo_epi32(_mm512_loadu_si512(a + i),
+                               _mm512_loadu_si512(b + i));
+
+        // The zero-masked forms, since the plain ones start from an
+        // undefined vector that GCC warns about
+        //
+        sums[0] = _mm512_add_epi64(
+            sums[0],
+            _mm512_maskz_cvtepi32_epi64(
+                0xFF, _mm512_maskz_extracti64x4_epi64(0xF, products, 0)));
+        sums[1] = _mm512_add_epi64(
+            sums[1],
+            _mm512_maskz_cvtepi32_epi64(
+                0xFF, _mm512_maskz_extracti64x4_epi64(0xF, products, 1)));
+    }
+
+    alignas(64) std::int64_t    lanes[8];
+
+    _mm512_store_si512(lanes, _mm512_add_epi64(sums[0], sums[1]));
+
+    std::int64_t    result { 0 };
+
+    for (const std::int64_t lane : lanes)  result += lane;
+    return (result +
+            _scalar_dot_<std::int32_t, std::int64_t>(a + i, b + i, n - i));
+}
+
+#endif // HMTHRP_X86_SIMD
+
+// ----------------------------------------------------------------------------
+
+// They pick the kernel of the lower of level and what the CPU supports
+//
+template<typename T, typename A>
+static inline A
+_simd_dot_(const T *a, const T *b, std::size_t n, SIMD_LEVEL level) noexcept {
+
+#ifdef HMTHRP_X86_SIMD
+    switch (std::min(level, simd_level()))  {
+    case SIMD_LEVEL::_avx512_:
+        return (_avx512_dot_(a, b, n));
+    case SIMD_LEVEL::_avx2_:
+        return (_avx2_dot_(a, b, n));
+    default:
+        break;
+    }
+#endif // HMTHRP_X86_SIMD
+    (void) level;
+    return (_scalar_dot_<T, A>(a, b, n));
+}
+
+// --------------------------------------
+
+inline float
+simd_dot(const float *a, const float *b, std::size_t n,
+         SIMD_LEVEL level) noexcept  {
+
+    return (_simd_dot_<float, float>(a, b, n, level));
+}
+
+// --------------------------------------
+
+inline double
+simd_dot(const double *a, const double *b, std::size_t n,
+         SIMD_LEVEL level) noexcept  {
+
+    return (_simd_dot_<double, double>(a, b, n, level));
+}
+
+// --------------------------------------
+
+inline std::int64_t
+simd_dot(const std::int32_t *a, const std::int32_t *b, std::size_t n,
+         SIMD_LEVEL level) noexcept  {
+
+    return (_simd_dot_<std::int32_t, std::int64_t>(a, b, n, level));
+}
+
+} // namespace hmthrp
+
+// ----------------------------------------------------------------------------
+
+// Local Variables:
+// mode:C++
+// tab-width:4
+// c-basic-offset:4
+// End:
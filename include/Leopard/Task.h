@@ -0,0 +1,234 @@
+// Hossein Moein
+// October 18, 2026
+/*
+Copyright (c) 2023-2028, Hossein Moein
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+* Neither the name of Hossein Moein and/or the Leopard nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL Hossein Moein BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include <Leopard/RecyclingAllocator.h>
+
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+// ----------------------------------------------------------------------------
+
+namespace hmthrp
+{
+
+// A lazy coroutine returning T. It doesn't start until it is awaited (or
+// passed to sync_wait()). Then, it runs on the awaiting thread until it
+// awaits something else, e.g. ThreadPool::schedule() to move to a pool
+// thread:
+//
+//     task<std::size_t> count_words(ThreadPool &pool, std::string path)  {
+//
+//         co_await pool.schedule();  // From here on, on a pool thread
+//
+//         const std::string   text { co_await read_file(pool, path) };
+//
+//         co_return (count(text));
+//     }
+//
+//     const std::size_t   n { sync_wait(count_words(pool, "a.txt")) };
+//
+// Awaiting a task and finishing one both transfer control directly to the
+// next coroutine (symmetric transfer). So, long chains of tasks that
+// finish synchronously don't grow the stack. GCC only does that as a tail
+// call when optimizing (-O2).
+// Coroutine frames come from BlockCache. So, in the steady state creating a
+// task doesn't call the global allocator.
+//
+template<typename T = void>
+class   task  {
+
+public:
+
+    using value_type = T;
+
+    class   promise_type;
+
+    using handle_type = std::coroutine_handle<promise_type>;
+
+    task() noexcept = default;
+    task(task &&that) noexcept;
+    task &operator = (task &&that) noexcept;
+    task(const task &) = delete;
+    task &operator = (const task &) = delete;
+    ~task();
+
+    // It starts the task and resumes the awaiting coroutine, when the task
+    // is finished, with its result. If the task threw, it is rethrown.
+    //
+    auto operator co_await () && noexcept;
+
+    bool valid() const noexcept  { return (bool(handle_)); }
+    bool done() const noexcept;
+
+private:
+
+    template<typename U>
+    friend U sync_wait(task<U> &&t);
+
+    // It starts the task and resumes the awaiting coroutine when it is
+    // finished, without looking at the result
+    //
+    struct  Awaiter  {
+
+        bool await_ready() const noexcept;
+        std::coroutine_handle<>
+        await_suspend(std::coroutine_handle<> awaiting) noexcept;
+        void await_resume() const noexcept  {   }
+
+        handle_type handle;
+    };
+
+    explicit task(handle_type handle) noexcept : handle_(handle)  {   }
+
+    T result_();  // Once the task is finished
+
+    handle_type handle_ { };
+};
+
+// ----------------------------------------------------------------------------
+
+// Result of a task and how to get back to its awaiter
+//
+template<typename T>
+class   TaskPromiseBase  {
+
+public:
+
+    std::suspend_always initial_suspend() const noexcept  { return { }; }
+
+    struct  FinalAwaiter  {
+
+        bool await_ready() const noexcept  { return (false); }
+        template<typename P>
+        std::coroutine_handle<>
+        await_suspend(std::coroutine_handle<P> finished) const noexcept;
+        void await_resume() const noexcept  {   }
+    };
+
+    FinalAwaiter final_suspend() const noexcept  { return { }; }
+
+    void unhandled_exception() noexcept;
+
+    // Coroutine frames are recycled
+    //
+    static void *operator new (std::size_t bytes);
+    static void operator delete (void *ptr, std::size_t bytes) noexcept;
+
+protected:
+
+    template<typename U>
+    friend class    task;
+    template<typename U>
+    friend U sync_wait(task<U> &&t);
+
+    // sync_wait() blocks on it. It is a mutex and not an atomic, because
+    // the waiter destroys it as soon as it wakes up.
+    //
+    struct  Signal  {
+
+        void set() noexcept;
+        void wait() noexcept;
+
+        std::mutex              mutex { };
+        std::condition_variable cond { };
+        bool                    is_set { false };  // Guarded by mutex
+    };
+
+    using storage_type =
+        std::variant<std::monostate,
+                     std::conditional_t<std::is_void_v<T>,
+                                        std::monostate,
+                                        T>,
+                     std::exception_ptr>;
+
+    std::coroutine_handle<> continuation_ { };  // Who awaits us
+    Signal                  *signal_ { nullptr };  // Or who waits for us
+    storage_type            result_ { };
+};
+
+// ----------------------------------------------------------------------------
+
+template<typename T>
+class   task<T>::promise_type : public TaskPromiseBase<T>  {
+
+public:
+
+    task get_return_object() noexcept;
+
+    template<typename U>
+    requires std::convertible_to<U &&, T>
+    void return_value(U &&value);
+};
+
+// ----------------------------------------------------------------------------
+
+template<>
+class   task<void>::promise_type : public TaskPromiseBase<void>  {
+
+public:
+
+    task get_return_object() noexcept;
+
+    void return_void() noexcept;
+};
+
+// ----------------------------------------------------------------------------
+
+// It runs the task on the calling thread, until it suspends, and blocks
+// until it is finished. It returns the result of the task, or rethrows its
+// exception.
+// It must not be called on a thread of a pool that the task needs, since
+// that thread would be blocked.
+//
+template<typename T>
+T sync_wait(task<T> &&t);
+
+} // namespace hmthrp
+
+// ----------------------------------------------------------------------------
+
+#ifndef HMTHRP_DO_NOT_INCLUDE_TCC_FILES
+#  include <Leopard/Task.tcc>
+#endif // HMTHRP_DO_NOT_INCLUDE_TCC_FILES
+
+// ----------------------------------------------------------------------------
+
+// Local Variables:
+// mode:C++
+// tab-width:4
+// c-basic-offset:4
+// End:
@@ -0,0 +1,245 @@
+// Hossein Moein
+// October 18, 2026
+/*
+Copyright (c) 2023-2028, Hossein Moein
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+* Neither the name of Hossein Moein and/or the Leopard nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL Hossein Moein BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <Leopard/Task.h>
+
+#include <stdexcept>
+
+// ----------------------------------------------------------------------------
+
+namespace hmthrp
+{
+
+template<typename T>
+task<T>::task(task &&that) noexcept
+    : handle_(std::exchange(that.handle_, nullptr))  {   }
+
+// ----------------------------------------------------------------------------
+
+template<typename T>
+task<T> &task<T>::operator = (task &&that) noexcept  {
+
+    if (this != &that)  {
+        if (handle_)  handle_.destroy();
+        handle_ = std::exchange(that.handle_, nullptr);
+    }
+    return (*this);
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename T>
+task<T>::~task()  {
+
+    if (handle_)  handle_.destroy();
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename T>
+bool task<T>::done() const noexcept  {
+
+    return (handle_ && handle_.done());
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename T>
+auto task<T>::operator co_await () && noexcept  {
+
+    struct  ResultAwaiter : Awaiter  {
+
+        T await_resume()  {
+
+            if (! this->handle)
+                throw std::runtime_error(
+                    "task::co_await: The task is not valid.");
+            return (task { std::exchange(this->handle, nullptr) }.result_());
+        }
+    };
+
+    return (ResultAwaiter { { std::exchange(handle_, nullptr) } });
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename T>
+T task<T>::result_()  {
+
+    auto    &result { handle_.promise().result_ };
+
+    if (result.index() == 2)
+        std::rethrow_exception(std::get<2>(result));
+    if constexpr (! std::is_void_v<T>)
+        return (std::move(std::get<1>(result)));
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename T>
+bool task<T>::Awaiter::await_ready() const noexcept  {
+
+    return (! handle || handle.done());
+}
+
+// ----------------------------------------------------------------------------
+
+// Start the task right here. It comes back to us when it is finished.
+//
+template<typename T>
+std::coroutine_handle<>
+task<T>::Awaiter::await_suspend(std::coroutine_handle<> awaiting) noexcept  {
+
+    handle.promise().continuation_ = awaiting;
+    return (handle);
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename T>
+template<typename P>
+std::coroutine_handle<>
+TaskPromiseBase<T>::FinalAwaiter::
+await_suspend(std::coroutine_handle<P> finished) const noexcept  {
+
+    TaskPromiseBase &promise { finished.promise() };
+
+    if (promise.continuation_)  return (promise.continuation_);
+    if (promise.signal_)  promise.signal_->set();
+    return (std::noop_coroutine());
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename T>
+void TaskPromiseBase<T>::unhandled_exception() noexcept  {
+
+    result_.template emplace<2>(std::current_exception());
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename T>
+void *TaskPromiseBase<T>::operator new (std::size_t bytes)  {
+
+    return (BlockCache::allocate(bytes, alignof(std::max_align_t)));
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename T>
+void
+TaskPromiseBase<T>::operator delete (void *ptr, std::size_t bytes) noexcept  {
+
+    BlockCache::deallocate(ptr, bytes, alignof(std::max_align_t));
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename T>
+void TaskPromiseBase<T>::Signal::set() noexcept  {
+
+    const std::lock_guard<std::mutex>   guard { mutex };
+
+    is_set = true;
+    cond.notify_one();
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename T>
+void TaskPromiseBase<T>::Signal::wait() noexcept  {
+
+    std::unique_lock<std::mutex>    lock { mutex };
+
+    cond.wait(lock, [this]() -> bool  { return (is_set); });
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename T>
+task<T> task<T>::promise_type::get_return_object() noexcept  {
+
+    return (task { handle_type::from_promise(*this) });
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename T>
+template<typename U>
+requires std::convertible_to<U &&, T>
+void task<T>::promise_type::return_value(U &&value)  {
+
+    this->result_.template emplace<1>(std::forward<U>(value));
+}
+
+// ----------------------------------------------------------------------------
+
+inline task<void> task<void>::promise_type::get_return_object() noexcept  {
+
+    return (task { handle_type::from_promise(*this) });
+}
+
+// ----------------------------------------------------------------------------
+
+inline void task<void>::promise_type::return_void() noexcept  {
+
+    result_.emplace<1>();
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename T>
+T sync_wait(task<T> &&t)  {
+
+    if (! t.handle_)
+        throw std::runtime_error("sync_wait(): The task is not valid.");
+
+    using signal_t = typename TaskPromiseBase<T>::Signal;
+
+    task<T>     owned { std::move(t) };
+    signal_t    finished { };
+
+    if (! owned.handle_.done())  {
+        owned.handle_.promise().signal_ = &finished;
+        owned.handle_.resume();
+        finished.wait();
+    }
+    return (owned.result_());
+}
+
+} // namespace hmthrp
+
+// ----------------------------------------------------------------------------
+
+// Local Variables:
+// mode:C++
+// tab-width:4
+// c-basic-offset:4
+// End:
@@ -0,0 +1,134 @@
+// Hossein Moein
+// October 18, 2026
+/*
+Copyright (c) 2023-2028, Hossein Moein
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+* Neither the name of Hossein Moein and/or the Leopard nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL Hossein Moein BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include <Leopard/InlineTask.h>
+
+#include <concepts>
+#include <cstddef>
+#include <vector>
+
+// ----------------------------------------------------------------------------
+
+namespace hmthrp
+{
+
+class   ThreadPool;
+
+// ----------------------------------------------------------------------------
+
+// A directed acyclic graph of tasks. An edge from a to b means b may only
+// start after a has finished. ThreadPool::run_graph() runs it:
+//
+//     TaskGraph   graph;
+//     const auto  load = graph.add_node(load_data);
+//     const auto  left = graph.add_node(process_left);
+//     const auto  right = graph.add_node(process_right);
+//     const auto  merge = graph.add_node(merge_halves);
+//
+//     graph.add_edge(load, left);
+//     graph.add_edge(load, right);
+//     graph.add_edge(left, merge);
+//     graph.add_edge(right, merge);
+//     pool.run_graph(graph);
+//
+// A node is queued only when the last of its predecessors finishes, so no
+// thread ever blocks waiting for a dependency.
+// A graph may be run many times, but not by two threads at once.
+//
+class   TaskGraph  {
+
+public:
+
+    using size_type = std::size_t;
+    using node_type = size_type;  // Index of a node, in the order added
+
+    TaskGraph() = default;
+    TaskGraph(TaskGraph &&) = default;
+    TaskGraph &operator = (TaskGraph &&) = default;
+    TaskGraph(const TaskGraph &) = delete;
+    TaskGraph &operator = (const TaskGraph &) = delete;
+
+    // routine is called once every time the graph is run
+    //
+    template<typename F>
+    requires std::invocable<std::decay_t<F> &>
+    node_type add_node(F &&routine);
+
+    // to runs after from. Adding the same edge twice is harmless.
+    //
+    void add_edge(node_type from, node_type to);
+
+    size_type nodes() const noexcept;
+    size_type edges() const noexcept;
+    size_type successors(node_type node) const;
+    size_type predecessors(node_type node) const;
+    bool empty() const noexcept;
+    void clear() noexcept;
+    void reserve(size_type node_count);
+
+private:
+
+    friend class    ThreadPool;
+
+    struct  Node  {
+
+        InlineTask              task { };
+        std::vector<node_type>  successors { };
+        size_type               in_degree { 0 };
+    };
+
+    void check_node_(node_type node, const char *func_name) const;
+
+    // It topologically sorts the graph once after every change
+    //
+    bool is_acyclic_();
+
+    std::vector<Node>   nodes_ { };
+    size_type           edges_ { 0 };
+    bool                checked_ { true };  // Is acyclic_ up to date
+    bool                acyclic_ { true };
+};
+
+} // namespace hmthrp
+
+// ----------------------------------------------------------------------------
+
+#ifndef HMTHRP_DO_NOT_INCLUDE_TCC_FILES
+#  include <Leopard/TaskGraph.tcc>
+#endif // HMTHRP_DO_NOT_INCLUDE_TCC_FILES
+
+// ----------------------------------------------------------------------------
+
+// Local Variables:
+// mode:C++
+// tab-width:4
+// c-basic-offset:4
+// End:
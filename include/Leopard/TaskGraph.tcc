@@ -0,0 +1,165 @@
+// Hossein Moein
+// October 18, 2026
+/*
+Copyright (c) 2023-2028, Hossein Moein
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+* Neither the name of Hossein Moein and/or the Leopard nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL Hossein Moein BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <Leopard/TaskGraph.h>
+
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+// ----------------------------------------------------------------------------
+
+namespace hmthrp
+{
+
+template<typename F>
+requires std::invocable<std::decay_t<F> &>
+TaskGraph::node_type TaskGraph::add_node(F &&routine)  {
+
+    nodes_.push_back(Node { InlineTask { std::forward<F>(routine) } });
+    return (nodes_.size() - 1);
+}
+
+// ----------------------------------------------------------------------------
+
+inline void TaskGraph::add_edge(node_type from, node_type to)  {
+
+    check_node_(from, "add_edge");
+    check_node_(to, "add_edge");
+    if (from == to)
+        throw std::runtime_error("TaskGraph::add_edge(): "
+                                 "A node cannot depend on itself.");
+
+    nodes_[from].successors.push_back(to);
+    nodes_[to].in_degree += 1;
+    edges_ += 1;
+    checked_ = false;
+}
+
+// ----------------------------------------------------------------------------
+
+inline TaskGraph::size_type TaskGraph::nodes() const noexcept  {
+
+    return (nodes_.size());
+}
+
+// ----------------------------------------------------------------------------
+
+inline TaskGraph::size_type TaskGraph::edges() const noexcept  {
+
+    return (edges_);
+}
+
+// ----------------------------------------------------------------------------
+
+inline TaskGraph::size_type TaskGraph::successors(node_type node) const  {
+
+    check_node_(node, "successors");
+    return (nodes_[node].successors.size());
+}
+
+// ----------------------------------------------------------------------------
+
+inline TaskGraph::size_type TaskGraph::predecessors(node_type node) const  {
+
+    check_node_(node, "predecessors");
+    return (nodes_[node].in_degree);
+}
+
+// ----------------------------------------------------------------------------
+
+inline bool TaskGraph::empty() const noexcept  { return (nodes_.empty()); }
+
+// ----------------------------------------------------------------------------
+
+inline void TaskGraph::clear() noexcept  {
+
+    nodes_.clear();
+    edges_ = 0;
+    checked_ = true;
+    acyclic_ = true;
+}
+
+// ----------------------------------------------------------------------------
+
+inline void TaskGraph::reserve(size_type node_count)  {
+
+    nodes_.reserve(node_count);
+}
+
+// ----------------------------------------------------------------------------
+
+inline void
+TaskGraph::check_node_(node_type node, const char *func_name) const  {
+
+    if (node >= nodes_.size())
+        throw std::runtime_error(std::string("TaskGraph::") + func_name +
+                                 "(): Node " + std::to_string(node) +
+                                 " is out of range.");
+}
+
+// ----------------------------------------------------------------------------
+
+// Kahn's algorithm. If some nodes are never freed, they are on a cycle.
+//
+inline bool TaskGraph::is_acyclic_()  {
+
+    if (checked_)  return (acyclic_);
+
+    std::vector<size_type>  remaining (nodes_.size());
+    std::vector<node_type>  ready;
+    size_type               visited { 0 };
+
+    ready.reserve(nodes_.size());
+    for (node_type i = 0; i < nodes_.size(); ++i)  {
+        remaining[i] = nodes_[i].in_degree;
+        if (remaining[i] == 0)  ready.push_back(i);
+    }
+    while (! ready.empty())  {
+        const node_type node { ready.back() };
+
+        ready.pop_back();
+        visited += 1;
+        for (const node_type succ : nodes_[node].successors)
+            if (--remaining[succ] == 0)  ready.push_back(succ);
+    }
+    acyclic_ = visited == nodes_.size();
+    checked_ = true;
+    return (acyclic_);
+}
+
+} // namespace hmthrp
+
+// ----------------------------------------------------------------------------
+
+// Local Variables:
+// mode:C++
+// tab-width:4
+// c-basic-offset:4
+// End:
@@ -29,23 +29,39 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #pragma once
 
+#include <Leopard/Cancellation.h>
+#include <Leopard/EventCount.h>
+#include <Leopard/InlineTask.h>
+#include <Leopard/MapReduce.h>
+#include <Leopard/RecyclingAllocator.h>
 #include <Leopard/SharedQueue.h>
+#include <Leopard/Simd.h>
+#include <Leopard/Task.h>
+#include <Leopard/TaskGraph.h>
+#include <Leopard/TimerWheel.h>
+#include <Leopard/Topology.h>
+#include <Leopard/WorkStealingDeque.h>
 
+#include <array>
 #include <atomic>
 #include <concepts>
 #include <condition_variable>
+#include <coroutine>
 #include <functional>
 #include <future>
 #include <iterator>
 #include <list>
 #include <mutex>
+#include <optional>
 #include <ranges>
 #include <thread>
 #include <type_traits>
 #include <utility>
 #include <vector>
 #include <chrono>
+#include <cstdint>
 #include <cstdlib>
+#include <exception>
 #include <functional>
 #include <memory>
 #include <stdexcept>
@@ -78,15 +94,179 @@ private:
 
 // ----------------------------------------------------------------------------
 
+// How pool threads are placed on CPUs
+//
+enum class  THREAD_AFFINITY : unsigned char  {
+    _none_ = 0,    // The OS places the threads
+    _pin_ = 1,     // Thread i is pinned to PoolOptions::cpu_set[i % size]
+    _spread_ = 2,  // Pinned across NUMA nodes, then L3 caches, round-robin
+};
+
+// ----------------------------------------------------------------------------
+
+// Every priority has its own lane in the global and local queues
+//
+enum class  TASK_PRIORITY : unsigned char  {
+    _high_ = 0,        // Latency critical
+    _normal_ = 1,      // Default
+    _background_ = 2,  // Batch work
+};
+
+inline constexpr std::size_t    TASK_PRIORITY_COUNT = 3;
+
+// ----------------------------------------------------------------------------
+
+// How parallel_loop() and parallel_loop2() split the iterations among
+// threads. chunk_size is the number of iterations passed to one call of the
+// routine. 0 lets the pool pick.
+//
+enum class  LOOP_SCHEDULE : unsigned char  {
+    _static_ = 0,   // Threads take chunks in turn. By default, one per thread.
+    _dynamic_ = 1,  // Threads claim the next chunk, whenever they are free
+    _guided_ = 2,   // Dynamic, with chunks shrinking down to chunk_size
+    _auto_ = 3,     // Guided, with a minimum chunk picked by the pool
+};
+
+// ----------------------------------------------------------------------------
+
+// Keys that parallel_radix_sort() can sort by. Floating point keys must be
+// IEEE-754 single or double precision.
+//
+template<typename T>
+concept RadixKey =
+    (std::integral<T> && ! std::same_as<T, bool>) ||
+    (std::floating_point<T> && (sizeof(T) == 4 || sizeof(T) == 8));
+
+// ----------------------------------------------------------------------------
+
+// Options that can only be specified when the pool is constructed
+//
+struct  PoolOptions  {
+
+    // If it is not 0, the global queue is a lock-free bounded ring buffer
+    // with this capacity (rounded up to a power of 2). Tasks that don't fit
+    // in the ring spill into a mutex guarded queue. If it is 0, the global
+    // queue is a mutex guarded std::deque.
+    //
+    std::size_t global_queue_capacity { 0 };
+
+    // If true, a thread that steals from another thread's queue takes up to
+    // half of its tasks in one go. It runs one and keeps the rest in its own
+    // queue. It cuts down the steal traffic when tasks come in bursts.
+    //
+    bool        steal_half { false };
+
+    // An idle thread spins this many CPU pause instructions, with
+    // exponential backoff, before it parks. A parked thread takes no CPU
+    // and is woken up when a task is queued. 0 means park right away.
+    //
+    std::size_t spin_count { 2048 };
+
+    // If it is not _none_, every thread is pinned to one CPU, and there is
+    // one global queue per NUMA node the threads are on. Threads prefer
+    // tasks and victims on their own L3 cache and node. The CPU topology
+    // is read from /sys on Linux. Elsewhere, threads are not pinned.
+    //
+    THREAD_AFFINITY             affinity { THREAD_AFFINITY::_none_ };
+    std::vector<unsigned int>   cpu_set { };  // Empty means all CPUs
+
+    // The machine layout to use instead of the one read from the system.
+    // It must outlive the constructor.
+    //
+    const Topology              *topology { nullptr };
+
+    // Out of every sum(priority_weights) picks, a thread starts looking in
+    // the high, normal and background lanes this many times respectively.
+    // If the lane is empty, it takes from the others in priority order. So
+    // lower priorities get a share of the threads and never starve.
+    // All weights must be positive.
+    //
+    std::array<std::size_t, TASK_PRIORITY_COUNT>    priority_weights {
+        16, 4, 1
+    };
+
+    // If true, how long every task waits in the queues is recorded per
+    // priority (see ThreadPool::queue_wait_stats()). It costs two clock
+    // reads per task.
+    //
+    bool    track_queue_wait { false };
+
+    // Resolution of dispatch_after(), dispatch_at() and dispatch_every().
+    // Times are rounded up to it. It must be positive.
+    //
+    std::chrono::nanoseconds    timer_tick { std::chrono::milliseconds { 1 } };
+};
+
+// ----------------------------------------------------------------------------
+
+// Counters of a pool thread (see ThreadPool::worker_stats())
+//
+struct  WorkerStats  {
+
+    std::size_t executed { 0 };     // Tasks it ran
+    std::size_t steals { 0 };       // Successful steals it did
+    std::size_t stolen { 0 };       // Tasks it took from other threads
+    std::size_t stolen_from { 0 };  // Tasks other threads took from it
+};
+
+// ----------------------------------------------------------------------------
+
+// How long tasks of a priority waited in the queues before a pool thread
+// started running them (see ThreadPool::queue_wait_stats())
+//
+struct  QueueWaitStats  {
+
+    inline static constexpr std::size_t BUCKETS = 64;
+
+    std::size_t     count { 0 };
+    std::uint64_t   total_ns { 0 };
+    std::uint64_t   max_ns { 0 };
+
+    // histogram[0] counts waits of 0 ns and histogram[i] waits in
+    // [2^(i-1), 2^i) ns
+    //
+    std::array<std::size_t, BUCKETS>    histogram { };
+
+    double mean_ns() const noexcept;
+
+    // An upper bound of the p'th (0 < p <= 1) percentile wait
+    //
+    std::uint64_t percentile_ns(double p) const noexcept;
+};
+
+// ----------------------------------------------------------------------------
+
+// A timer of ThreadPool::dispatch_after(), dispatch_at() or dispatch_every()
+// (see ThreadPool::cancel_timer())
+//
+struct  TimerId  {
+
+    std::uint64_t   value { 0 };  // 0 is never a timer
+};
+
+// ----------------------------------------------------------------------------
+
+class   TaskGroup;
+template<typename T>
+class   TaskFuture;
+
+// ----------------------------------------------------------------------------
+
 class   ThreadPool  {
 
 public:
 
     using size_type = long;
     using thread_type = std::thread;
+    using exception_handler_type = std::function<void(std::exception_ptr)>;
 
     inline static constexpr size_type   MUL_THR_THHOLD = 250'000L;
 
+    // The longest run of CPU pause instructions an idle thread does before
+    // checking for tasks again
+    //
+    inline static constexpr std::size_t MAX_BACKOFF = 64;
+
     ThreadPool(const ThreadPool &) = delete;
     ThreadPool &operator = (const ThreadPool &) = delete;
 
@@ -98,6 +278,10 @@ public:
     ThreadPool(size_type thr_num = std::thread::hardware_concurrency(),
                Conditioner pre_conditioner = Conditioner { },
                Conditioner post_conditioner = Conditioner { });
+    ThreadPool(size_type thr_num,
+               const PoolOptions &options,
+               Conditioner pre_conditioner = Conditioner { },
+               Conditioner post_conditioner = Conditioner { });
     ~ThreadPool();
 
     template<typename F, typename ... As>
@@ -122,31 +306,463 @@ public:
                                                      std::decay_t<I2>,
                                                      std::decay_t<As> ...>>>;
 
+    template<typename G>
+    requires std::invocable<G &, size_type> &&
+             std::invocable<std::invoke_result_t<G &, size_type>>
+    using bulk_res_t =
+        std::vector<std::future<std::invoke_result_t<
+            std::decay_t<std::invoke_result_t<G &, size_type>>>>>;
+    template<std::ranges::input_range R>
+    requires std::invocable<std::ranges::range_value_t<R> &>
+    using range_bulk_res_t =
+        std::vector<std::future<std::invoke_result_t<
+            std::ranges::range_value_t<R>>>>;
+
+    template<typename F, typename ... As>
+    requires std::invocable<F, As ...>
+    using timer_res_t = std::pair<TimerId, dispatch_res_t<F, As ...>>;
+
+    template<typename F, typename ... As>
+    requires std::invocable<F, As ...>
+    using task_future_t =
+        TaskFuture<std::invoke_result_t<std::decay_t<F>,
+                                        std::decay_t<As> ...>>;
+
     // The return type of dispatch is std::future of return type of routine
     //
     template<typename F, typename ... As>
     dispatch_res_t<F, As ...>
     dispatch(bool immediately, F &&routine, As && ... args);
 
+    // Same as above, with the given priority instead of _normal_
+    //
+    template<typename F, typename ... As>
+    dispatch_res_t<F, As ...>
+    dispatch(TASK_PRIORITY priority,
+             bool immediately,
+             F &&routine,
+             As && ... args);
+
+    // Same as above, but if token is cancelled before a thread picks the
+    // task up, the routine is not run and the future gets TaskCancelled.
+    // If it is already cancelled, the task isn't even queued.
+    //
+    template<typename F, typename ... As>
+    dispatch_res_t<F, As ...>
+    dispatch(const CancellationToken &token,
+             bool immediately,
+             F &&routine,
+             As && ... args);
+
+    // Fire-and-forget version of dispatch. There is no future to set, so
+    // it is cheaper. If the routine throws, the exception is passed to the
+    // pool exception handler.
+    //
+    template<typename F, typename ... As>
+    requires std::invocable<F, As ...>
+    void post(F &&routine, As && ... args);
+    template<typename F, typename ... As>
+    requires std::invocable<F, As ...>
+    void post(TASK_PRIORITY priority, F &&routine, As && ... args);
+
+    // They dispatch routine(args ...) after delay, or at the given time.
+    // They return the id of the timer and the future of the routine.
+    // Timers are kept in a hierarchical timing wheel, so adding and
+    // cancelling one is O(1), and there are no timer threads. Pool threads
+    // check the wheel between tasks, and one parked thread sleeps until the
+    // next timer is due. So a timer is late only if all threads are busy
+    // with long tasks.
+    //
+    template<typename R, typename P, typename F, typename ... As>
+    timer_res_t<F, As ...>
+    dispatch_after(std::chrono::duration<R, P> delay,
+                   F &&routine,
+                   As && ... args);
+    template<typename C, typename D, typename F, typename ... As>
+    timer_res_t<F, As ...>
+    dispatch_at(std::chrono::time_point<C, D> when,
+                F &&routine,
+                As && ... args);
+
+    // It posts routine(args ...) every period, starting a period from now,
+    // until the timer is cancelled. A run is skipped, if the last one is
+    // still running. If the routine throws, the exception is passed to the
+    // pool exception handler.
+    //
+    template<typename R, typename P, typename F, typename ... As>
+    requires std::invocable<F, As ...>
+    TimerId
+    dispatch_every(std::chrono::duration<R, P> period,
+                   F &&routine,
+                   As && ... args);
+
+    // It cancels a timer that hasn't fired yet, or a periodic one. The
+    // future of a cancelled dispatch_after()/dispatch_at() gets
+    // TaskCancelled. Runs of a periodic timer that are still queued are
+    // dropped. It returns false, if there is no such timer (anymore).
+    //
+    bool cancel_timer(TimerId id) noexcept;
+
+    // It queues the routine on the global queue of the given NUMA node, so
+    // it is most likely run by a thread on that node, close to its data.
+    // node must be less than node_count().
+    //
+    template<typename F, typename ... As>
+    dispatch_res_t<F, As ...>
+    dispatch_on_node(size_type node, F &&routine, As && ... args);
+
+    // They queue many tasks at once. All the tasks are pushed into the
+    // global queue with one lock acquisition, and at most as many sleeping
+    // threads as there are tasks are woken up.
+    // generator(i) must return the i'th callable for i in [0, n).
+    // Callables in an lvalue range are copied, otherwise they are moved.
+    //
+    template<typename G>
+    requires std::invocable<G &, size_type> &&
+             std::invocable<std::invoke_result_t<G &, size_type>>
+    bulk_res_t<G>
+    dispatch_bulk(size_type n, G &&generator);
+    template<std::ranges::input_range R>
+    requires std::invocable<std::ranges::range_value_t<R> &>
+    range_bulk_res_t<R>
+    dispatch_bulk(R &&callables);
+
+    template<typename G>
+    requires std::invocable<G &, size_type> &&
+             std::invocable<std::invoke_result_t<G &, size_type>>
+    void post_bulk(size_type n, G &&generator);
+    template<std::ranges::input_range R>
+    requires std::invocable<std::ranges::range_value_t<R> &>
+    void post_bulk(R &&callables);
+
     // It dispatches n / number_of_capacity_threads tasks where n is the
     // distance between begin and end.
+    // If there are many NUMA nodes, consecutive blocks go to the same node.
+    // So, loops over the same data run each slice on the same node.
     //
     template<typename F, typename I, typename ... As>
     loop_res_t<F, I, As ...>
     parallel_loop(I begin, I end, F &&routine, As && ... args);
 
+    // Same as above, with the given scheduling policy (see LOOP_SCHEDULE).
+    // There is one future per chunk, in the order of the range.
+    // If begin > end in an integral range, chunks go from begin down to end,
+    // and the routine gets the lowest and highest index of each chunk, as
+    // above.
+    //
+    template<typename F, typename I, typename ... As>
+    loop_res_t<F, I, As ...>
+    parallel_loop(LOOP_SCHEDULE schedule,
+                  size_type chunk_size,
+                  I begin,
+                  I end,
+                  F &&routine,
+                  As && ... args);
+
+    // Same as above, but chunks that haven't started when token is
+    // cancelled are not run, and their futures get TaskCancelled
+    //
+    template<typename F, typename I, typename ... As>
+    loop_res_t<F, I, As ...>
+    parallel_loop(const CancellationToken &token,
+                  I begin,
+                  I end,
+                  F &&routine,
+                  As && ... args);
+    template<typename F, typename I, typename ... As>
+    loop_res_t<F, I, As ...>
+    parallel_loop(const CancellationToken &token,
+                  LOOP_SCHEDULE schedule,
+                  size_type chunk_size,
+                  I begin,
+                  I end,
+                  F &&routine,
+                  As && ... args);
+
     // Parallel loop operating with two ranges
     //
     template<typename F, typename I1, typename I2, typename ... As>
     loop2_res_t<F, I1, I2, As ...>
     parallel_loop2(I1 begin1, I1 end1, I2 begin2, I2 end2,
                    F &&routine, As && ... args);
+    template<typename F, typename I1, typename I2, typename ... As>
+    loop2_res_t<F, I1, I2, As ...>
+    parallel_loop2(LOOP_SCHEDULE schedule,
+                   size_type chunk_size,
+                   I1 begin1,
+                   I1 end1,
+                   I2 begin2,
+                   I2 end2,
+                   F &&routine,
+                   As && ... args);
 
+    // It sorts [begin, end) with a parallel sample sort. A sorted,
+    // oversampled set of splitters divides the values into buckets. The
+    // elements are classified and scattered to their buckets in parallel
+    // with per-thread counts, and then the buckets are sorted in parallel.
+    // Every splitter also has a bucket of its own for the values equivalent
+    // to it, so many duplicates don't end up in one big bucket.
+    // It needs a scratch buffer of n default constructed elements. If the
+    // value type is not default constructible, a parallel quick sort is
+    // used instead. Ranges not bigger than TH are sorted by std::sort.
+    //
     template<std::random_access_iterator I, long TH = 5000L>
     void parallel_sort(const I begin, const I end);
     template<std::random_access_iterator I, typename P, long TH = 5000L>
     void parallel_sort(const I begin, const I end, P compare);
 
+    // Like std::adjacent_difference, it writes *begin to *out and then
+    // op(element i, element i - 1) for every following element. It returns
+    // the end of the output. out may be begin. The element before each
+    // block is saved before any block is written, so blocks that are done
+    // in place still see their original neighbours.
+    //
+    template<std::random_access_iterator I, std::random_access_iterator O,
+             typename BOP = std::minus<>, long TH = 5000L>
+    O parallel_adjacent_difference(I begin, I end, O out, BOP op = { });
+
+    // It writes op(first, center, last) to the output of every element of
+    // [begin, end), and returns the end of the output. center points to the
+    // element, and [first, last) is its window of radius elements on each
+    // side. Windows are clipped at begin and end, but not at the blocks the
+    // range is split into. So, op never has to handle block boundaries.
+    // For a trailing window of w elements, radius is w - 1 and op reads
+    // [first, center + 1).
+    // out must not overlap [begin, end).
+    //
+    template<std::random_access_iterator I, std::random_access_iterator O,
+             typename F, long TH = 5000L>
+    requires std::invocable<F &, I, I, I>
+    O parallel_stencil(I begin, I end, O out, size_type radius, F op);
+
+    // They sort [begin, end) stably with a parallel merge sort. The range is
+    // cut into one run per thread, and the runs are sorted in parallel by
+    // std::stable_sort. Then pairs of runs are merged pass by pass, between
+    // the range and one scratch buffer of n elements. Each merge is split
+    // into pieces of its output that are merged in parallel. The co-rank of
+    // a piece, i.e. how many of its elements come from each run, is found by
+    // a binary search.
+    // Ranges not bigger than TH, and value types that are not default
+    // constructible, are sorted by std::stable_sort.
+    //
+    template<std::random_access_iterator I, long TH = 5000L>
+    void parallel_stable_sort(I begin, I end);
+    template<std::random_access_iterator I, typename P, long TH = 5000L>
+    void parallel_stable_sort(I begin, I end, P compare);
+
+    // They sort [begin, end) with a parallel LSD radix sort, one byte of the
+    // key per pass. In every pass, each thread counts the bytes of its block,
+    // a prefix sum over the counts gives every thread its own output ranges,
+    // and each thread scatters its block through small per-bucket buffers of
+    // a cache line. Passes in which every key has the same byte are skipped.
+    // Negative numbers sort before positive ones. Floating point keys are
+    // ordered by their sign and magnitude bits, so -0.0 comes before 0.0 and
+    // NaNs go to the ends, by their sign.
+    // The second version sorts records by key(record), which must return a
+    // RadixKey. It is stable. It sorts (key, index) pairs and then moves each
+    // record once to its place. That uses a scratch buffer of records if
+    // they are default constructible. Otherwise, the records are permuted in
+    // place by one thread.
+    // Ranges not bigger than TH are sorted by comparison.
+    //
+    template<std::random_access_iterator I, long TH = 5000L>
+    requires RadixKey<std::iter_value_t<I>>
+    void parallel_radix_sort(I begin, I end);
+    template<std::random_access_iterator I, typename K, long TH = 5000L>
+    requires RadixKey<std::remove_cvref_t<
+        std::invoke_result_t<K &, std::iter_reference_t<I>>>>
+    void parallel_radix_sort(I begin, I end, K key);
+
+    // Like std::nth_element, they put the element that would be at nth if
+    // [begin, end) were sorted there, with no element after it before it.
+    // Each step picks a median of three pivot and partitions the range in
+    // parallel. Threads partition their own blocks, and then the elements
+    // on the wrong side of the cut are swapped in parallel. Only the side
+    // holding nth is kept. Ranges not bigger than TH, and ranges that are
+    // still big after 2 * log2(n) steps, are finished by std::nth_element.
+    //
+    template<std::random_access_iterator I, long TH = 5000L>
+    void parallel_nth_element(I begin, I nth, I end);
+    template<std::random_access_iterator I, typename P, long TH = 5000L>
+    void parallel_nth_element(I begin, I nth, I end, P compare);
+
+    // Like std::partial_sort, they put the middle - begin smallest elements
+    // in order at the front. The rest are left in an unspecified order.
+    // It is parallel_nth_element() followed by parallel_sort() of the
+    // front.
+    //
+    template<std::random_access_iterator I, long TH = 5000L>
+    void parallel_partial_sort(I begin, I middle, I end);
+    template<std::random_access_iterator I, typename P, long TH = 5000L>
+    void parallel_partial_sort(I begin, I middle, I end, P compare);
+
+    // It returns the k elements that would come first if [begin, end) were
+    // sorted by compare, in that order. By default, these are the k largest.
+    // [begin, end) is not changed. Threads claim chunks of the range, and
+    // each keeps the best k it has seen in a heap of its own. The heaps are
+    // merged at the end. If the heaps together could be as big as the range,
+    // the range is copied and parallel_partial_sort() is used instead.
+    // It throws std::runtime_error if k is negative.
+    //
+    template<std::random_access_iterator I, typename P = std::greater<>,
+             long TH = 5000L>
+    std::vector<std::iter_value_t<I>>
+    parallel_top_k(I begin, I end, size_type k, P compare = { });
+
+    // Like std::find_if, it returns the first element of [begin, end) that
+    // satisfies pred, or end. Threads claim chunks of the range in order.
+    // The lowest index found so far is kept in an atomic that is checked
+    // before every element. So, a chunk stops as soon as a match before it
+    // is found, and chunks after a match are not started.
+    // The others only need some match, so they all stop at the first one.
+    // pred may be called concurrently, and on elements after the match.
+    //
+    template<std::random_access_iterator I, typename P, long TH = 5000L>
+    requires std::predicate<P &, std::iter_reference_t<I>>
+    I parallel_find_if(I begin, I end, P pred);
+    template<std::random_access_iterator I, typename P, long TH = 5000L>
+    requires std::predicate<P &, std::iter_reference_t<I>>
+    bool parallel_any_of(I begin, I end, P pred);
+    template<std::random_access_iterator I, typename P, long TH = 5000L>
+    requires std::predicate<P &, std::iter_reference_t<I>>
+    bool parallel_all_of(I begin, I end, P pred);
+    template<std::random_access_iterator I, typename P, long TH = 5000L>
+    requires std::predicate<P &, std::iter_reference_t<I>>
+    bool parallel_none_of(I begin, I end, P pred);
+
+    // They return init folded with every element (after transform_op) of
+    // [begin, end) by reduce_op. As with std::reduce, reduce_op must be
+    // associative and commutative, since the order of folding is not fixed.
+    // The calling thread and at most one task per thread claim chunks of at
+    // least TH elements. Each of them folds its chunks in its own slot, and
+    // the slots are combined pairwise at the end.
+    // The first exception thrown by an operation is rethrown.
+    //
+    template<std::random_access_iterator I, typename T, typename BOP,
+             long TH = 5000L>
+    T parallel_reduce(I begin, I end, T init, BOP reduce_op);
+    template<std::random_access_iterator I, typename T, typename BOP,
+             typename UOP, long TH = 5000L>
+    T parallel_transform_reduce(I begin, I end,
+                                T init,
+                                BOP reduce_op,
+                                UOP transform_op);
+
+    // It returns init folded by sum_op with product_op(*(begin1 + i),
+    // *(begin2 + i)) for every i of [0, end1 - begin1), as in
+    // std::inner_product. sum_op must be associative and commutative.
+    // It is done like parallel_transform_reduce(). With the default
+    // operations, contiguous ranges of float, double or int32, and T of
+    // the same floating point type or an integral type of at least 32 bits,
+    // each chunk is done by simd_dot() (see Simd.h). Then the chunks are
+    // whole cache lines of the first range.
+    //
+    template<std::random_access_iterator I1, std::random_access_iterator I2,
+             typename T,
+             typename BOP1 = std::plus<>, typename BOP2 = std::multiplies<>,
+             long TH = 5000L>
+    T parallel_inner_product(I1 begin1, I1 end1, I2 begin2,
+                             T init,
+                             BOP1 sum_op = { },
+                             BOP2 product_op = { });
+
+    // They write the prefix sums under op of transform(element) of
+    // [begin, end) to out, and return the end of the output. out may be
+    // begin. In the inclusive scan, out[i] includes element i. In the
+    // exclusive scan, it doesn't, and the first output is init.
+    // op must be associative, but it need not be commutative.
+    // It is a two pass reduce-then-scan. First, the blocks of the range,
+    // one per thread, are reduced in parallel. A short serial scan over
+    // the block sums gives every block the value it starts from. Then, all
+    // blocks are scanned in parallel. Each element is read twice.
+    // Ranges smaller than two blocks of TH elements are scanned serially.
+    // The first exception thrown by an operation is rethrown.
+    //
+    template<std::random_access_iterator I, std::random_access_iterator O,
+             typename BOP = std::plus<>, typename UOP = std::identity,
+             long TH = 5000L>
+    O parallel_inclusive_scan(I begin, I end, O out,
+                              BOP op = { },
+                              UOP transform = { });
+    template<std::random_access_iterator I, std::random_access_iterator O,
+             typename T,
+             typename BOP = std::plus<>, typename UOP = std::identity,
+             long TH = 5000L>
+    O parallel_exclusive_scan(I begin, I end, O out,
+                              T init,
+                              BOP op = { },
+                              UOP transform = { });
+
+    // It returns an empty group of tasks that run on this pool (see
+    // TaskGroup below)
+    //
+    TaskGroup make_group();
+
+    // Same as above, but once token is cancelled, the group's tasks that
+    // haven't started are dropped, and so are tasks run after that. Then
+    // wait() throws TaskCancelled, unless a task threw something else first.
+    //
+    TaskGroup make_group(CancellationToken token);
+
+    // Same as dispatch, but the returned future takes continuations that
+    // are queued when the routine finishes (see TaskFuture below)
+    //
+    template<typename F, typename ... As>
+    requires std::invocable<F, As ...>
+    task_future_t<F, As ...> async(F &&routine, As && ... args);
+
+    // It runs every node of the graph once, each after all of its
+    // predecessors, and returns when they are all finished.
+    // The calling thread runs nodes too, while it waits. If a node throws,
+    // its successors are not run, and the first exception is rethrown once
+    // the running nodes are finished.
+    // It throws, if the graph has a cycle.
+    //
+    void run_graph(TaskGraph &graph);
+
+    // It calls map_func(*iter, emitter) for every iter in [begin, end), and
+    // reduces the pairs emitted into engine (see MapReduce). The results of
+    // engine's last run are replaced.
+    // map_func is called by many threads at once, the calling thread too.
+    // If it throws, engine is cleared and the first exception is rethrown.
+    //
+    template<std::random_access_iterator I, typename F,
+             typename K, typename V, typename BOP, typename H, typename KE>
+    requires std::invocable<F &, std::iter_reference_t<I>,
+                            typename MapReduce<K, V, BOP, H, KE>::Emitter &>
+    void run_map_reduce(MapReduce<K, V, BOP, H, KE> &engine,
+                        I begin, I end,
+                        F map_func);
+
+    // It is returned by schedule(). Awaiting it suspends the coroutine and
+    // queues a task that resumes it on a pool thread.
+    //
+    class   ScheduleAwaiter  {
+
+    public:
+
+        bool await_ready() const noexcept  { return (false); }
+        void await_suspend(std::coroutine_handle<> awaiting);
+        void await_resume() const noexcept  {   }
+
+    private:
+
+        friend class    ThreadPool;
+
+        ScheduleAwaiter(ThreadPool &pool, TASK_PRIORITY priority) noexcept
+            : pool_(pool), priority_(priority)  {   }
+
+        ThreadPool      &pool_;
+        TASK_PRIORITY   priority_;
+    };
+
+    // co_await pool.schedule() continues the coroutine on a pool thread (see
+    // task in Task.h). On a pool thread, it lets other tasks run first.
+    // The await throws, if the pool has 0 thread capacity.
+    //
+    ScheduleAwaiter
+    schedule(TASK_PRIORITY priority = TASK_PRIORITY::_normal_) noexcept;
+
 
     // It attaches the current thread to the pool so that it may be used for
     // executing submitted tasks. It blocks the calling thread until the pool
@@ -166,13 +782,35 @@ public:
     size_type available_threads() const noexcept;
     size_type capacity_threads() const noexcept;
     size_type pending_tasks() const noexcept; // How many tasks in the queue
+    size_type node_count() const noexcept;  // Number of global queues
+    size_type pending_timers() const noexcept;  // Timers in the wheel
     bool is_shutdown() const noexcept;
 
     bool shutdown() noexcept;
 
+    // It returns the counters of every local queue, one per pool thread.
+    // A queue of an exited thread is reused by the next new thread, and so
+    // are its counters.
+    //
+    std::vector<WorkerStats> worker_stats() const;
+
+    // Queue wait times of tasks of the given priority, summed over all pool
+    // threads. It is all zeros, unless PoolOptions::track_queue_wait is set.
+    //
+    QueueWaitStats queue_wait_stats(TASK_PRIORITY priority) const;
+
+    // It is called on the worker thread with exceptions thrown by posted
+    // routines. By default, they are ignored.
+    //
+    void set_exception_handler(exception_handler_type handler);
+
 private:
 
-    using routine_type = std::function<void()>;
+    friend class    TaskGroup;
+    template<typename T>
+    friend class    TaskFuture;
+
+    using routine_type = InlineTask;
 
     enum class WORK_TYPE : unsigned char {
         _undefined_ = 0,
@@ -183,9 +821,9 @@ private:
     struct  WorkUnit  {
 
         WorkUnit() = default;
-        WorkUnit(const WorkUnit &) = default;
+        WorkUnit(const WorkUnit &) = delete;
         WorkUnit(WorkUnit &&) = default;
-        WorkUnit &operator=(const WorkUnit &) = default;
+        WorkUnit &operator=(const WorkUnit &) = delete;
         WorkUnit &operator=(WorkUnit &&) = default;
 
         explicit WorkUnit(WORK_TYPE work_t) : work_type(work_t)  {   }
@@ -195,23 +833,365 @@ private:
 
         routine_type    func {  };
         WORK_TYPE       work_type { WORK_TYPE::_undefined_ };
+        TASK_PRIORITY   priority { TASK_PRIORITY::_normal_ };
+        std::uint64_t   enqueued_ns { 0 };  // If queue wait is tracked
     };
 
-    bool thread_routine_(size_type local_q_idx) noexcept;  // Engine routine
-    WorkUnit get_one_local_task_() noexcept;
-
     using guard_type = std::lock_guard<std::mutex>;
     using GlobalQueueType = SharedQueue<WorkUnit>;
-    using LocalQueueType = std::queue<WorkUnit>;
 
-    using LocalQueueList = std::list<LocalQueueType>;
+    // Queue wait counters of one priority. Only the owner thread changes
+    // them.
+    //
+    struct  WaitCounters  {
+
+        std::atomic<std::size_t>    count { 0 };
+        std::atomic<std::uint64_t>  total_ns { 0 };
+        std::atomic<std::uint64_t>  max_ns { 0 };
+        std::array<std::atomic<std::size_t>, QueueWaitStats::BUCKETS>
+            histogram { };
+    };
+
+    // High and background lanes are expected to be shorter
+    //
+    inline static constexpr std::size_t SIDE_LANE_CAPACITY = 256;
+    inline static constexpr std::size_t NORMAL_LANE =
+        std::size_t(TASK_PRIORITY::_normal_);
+
+    struct  LocalQueue  {
+
+        // One lane per priority
+        //
+        WorkStealingDeque<WorkUnit> tasks[TASK_PRIORITY_COUNT] {
+            WorkStealingDeque<WorkUnit> { SIDE_LANE_CAPACITY },
+            WorkStealingDeque<WorkUnit> { },
+            WorkStealingDeque<WorkUnit> { SIDE_LANE_CAPACITY },
+        };
+
+        // Where the owner thread runs. They don't change once the queue is
+        // published.
+        //
+        int                         cpu { -1 };  // -1 means not pinned
+        std::size_t                 node { 0 };
+        unsigned int                l3 { 0 };
+
+        // Only the owner thread changes these
+        //
+        std::atomic<std::size_t>    executed { 0 };
+        std::atomic<std::size_t>    steals { 0 };
+        std::atomic<std::size_t>    stolen { 0 };
+
+        // Thieves change this
+        //
+        alignas(CACHE_LINE_SIZE)
+        std::atomic<std::size_t>    stolen_from { 0 };
+
+        alignas(CACHE_LINE_SIZE)
+        WaitCounters                waits[TASK_PRIORITY_COUNT] { };
+    };
+
+    // Global queue of a NUMA node and where threads on the node park
+    //
+    struct  NodeQueue  {
+
+        explicit NodeQueue(std::size_t capacity)
+            : tasks { GlobalQueueType { capacity },
+                      GlobalQueueType { capacity },
+                      GlobalQueueType { capacity } }  {   }
+
+        GlobalQueueType tasks[TASK_PRIORITY_COUNT];  // One lane per priority
+        EventCount      parking { };
+    };
+
+    // Steal victims by distance from the thief
+    //
+    enum class  LOCALITY : unsigned char  {
+        _same_l3_ = 0,  // Or anywhere, if threads are not pinned
+        _same_node_ = 1,
+        _other_node_ = 2,
+    };
+
+    using LocalQueueList = std::list<LocalQueue>;
+    using NodeQueueList = std::vector<std::unique_ptr<NodeQueue>>;
+    using StealList = std::vector<LocalQueue *>;
     using ThreadVector = std::vector<thread_type>;
 
+    bool thread_routine_(LocalQueue *local_q) noexcept;  // Engine routine
+    WorkUnit get_one_local_task_(std::size_t lane) noexcept;
+    bool
+    steal_(WorkUnit &work_unit, LOCALITY locality, std::size_t lane) noexcept;
+    WorkUnit next_task_() noexcept;  // Local, stolen or global task
+    WorkUnit next_task_(std::size_t lane) noexcept;  // Of one priority
+    bool has_pending_tasks_() const noexcept;
+    void execute_(WorkUnit &work_unit) noexcept;
+    void record_wait_(const WorkUnit &work_unit) noexcept;
+    static std::uint64_t now_ns_() noexcept;
+    void enqueue_(WorkUnit &&work_unit);
+    void enqueue_bulk_(std::vector<WorkUnit> &work_units,
+                       bool split_by_node = false);
+
+    // It queues a continuation. If the pool is shut down before or right
+    // after it is queued, the workers may be gone, so it runs here.
+    //
+    void enqueue_continuation_(routine_type &&routine);
+
+    // Global queue for the calling thread: its own node, if known
+    //
+    std::size_t caller_node_() const noexcept;
+
+    // Wake up n parked threads, on the given node first
+    //
+    void wake_(std::size_t node, std::size_t n) noexcept;
+
+    // It lays out the CPUs and creates the global queues
+    //
+    void init_nodes_(const PoolOptions &options);
+
+    // They package routine(args ...) into a WorkUnit
+    //
+    template<typename F, typename ... As>
+    static dispatch_res_t<F, As ...>
+    make_task_(WorkUnit &work_unit, F &&routine, As && ... args);
+    template<typename F, typename ... As>
+    WorkUnit make_post_task_(F &&routine, As && ... args);
+
+    // Same as make_task_(), but the task checks token before running the
+    // routine. If it is cancelled, the future gets TaskCancelled.
+    //
+    template<typename F, typename ... As>
+    dispatch_res_t<F, As ...>
+    make_cancellable_task_(WorkUnit &work_unit,
+                           CancellationToken token,
+                           F &&routine,
+                           As && ... args);
+
+    void handle_exception_(std::exception_ptr ex_ptr) noexcept;
+
+    // A periodic timer runs the same routine every time
+    //
+    struct  PeriodicTask  {
+
+        explicit PeriodicTask(routine_type &&r) : routine(std::move(r))  {   }
+
+        routine_type        routine;
+        std::atomic_flag    running { };  // A run is under way
+    };
+
+    // A queued continuation that the enqueuer may run too. Whoever claims
+    // it first runs it.
+    //
+    struct  Continuation  {
+
+        explicit Continuation(routine_type &&r) : routine(std::move(r))  {   }
+
+        void run()  {
+
+            if (! claimed.test_and_set(std::memory_order_acq_rel))
+                routine();
+        }
+
+        routine_type        routine;
+        std::atomic_flag    claimed { };
+    };
+
+    // What the timer wheel holds. The source cancels the timer's tasks.
+    //
+    struct  TimerTask  {
+
+        routine_type                    once { };  // A one shot timer's task
+        std::shared_ptr<PeriodicTask>   periodic { };
+        CancellationSource              source { };
+    };
+
+    using TimerWheelType = TimerWheel<TimerTask>;
+    using tick_type = TimerWheelType::tick_type;
+
+    // The wheel counts ticks of timer_tick_ since timer_epoch_. Due ticks
+    // are rounded up, so timers never fire early.
+    //
+    tick_type current_tick_() const noexcept;
+    template<typename C, typename D>
+    tick_type due_tick_(const std::chrono::time_point<C, D> &when) const;
+    std::chrono::steady_clock::time_point
+    tick_time_(tick_type tick) const noexcept;
+
+    // It puts timer in the wheel, and wakes up a thread to keep time, if
+    // it is due before the others
+    //
+    TimerId add_timer_(tick_type due, tick_type period, TimerTask &&timer);
+
+    // If timers are due and no other thread is at it, it queues their tasks
+    //
+    void service_timers_() noexcept;
+
+    // A cancelled or dropped timer lets its future know
+    //
+    static void cancel_timer_task_(TimerTask &timer) noexcept;
+
+    // Iterations [first, last) of every chunk of a loop of n iterations
+    //
+    using ChunkList = std::vector<std::pair<size_type, size_type>>;
+
+    ChunkList
+    loop_chunks_(LOOP_SCHEDULE schedule,
+                 size_type chunk_size,
+                 size_type n) const;
+
+    // It runs run_chunk(first, last) for every chunk on at most one task per
+    // thread, and returns the futures of the chunks
+    //
+    template<typename R, typename C>
+    std::vector<std::future<R>>
+    run_chunks_(LOOP_SCHEDULE schedule, ChunkList &&chunks, C &&run_chunk);
+
+    // It runs a node of a graph being run, and then successors that it
+    // makes ready. One of them is run in the same task, the rest are
+    // added to the group.
+    //
+    static void run_graph_node_(TaskGraph &graph,
+                                std::atomic<TaskGraph::size_type> *remaining,
+                                TaskGroup &group,
+                                TaskGraph::node_type node);
+
+    // It runs routine(w) for every w in [0, count). 0 runs on the calling
+    // thread and the rest are tasks of a group, which are run here too if
+    // nobody has taken them. It returns when all are done, and rethrows the
+    // first exception.
+    //
+    template<typename F>
+    void run_workers_(size_type count, const F &routine);
+
+    template<std::random_access_iterator I, typename P, long TH>
+    void sample_sort_(const I begin, const I end, P &compare);
+    template<std::random_access_iterator I, typename P, long TH>
+    void quick_sort_(const I begin, const I end, P compare);
+
+    // One pass of parallel_stable_sort(). Every two neighbouring sorted runs
+    // of width elements in src are merged into dst.
+    //
+    template<typename S, typename D, typename P>
+    void merge_pass_(S src,
+                     D dst,
+                     size_type n,
+                     size_type width,
+                     size_type piece_size,
+                     P &compare);
+
+    // It returns the index of a match of pred in [begin, end), or n. If
+    // lowest, it is the lowest one.
+    //
+    template<bool lowest, long TH, std::random_access_iterator I,
+             typename P>
+    size_type find_if_(I begin, I end, P &pred);
+
+    // It partitions [begin, end) by pred in parallel, and returns the cut
+    //
+    template<long TH, std::random_access_iterator I, typename U>
+    I partition_(I begin, I end, const U &pred);
+
+    // It folds fold(first, last) of every chunk of [0, n) and init by
+    // reduce_op, as parallel_transform_reduce() describes. Chunk c is
+    // [c * chunk_size + head, (c + 1) * chunk_size + head), clipped to
+    // [0, n). So, chunk 0 also takes the head elements before it.
+    //
+    template<typename T, typename BOP, typename F>
+    T reduce_chunks_(size_type n,
+                     size_type chunk_size,
+                     size_type head,
+                     T init,
+                     BOP &reduce_op,
+                     const F &fold);
+
+    // Both scans. It is an exclusive scan if there is an init.
+    //
+    template<long TH, typename I, typename O, typename T,
+             typename BOP, typename UOP>
+    O scan_(I begin, I end, O out,
+            std::optional<T> &&init,
+            BOP &op,
+            UOP &transform);
+
+    // The passes of parallel_radix_sort() over items of [data, data + n),
+    // split into blocks of block_size items. bits(item) returns the unsigned
+    // key. The result ends up in data.
+    //
+    template<typename T, typename B>
+    void radix_passes_(T *data,
+                       T *buffer,
+                       size_type n,
+                       size_type block_size,
+                       const B &bits);
+
+    // Arguments are passed to dispatched routines the way std::bind does
+    //
+    template<typename T>
+    static T &unwrap_ref_(T &arg) noexcept  { return (arg); }
+    template<typename T>
+    static T &unwrap_ref_(std::reference_wrapper<T> arg) noexcept  {
+
+        return (arg.get());
+    }
+
+    // Cheap per-thread pseudo random numbers (xorshift64*)
+    //
+    static std::uint64_t next_random_() noexcept;
+
+    // Only the owner thread changes the counter, so there is no need for an
+    // atomic read-modify-write
+    //
+    static void
+    add_to_(std::atomic<std::size_t> &counter, std::size_t n) noexcept;
+
+    // These must be called while holding state_
+    //
+    LocalQueue *acquire_local_queue_();
+    void release_local_queue_(LocalQueue *local_q) noexcept;
+
     ThreadVector    threads_ { };
     LocalQueueList  local_queues_ { };
-    GlobalQueueType global_queue_ { };
+    NodeQueueList   node_queues_ { };  // One per NUMA node
+
+    // CPUs that new threads are pinned to in turn, and the node index of
+    // every CPU in the system (-1 if there are no threads on its node)
+    //
+    Topology::CpuVector cpu_plan_ { };
+    std::vector<int>    cpu_to_node_ { };
+
+    // Local queues of exited threads are handed to new threads, so tasks
+    // left in them are not lost and the list doesn't grow unbounded
+    //
+    StealList       free_local_queues_ { };
+
+    // Thieves scan the current steal list without holding any lock. When a
+    // local queue is added, a new list is published and the old one is kept
+    // alive, since a thief may still be scanning it.
+    //
+    std::list<StealList>            steal_lists_ { };
+    std::atomic<const StealList *>  steal_list_ { nullptr };
+
+    inline static thread_local LocalQueue       *local_queue_ { nullptr };
+    inline static thread_local ThreadPool       *local_pool_ { nullptr };
+    inline static thread_local std::uint64_t    random_state_ { 0 };
+    inline static thread_local std::size_t      schedule_tick_ { 0 };
+
+    bool                    steal_half_ { false };
+    std::size_t             spin_count_ { 0 };
+    bool                    track_queue_wait_ { false };
+
+    // Running sums of the priority weights. Pick number n starts with the
+    // first lane whose bound is more than n % the last bound.
+    //
+    std::array<std::size_t, TASK_PRIORITY_COUNT>    lane_bounds_ { };
+
+    // Tasks queued in each lane. It is only kept for the high and background
+    // lanes, so threads can skip them cheaply when they are empty.
+    //
+    struct  alignas(CACHE_LINE_SIZE) LaneCount  {
+
+        std::atomic<size_type>  value { 0 };
+    };
 
-    inline static thread_local LocalQueueType *local_queue_ { nullptr };
+    LaneCount   lane_pending_[TASK_PRIORITY_COUNT] { };
 
     std::atomic<size_type>  available_threads_ { 0 };
     std::atomic<size_type>  capacity_threads_ { 0 };
@@ -220,6 +1200,191 @@ private:
 
     Conditioner pre_conditioner_ { };
     Conditioner post_conditioner_ { };
+
+    exception_handler_type  exception_handler_ { };  // Guarded by state_
+
+    // Threads look at the count and the next due tick without the lock.
+    // The keeper is the parked thread that sleeps until the next timer is
+    // due (its node + 1, 0 if there is none).
+    //
+    alignas(CACHE_LINE_SIZE)
+    std::atomic<std::size_t>                timer_count_ { 0 };
+    std::atomic<tick_type>                  timer_next_due_ {
+        TimerWheelType::NEVER
+    };
+    std::atomic<std::size_t>                timer_keeper_ { 0 };
+    std::mutex                              timer_mutex_ { };
+    TimerWheelType                          timer_wheel_ { };  // By the mutex
+    std::chrono::steady_clock::time_point   timer_epoch_ { };
+    std::chrono::nanoseconds                timer_tick_ { };
+};
+
+// ----------------------------------------------------------------------------
+
+// A group of tasks that are waited for together, for structured fork-join:
+//
+//     TaskGroup   group { pool.make_group() };
+//
+//     group.run(left_half);
+//     group.run(right_half);
+//     group.wait();
+//
+// wait() doesn't block a thread while there is work to do. It runs the
+// group's tasks that haven't started yet. On a pool thread, it then runs
+// other pending tasks of the pool. So it is safe to wait inside a task.
+// A group is just one atomic counter of unfinished tasks, not a future per
+// task.
+//
+class   TaskGroup  {
+
+public:
+
+    using size_type = std::size_t;
+
+    TaskGroup(TaskGroup &&) = default;
+    TaskGroup &operator = (TaskGroup &&) = delete;
+    TaskGroup(const TaskGroup &) = delete;
+    TaskGroup &operator = (const TaskGroup &) = delete;
+
+    // It waits for the unfinished tasks. Their exceptions are dropped.
+    //
+    ~TaskGroup();
+
+    template<typename F, typename ... As>
+    requires std::invocable<F, As ...>
+    void run(F &&routine, As && ... args);
+
+    // It returns when all the tasks run so far are finished. If any of them
+    // threw, the first exception is rethrown.
+    //
+    void wait();
+
+    size_type pending() const noexcept;  // Unfinished tasks
+
+    // The group's token, for its running tasks to poll
+    //
+    const CancellationToken &token() const noexcept;
+
+private:
+
+    friend class    ThreadPool;
+
+    using routine_type = InlineTask;
+
+    // Queued proxies of the tasks keep the state alive. So, a group may be
+    // gone before all of its proxies are dequeued.
+    //
+    struct  State  {
+
+        State(ThreadPool &p, CancellationToken &&t)
+            : pool(p), token(std::move(t))  {   }
+
+        ThreadPool                  &pool;
+        const CancellationToken     token;
+        std::atomic<size_type>      pending { 0 };
+        SharedQueue<routine_type>   tasks { };     // Not started yet
+        EventCount                  finished { };  // Waiters park here
+        std::mutex                  mutex { };
+        std::exception_ptr          exception { };  // Guarded by mutex
+    };
+
+    explicit TaskGroup(ThreadPool &pool, CancellationToken token = { });
+
+    // It records TaskCancelled as the group's exception, if there is none
+    //
+    static void cancelled_(State &state);
+
+    // It runs one of the group's tasks that haven't started yet. It returns
+    // false, if there was none.
+    //
+    static bool run_one_(State &state) noexcept;
+
+    std::shared_ptr<State>  state_;
+};
+
+// ----------------------------------------------------------------------------
+
+// The future of a routine queued by ThreadPool::async(). It is like
+// std::future, but then() attaches a continuation that is queued on the pool
+// when the routine finishes, instead of blocking a thread on get():
+//
+//     auto    fut = pool.async(load_data)
+//                       .then([](Data data) { return (parse(data)); })
+//                       .then([](Table table) { return (table.size()); });
+//
+//     fut.get();
+//
+// A continuation is called with the result of its predecessor, or with
+// nothing if it is void. If the predecessor threw, the continuation is not
+// called and the exception is passed on to its future.
+// get() and wait() on a pool thread run other tasks, while they wait.
+// Once the pool is shut down, a continuation runs on the thread that
+// finishes its predecessor, or in then(), if that has already finished.
+//
+template<typename T>
+class   TaskFuture  {
+
+public:
+
+    using value_type = T;
+
+    TaskFuture() = default;
+    TaskFuture(TaskFuture &&) = default;
+    TaskFuture &operator = (TaskFuture &&) = default;
+    TaskFuture(const TaskFuture &) = delete;
+    TaskFuture &operator = (const TaskFuture &) = delete;
+
+    // It attaches a continuation and returns its future. This future is
+    // no longer valid afterwards.
+    //
+    template<typename F>
+    requires (std::is_void_v<T> && std::invocable<std::decay_t<F> &>) ||
+             (! std::is_void_v<T> && std::invocable<std::decay_t<F> &, T>)
+    auto then(F &&routine);
+
+    T get();
+    void wait() const;
+    bool is_ready() const noexcept;
+    bool valid() const noexcept  { return (state_ != nullptr); }
+
+private:
+
+    friend class    ThreadPool;
+    template<typename U>
+    friend class    TaskFuture;
+
+    using routine_type = InlineTask;
+
+    struct  State  {
+
+        explicit State(ThreadPool &p) : pool(p)  {   }
+
+        // It must be called once, after the promise is set
+        //
+        void finish() noexcept;
+
+        ThreadPool                  &pool;
+        std::promise<T>             promise {
+            std::allocator_arg, RecyclingAllocator<T> { }
+        };
+        std::future<T>              future { promise.get_future() };
+        // Guarded by mutex. Once ready is set, a continuation is queued
+        // right away and parked waiters are woken up.
+        //
+        std::mutex                  mutex { };
+        bool                        ready { false };
+        routine_type                continuation { };
+        std::size_t                 parked { 0 };  // Waiters in wait()
+    };
+
+    explicit TaskFuture(std::shared_ptr<State> state);
+
+    // It sets the promise to routine(args ...)
+    //
+    template<typename F, typename ... As>
+    static void fulfill_(std::promise<T> &promise, F &routine, As && ... args);
+
+    std::shared_ptr<State>  state_ { };
 };
 
 } // namespace hmthrp
@@ -30,8 +30,14 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <Leopard/ThreadPool.h>
 
 #include <algorithm>
+#include <bit>
+#include <chrono>
 #include <cstdlib>
+#include <limits>
 #include <memory>
+#include <numeric>
+#include <optional>
+#include <random>
 #include <stdexcept>
 #include <type_traits>
 
@@ -51,15 +57,69 @@ void Conditioner::execute()  { func_(); }
 
 // ----------------------------------------------------------------------------
 
+inline double QueueWaitStats::mean_ns() const noexcept  {
+
+    return (count > 0 ? double(total_ns) / double(count) : 0.0);
+}
+
+// ----------------------------------------------------------------------------
+
+inline std::uint64_t QueueWaitStats::percentile_ns(double p) const noexcept  {
+
+    const double    target { p * double(count) };
+    std::size_t     seen { 0 };
+
+    for (std::size_t i = 0; i < BUCKETS; ++i)  {
+        seen += histogram[i];
+        if (seen > 0 && double(seen) >= target)
+            return (i == 0 ? 0 : std::min(max_ns, std::uint64_t(1) << i));
+    }
+    return (max_ns);
+}
+
+// ----------------------------------------------------------------------------
+
+ThreadPool::ThreadPool(size_type thr_num,
+                       Conditioner pre_conditioner,
+                       Conditioner post_conditioner)
+    : ThreadPool(thr_num, PoolOptions { },
+                 pre_conditioner, post_conditioner)  {   }
+
+// ----------------------------------------------------------------------------
+
 ThreadPool::ThreadPool(size_type thr_num,
+                       const PoolOptions &options,
                        Conditioner pre_conditioner,
                        Conditioner post_conditioner)
-    : pre_conditioner_(pre_conditioner), post_conditioner_(post_conditioner)  {
+    : steal_half_(options.steal_half),
+      spin_count_(options.spin_count),
+      track_queue_wait_(options.track_queue_wait),
+      pre_conditioner_(pre_conditioner),
+      post_conditioner_(post_conditioner),
+      timer_epoch_(std::chrono::steady_clock::now()),
+      timer_tick_(options.timer_tick)  {
+
+    if (timer_tick_.count() <= 0)
+        throw std::runtime_error("ThreadPool::ThreadPool(): "
+                                 "Timer tick must be positive.");
+
+    std::size_t bound { 0 };
+
+    for (std::size_t i = 0; i < TASK_PRIORITY_COUNT; ++i)  {
+        if (options.priority_weights[i] == 0)
+            throw std::runtime_error("ThreadPool::ThreadPool(): "
+                                     "Priority weights must be positive.");
+        bound += options.priority_weights[i];
+        lane_bounds_[i] = bound;
+    }
+    init_nodes_(options);
+    {
+        const guard_type    guard { state_ };
 
-    threads_.reserve(thr_num * 2);
-    for (size_type i = 0; i < thr_num; ++i)  {
-        local_queues_.push_back(LocalQueueType { });
-        threads_.emplace_back(&ThreadPool::thread_routine_, this, i);
+        threads_.reserve(thr_num * 2);
+        for (size_type i = 0; i < thr_num; ++i)
+            threads_.emplace_back(&ThreadPool::thread_routine_, this,
+                                  acquire_local_queue_());
     }
 
     // Make sure all threads are running before we exit the constructor
@@ -100,21 +160,19 @@ ThreadPool::add_thread(size_type thr_num)  {
             throw std::runtime_error(err);
         }
 
-        for (size_type i = 0; i < shutys; ++i)  {
-            const WorkUnit  work_unit { WORK_TYPE::_terminate_ };
+        const std::size_t   node_count { node_queues_.size() };
 
-            global_queue_.push(work_unit);
-        }
+        for (size_type i = 0; i < shutys; ++i)
+            node_queues_[i % node_count]->tasks[NORMAL_LANE].push(
+                WorkUnit { WORK_TYPE::_terminate_ });
+        wake_(0, shutys);
     }
     else if (thr_num > 0)  {
         const guard_type    guard { state_ };
-        const size_type     local_size { size_type(threads_.size()) };
 
-        for (size_type i = 0; i < thr_num; ++i)  {
-            local_queues_.push_back(LocalQueueType { });
+        for (size_type i = 0; i < thr_num; ++i)
             threads_.emplace_back(&ThreadPool::thread_routine_,
-                                  this, local_size + i);
-        }
+                                  this, acquire_local_queue_());
     }
 
     std::this_thread::yield();  // Give +/- threads a chance
@@ -127,44 +185,331 @@ template<typename F, typename ... As>
 ThreadPool::dispatch_res_t<F, As ...>
 ThreadPool::dispatch(bool immediately, F &&routine, As && ... args)  {
 
+    return (dispatch(TASK_PRIORITY::_normal_,
+                     immediately,
+                     std::forward<F>(routine),
+                     std::forward<As>(args) ...));
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename F, typename ... As>
+ThreadPool::dispatch_res_t<F, As ...>
+ThreadPool::dispatch(TASK_PRIORITY priority,
+                     bool immediately,
+                     F &&routine,
+                     As && ... args)  {
+
     if (is_shutdown() || (capacity_threads() == 0 && ! immediately))
         throw std::runtime_error("ThreadPool::dispatch(): "
                                  "Thread-pool has 0 thread capacity.");
 
-    using task_return_t =
-        std::invoke_result_t<std::decay_t<F>, std::decay_t<As> ...>;
-    using future_t = dispatch_res_t<F, As ...>;
-
-    auto            callable  {
-        std::make_shared<std::packaged_task<task_return_t()>>
-            (std::bind<task_return_t>(std::forward<F>(routine),
-                                      std::forward<As>(args) ...))
-    };
-    future_t        return_fut { callable->get_future() };
-    const WorkUnit  work_unit {
-        WORK_TYPE::_client_service_, [callable]() -> void { (*callable)(); }
+    WorkUnit    work_unit { };
+    auto        return_fut {
+        make_task_(work_unit,
+                   std::forward<F>(routine),
+                   std::forward<As>(args) ...)
     };
 
+    work_unit.priority = priority;
     if (immediately && available_threads() == 0)
         add_thread(1);
+    enqueue_(std::move(work_unit));
 
-    if (local_queue_)  {  // Is this one of the pool threads
-        const guard_type    guard { state_ };
+    return (return_fut);
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename F, typename ... As>
+ThreadPool::dispatch_res_t<F, As ...>
+ThreadPool::dispatch(const CancellationToken &token,
+                     bool immediately,
+                     F &&routine,
+                     As && ... args)  {
+
+    if (is_shutdown() || (capacity_threads() == 0 && ! immediately))
+        throw std::runtime_error("ThreadPool::dispatch(): "
+                                 "Thread-pool has 0 thread capacity.");
+
+    WorkUnit    work_unit { };
+    auto        return_fut {
+        make_cancellable_task_(work_unit,
+                               token,
+                               std::forward<F>(routine),
+                               std::forward<As>(args) ...)
+    };
 
-        local_queue_->push(work_unit);
+    // Already cancelled. The task only sets the future, so it is not worth
+    // a trip through the queues.
+    //
+    if (token.is_cancelled())  {
+        work_unit.func();
+        return (return_fut);
     }
-    else
-        global_queue_.push(work_unit);
+
+    if (immediately && available_threads() == 0)
+        add_thread(1);
+    enqueue_(std::move(work_unit));
+
+    return (return_fut);
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename F, typename ... As>
+requires std::invocable<F, As ...>
+void ThreadPool::post(F &&routine, As && ... args)  {
+
+    if (is_shutdown() || capacity_threads() == 0)
+        throw std::runtime_error("ThreadPool::post(): "
+                                 "Thread-pool has 0 thread capacity.");
+
+    enqueue_(make_post_task_(std::forward<F>(routine),
+                             std::forward<As>(args) ...));
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename F, typename ... As>
+requires std::invocable<F, As ...>
+void ThreadPool::post(TASK_PRIORITY priority, F &&routine, As && ... args)  {
+
+    if (is_shutdown() || capacity_threads() == 0)
+        throw std::runtime_error("ThreadPool::post(): "
+                                 "Thread-pool has 0 thread capacity.");
+
+    WorkUnit    work_unit {
+        make_post_task_(std::forward<F>(routine), std::forward<As>(args) ...)
+    };
+
+    work_unit.priority = priority;
+    enqueue_(std::move(work_unit));
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename R, typename P, typename F, typename ... As>
+ThreadPool::timer_res_t<F, As ...>
+ThreadPool::dispatch_after(std::chrono::duration<R, P> delay,
+                           F &&routine,
+                           As && ... args)  {
+
+    if (is_shutdown() || capacity_threads() == 0)
+        throw std::runtime_error("ThreadPool::dispatch_after(): "
+                                 "Thread-pool has 0 thread capacity.");
+
+    return (dispatch_at(std::chrono::steady_clock::now() + delay,
+                        std::forward<F>(routine),
+                        std::forward<As>(args) ...));
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename C, typename D, typename F, typename ... As>
+ThreadPool::timer_res_t<F, As ...>
+ThreadPool::dispatch_at(std::chrono::time_point<C, D> when,
+                        F &&routine,
+                        As && ... args)  {
+
+    if (is_shutdown() || capacity_threads() == 0)
+        throw std::runtime_error("ThreadPool::dispatch_at(): "
+                                 "Thread-pool has 0 thread capacity.");
+
+    TimerTask   timer { };
+    WorkUnit    work_unit { };
+    auto        return_fut {
+        make_cancellable_task_(work_unit,
+                               timer.source.token(),
+                               std::forward<F>(routine),
+                               std::forward<As>(args) ...)
+    };
+
+    timer.once = std::move(work_unit.func);
+
+    const TimerId   id { add_timer_(due_tick_(when), 0, std::move(timer)) };
+
+    return (timer_res_t<F, As ...> { id, std::move(return_fut) });
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename R, typename P, typename F, typename ... As>
+requires std::invocable<F, As ...>
+TimerId
+ThreadPool::dispatch_every(std::chrono::duration<R, P> period,
+                           F &&routine,
+                           As && ... args)  {
+
+    if (is_shutdown() || capacity_threads() == 0)
+        throw std::runtime_error("ThreadPool::dispatch_every(): "
+                                 "Thread-pool has 0 thread capacity.");
+    if (period <= std::chrono::duration<R, P>::zero())
+        throw std::runtime_error("ThreadPool::dispatch_every(): "
+                                 "Period must be positive.");
+
+    const auto      first { std::chrono::steady_clock::now() + period };
+    const tick_type due { due_tick_(first) };
+    const auto      span {
+        std::chrono::ceil<std::chrono::nanoseconds>(period)
+    };
+    const tick_type ticks {
+        std::max(tick_type(1),
+                 tick_type((span + timer_tick_ - std::chrono::nanoseconds(1)) /
+                           timer_tick_))
+    };
+    TimerTask       timer { };
+
+    timer.periodic = std::allocate_shared<PeriodicTask>(
+        RecyclingAllocator<PeriodicTask> { },
+        routine_type {
+            [routine = std::forward<F>(routine),
+             ... args = std::forward<As>(args)]() mutable -> void  {
+                std::invoke(routine, unwrap_ref_(args) ...);
+            }
+        });
+    return (add_timer_(due, ticks, std::move(timer)));
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename F, typename ... As>
+ThreadPool::dispatch_res_t<F, As ...>
+ThreadPool::dispatch_on_node(size_type node, F &&routine, As && ... args)  {
+
+    if (is_shutdown() || capacity_threads() == 0)
+        throw std::runtime_error("ThreadPool::dispatch_on_node(): "
+                                 "Thread-pool has 0 thread capacity.");
+    if (node < 0 || node >= node_count())
+        throw std::runtime_error("ThreadPool::dispatch_on_node(): "
+                                 "Node is out of range.");
+
+    WorkUnit    work_unit { };
+    auto        return_fut {
+        make_task_(work_unit,
+                   std::forward<F>(routine),
+                   std::forward<As>(args) ...)
+    };
+
+    if (track_queue_wait_)  work_unit.enqueued_ns = now_ns_();
+    node_queues_[node]->tasks[NORMAL_LANE].push(std::move(work_unit));
+    wake_(node, 1);
 
     return (return_fut);
 }
 
 // ----------------------------------------------------------------------------
 
+template<typename G>
+requires std::invocable<G &, ThreadPool::size_type> &&
+         std::invocable<std::invoke_result_t<G &, ThreadPool::size_type>>
+ThreadPool::bulk_res_t<G>
+ThreadPool::dispatch_bulk(size_type n, G &&generator)  {
+
+    if (is_shutdown() || capacity_threads() == 0)
+        throw std::runtime_error("ThreadPool::dispatch_bulk(): "
+                                 "Thread-pool has 0 thread capacity.");
+    if (n < 0)
+        throw std::runtime_error("ThreadPool::dispatch_bulk(): "
+                                 "Number of tasks cannot be negative.");
+
+    bulk_res_t<G>           ret;
+    std::vector<WorkUnit>   work_units;
+
+    ret.reserve(n);
+    work_units.reserve(n);
+    for (size_type i = 0; i < n; ++i)
+        ret.emplace_back(make_task_(work_units.emplace_back(), generator(i)));
+    enqueue_bulk_(work_units);
+
+    return (ret);
+}
+
+// ----------------------------------------------------------------------------
+
+template<std::ranges::input_range R>
+requires std::invocable<std::ranges::range_value_t<R> &>
+ThreadPool::range_bulk_res_t<R>
+ThreadPool::dispatch_bulk(R &&callables)  {
+
+    if (is_shutdown() || capacity_threads() == 0)
+        throw std::runtime_error("ThreadPool::dispatch_bulk(): "
+                                 "Thread-pool has 0 thread capacity.");
+
+    range_bulk_res_t<R>     ret;
+    std::vector<WorkUnit>   work_units;
+
+    if constexpr (std::ranges::sized_range<R>)  {
+        ret.reserve(std::ranges::size(callables));
+        work_units.reserve(std::ranges::size(callables));
+    }
+    for (auto &&callable : callables)  {
+        if constexpr (std::is_lvalue_reference_v<R>)
+            ret.emplace_back(make_task_(work_units.emplace_back(), callable));
+        else  // We own the range, so the callables can be moved
+            ret.emplace_back(make_task_(work_units.emplace_back(),
+                                        std::move(callable)));
+    }
+    enqueue_bulk_(work_units);
+
+    return (ret);
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename G>
+requires std::invocable<G &, ThreadPool::size_type> &&
+         std::invocable<std::invoke_result_t<G &, ThreadPool::size_type>>
+void ThreadPool::post_bulk(size_type n, G &&generator)  {
+
+    if (is_shutdown() || capacity_threads() == 0)
+        throw std::runtime_error("ThreadPool::post_bulk(): "
+                                 "Thread-pool has 0 thread capacity.");
+    if (n < 0)
+        throw std::runtime_error("ThreadPool::post_bulk(): "
+                                 "Number of tasks cannot be negative.");
+
+    std::vector<WorkUnit>   work_units;
+
+    work_units.reserve(n);
+    for (size_type i = 0; i < n; ++i)
+        work_units.push_back(make_post_task_(generator(i)));
+    enqueue_bulk_(work_units);
+}
+
+// ----------------------------------------------------------------------------
+
+template<std::ranges::input_range R>
+requires std::invocable<std::ranges::range_value_t<R> &>
+void ThreadPool::post_bulk(R &&callables)  {
+
+    if (is_shutdown() || capacity_threads() == 0)
+        throw std::runtime_error("ThreadPool::post_bulk(): "
+                                 "Thread-pool has 0 thread capacity.");
+
+    std::vector<WorkUnit>   work_units;
+
+    if constexpr (std::ranges::sized_range<R>)
+        work_units.reserve(std::ranges::size(callables));
+    for (auto &&callable : callables)  {
+        if constexpr (std::is_lvalue_reference_v<R>)
+            work_units.push_back(make_post_task_(callable));
+        else  // We own the range, so the callables can be moved
+            work_units.push_back(make_post_task_(std::move(callable)));
+    }
+    enqueue_bulk_(work_units);
+}
+
+// ----------------------------------------------------------------------------
+
 template<typename F, typename I, typename ... As>
 ThreadPool::loop_res_t<F, I, As ...>
 ThreadPool::parallel_loop(I begin, I end, F &&routine, As && ... args)  {
 
+    if (is_shutdown() || capacity_threads() == 0)
+        throw std::runtime_error("ThreadPool::parallel_loop(): "
+                                 "Thread-pool has 0 thread capacity.");
+
     using task_return_t =
         std::invoke_result_t<std::decay_t<F>,
                              std::decay_t<I>,
@@ -189,30 +534,33 @@ ThreadPool::parallel_loop(I begin, I end, F &&routine, As && ... args)  {
     const size_type         cap_thrs { capacity_threads() };
     const size_type         block_size { (n > cap_thrs) ? n / cap_thrs : n };
     std::vector<future_t>   ret;
+    std::vector<WorkUnit>   work_units;
 
     if (block_size == n)  {
         ret.reserve(n);
+        work_units.reserve(n);
         if (backward)  {
             for (size_type i = n - 1; i >= 0; --i)  {
-                ret.emplace_back(dispatch(false,
-                                          std::forward<F>(routine),
-                                              end + i,
-                                              end + i,
-                                              std::forward<As>(args) ...));
+                ret.emplace_back(make_task_(work_units.emplace_back(),
+                                            routine,
+                                            end + i,
+                                            end + i,
+                                            args ...));
             }
         }
         else  {
             for (size_type i = 0; i < n; ++i)  {
-                ret.emplace_back(dispatch(false,
-                                          std::forward<F>(routine),
-                                              begin + i,
-                                              begin + (i + 1),
-                                              std::forward<As>(args) ...));
+                ret.emplace_back(make_task_(work_units.emplace_back(),
+                                            routine,
+                                            begin + i,
+                                            begin + (i + 1),
+                                            args ...));
             }
         }
     }
     else  {
         ret.reserve(cap_thrs + 1);
+        work_units.reserve(cap_thrs + 1);
         if (backward)  {
             for (size_type i = n; i >= 0; i -= block_size)  {
                 size_type   block_end {
@@ -222,11 +570,11 @@ ThreadPool::parallel_loop(I begin, I end, F &&routine, As && ... args)  {
                 if (size_type((end + i) - (end + block_end + 1)) <
                         (block_size - 1))
                     block_end = -1;
-                ret.emplace_back(dispatch(false,
-                                          std::forward<F>(routine),
-                                              end + block_end + 1,
-                                              end + i,
-                                              std::forward<As>(args) ...));
+                ret.emplace_back(make_task_(work_units.emplace_back(),
+                                            routine,
+                                            end + block_end + 1,
+                                            end + i,
+                                            args ...));
             }
         }
         else  {
@@ -235,15 +583,19 @@ ThreadPool::parallel_loop(I begin, I end, F &&routine, As && ... args)  {
                     ((i + block_size) > n) ? n : i + block_size
                 };
 
-                ret.emplace_back(dispatch(false,
-                                          std::forward<F>(routine),
-                                              begin + i,
-                                              begin + block_end,
-                                              std::forward<As>(args) ...));
+                ret.emplace_back(make_task_(work_units.emplace_back(),
+                                            routine,
+                                            begin + i,
+                                            begin + block_end,
+                                            args ...));
             }
         }
     }
 
+    // All the blocks are queued at once and wake up the workers together
+    //
+    enqueue_bulk_(work_units, true);
+
     return (ret);
 }
 
@@ -254,6 +606,10 @@ ThreadPool::loop2_res_t<F, I1, I2, As ...>
 ThreadPool::parallel_loop2(I1 begin1, I1 end1, I2 begin2, I2 end2,
                            F &&routine, As && ... args)  {
 
+    if (is_shutdown() || capacity_threads() == 0)
+        throw std::runtime_error("ThreadPool::parallel_loop2(): "
+                                 "Thread-pool has 0 thread capacity.");
+
     using task_return_t =
         std::invoke_result_t<std::decay_t<F>,
                              std::decay_t<I1>,
@@ -272,205 +628,3055 @@ ThreadPool::parallel_loop2(I1 begin1, I1 end1, I2 begin2, I2 end2,
     const size_type         cap_thrs { capacity_threads() };
     const size_type         block_size { (n > cap_thrs) ? n / cap_thrs : n };
     std::vector<future_t>   ret;
+    std::vector<WorkUnit>   work_units;
 
     if (block_size == n)  {
         ret.reserve(n);
+        work_units.reserve(n);
         for (size_type i = 0; i < n; ++i)
-            ret.emplace_back(dispatch(false,
-                                      std::forward<F>(routine),
-                                          begin1 + i,
-                                          begin1 + (i + 1),
-                                          begin2 + i,
-                                          std::forward<As>(args) ...));
+            ret.emplace_back(make_task_(work_units.emplace_back(),
+                                        routine,
+                                        begin1 + i,
+                                        begin1 + (i + 1),
+                                        begin2 + i,
+                                        args ...));
     }
     else  {
         ret.reserve(cap_thrs + 1);
+        work_units.reserve(cap_thrs + 1);
         for (size_type i = 0; i < n; i += block_size)  {
             const size_type block_end {
                 ((i + block_size) > n) ? n : i + block_size
             };
 
-            ret.emplace_back(dispatch(false,
-                                      std::forward<F>(routine),
-                                          begin1 + i,
-                                          begin1 + block_end,
-                                          begin2 + i,
-                                          std::forward<As>(args) ...));
+            ret.emplace_back(make_task_(work_units.emplace_back(),
+                                        routine,
+                                        begin1 + i,
+                                        begin1 + block_end,
+                                        begin2 + i,
+                                        args ...));
         }
     }
 
-    return (ret);
-}
-
-// ----------------------------------------------------------------------------
-
-template<std::random_access_iterator I, long TH>
-void
-ThreadPool::parallel_sort(const I begin, const I end)  {
-
-    using value_type = typename std::iterator_traits<I>::value_type;
-
-    auto    compare = std::less<value_type>{ };
+    // All the blocks are queued at once and wake up the workers together
+    //
+    enqueue_bulk_(work_units, true);
 
-    parallel_sort<I, decltype(compare), TH>(begin, end, std::move(compare));
+    return (ret);
 }
 
 // ----------------------------------------------------------------------------
 
-template<std::random_access_iterator I, typename P>
-static inline I
-_median_of_three_(I a, I b, I c, P &compare) {
-
-    if (compare(*b, *a))  std::swap(a, b);
-    if (compare(*c, *b))  std::swap(b, c);
-    if (compare(*b, *a))  std::swap(a, b);
-    return (b); // *a <= *b <= *c under compare
-}
+template<typename F, typename I, typename ... As>
+ThreadPool::loop_res_t<F, I, As ...>
+ThreadPool::parallel_loop(LOOP_SCHEDULE schedule,
+                          size_type chunk_size,
+                          I begin,
+                          I end,
+                          F &&routine,
+                          As && ... args)  {
 
-// --------------------------------------
+    if (schedule == LOOP_SCHEDULE::_static_ && chunk_size == 0)
+        return (parallel_loop(begin, end,
+                              std::forward<F>(routine),
+                              std::forward<As>(args) ...));
 
-template<std::random_access_iterator I, typename P, long TH>
-void
-ThreadPool::parallel_sort(const I begin, const I end, P compare)  {
+    if (is_shutdown() || capacity_threads() == 0)
+        throw std::runtime_error("ThreadPool::parallel_loop(): "
+                                 "Thread-pool has 0 thread capacity.");
+    if (chunk_size < 0)
+        throw std::runtime_error("ThreadPool::parallel_loop(): "
+                                 "Chunk size cannot be negative.");
 
-    if (begin >= end) return;
+    using task_return_t =
+        std::invoke_result_t<std::decay_t<F>,
+                             std::decay_t<I>,
+                             std::decay_t<I>,
+                             std::decay_t<As> ...>;
 
-    const size_type data_size = std::distance(begin, end);
+    size_type   n { 0 };
+    bool        backward { false };
 
-    if (data_size <= TH)  {
-        std::sort(begin, end, compare);
-        return;
+    if constexpr (std::is_integral_v<I>)  {
+        if (begin > end)  {
+            n = begin - end;
+            backward = true;
+        }
+        else
+            n = end - begin;
     }
+    else
+        n = std::distance(begin, end);
 
-    // Pivot selection (median‑of‑three)
-    //
-    auto        mid = begin + (data_size / 2);
-    auto        pivot_it = _median_of_three_(begin, mid, end - 1, compare);
-    const auto  pivot = *pivot_it;
-
-    std::iter_swap(pivot_it, end - 1);  // Move pivot to end ‑ 1
+    ChunkList   chunks { loop_chunks_(schedule, chunk_size, n) };
 
-    auto    cut =
-        std::ranges::partition(begin, end - 1,
-                               [&pivot, &compare](const auto &x) -> bool {
-                                   return (compare(x, pivot));
-                               });
+    if constexpr (std::is_integral_v<I>)  {
+        if (backward)  {
 
-    std::iter_swap(cut.begin(), end - 1);  // Restore pivot
+            // Chunks count down from begin. As in the static blocks, the
+            // routine gets the lowest and highest index of a chunk, and the
+            // last chunk goes all the way down to end.
+            //
+            return (run_chunks_<task_return_t>(
+                schedule,
+                std::move(chunks),
+                [begin, end, n,
+                 routine = std::forward<F>(routine),
+                 ... args = std::forward<As>(args)]
+                (size_type first, size_type last) mutable -> task_return_t  {
+                    const I high = I(begin - I(first));
+                    const I low = (last == n) ? end : I(begin - I(last - 1));
 
-    auto    lf = dispatch(false,
-                          &ThreadPool::parallel_sort<I, P, TH>,
-                          this,
-                          begin,
-                          cut.begin(),
-                          compare);
-    auto    rf = dispatch(false,
-                          &ThreadPool::parallel_sort<I, P, TH>,
-                          this,
-                          cut.begin() + 1,
-                          end,
-                          compare);
+                    return (std::invoke(routine,
+                                        low,
+                                        high,
+                                        unwrap_ref_(args) ...));
+                }));
+        }
+    }
 
-    while (lf.wait_for(std::chrono::seconds(0)) == std::future_status::timeout)
-        run_task();
-    while (rf.wait_for(std::chrono::seconds(0)) == std::future_status::timeout)
-        run_task();
+    return (run_chunks_<task_return_t>(
+        schedule,
+        std::move(chunks),
+        [begin,
+         routine = std::forward<F>(routine),
+         ... args = std::forward<As>(args)]
+        (size_type first, size_type last) mutable -> task_return_t  {
+            return (std::invoke(routine,
+                                begin + first,
+                                begin + last,
+                                unwrap_ref_(args) ...));
+        }));
 }
 
 // ----------------------------------------------------------------------------
 
-void
-ThreadPool::attach(thread_type &&this_thr)  {
-
-    if (is_shutdown())
-        throw std::runtime_error("ThreadPool::attach(): "
-                                 "Thread pool is shutdown.");
-
-    size_type   local_size { 0 };
-
-    {
-        const guard_type    guard { state_ };
+template<typename F, typename I, typename ... As>
+ThreadPool::loop_res_t<F, I, As ...>
+ThreadPool::parallel_loop(const CancellationToken &token,
+                          I begin,
+                          I end,
+                          F &&routine,
+                          As && ... args)  {
 
-        local_size = size_type(threads_.size());
-        local_queues_.push_back(LocalQueueType { });
-        threads_.push_back(std::move(this_thr));
-    }
-    thread_routine_(local_size);
+    return (parallel_loop(token,
+                          LOOP_SCHEDULE::_static_, 0,
+                          begin, end,
+                          std::forward<F>(routine),
+                          std::forward<As>(args) ...));
 }
 
 // ----------------------------------------------------------------------------
 
-inline ThreadPool::size_type
-ThreadPool::available_threads() const noexcept  {
+template<typename F, typename I, typename ... As>
+ThreadPool::loop_res_t<F, I, As ...>
+ThreadPool::parallel_loop(const CancellationToken &token,
+                          LOOP_SCHEDULE schedule,
+                          size_type chunk_size,
+                          I begin,
+                          I end,
+                          F &&routine,
+                          As && ... args)  {
 
-    return (available_threads_.load(std::memory_order_relaxed));
+    // Each chunk checks the token before it starts. So, a chunk already
+    // running finishes, unless the routine polls the token itself.
+    //
+    return (parallel_loop(
+        schedule, chunk_size, begin, end,
+        [token, routine = std::forward<F>(routine)]
+        <typename ... Ts>(Ts && ... xs) mutable -> decltype(auto)  {
+            token.throw_if_cancelled();
+            return (std::invoke(routine, std::forward<Ts>(xs) ...));
+        },
+        std::forward<As>(args) ...));
 }
 
 // ----------------------------------------------------------------------------
 
-inline ThreadPool::size_type
-ThreadPool::capacity_threads() const noexcept  {
+template<typename F, typename I1, typename I2, typename ... As>
+ThreadPool::loop2_res_t<F, I1, I2, As ...>
+ThreadPool::parallel_loop2(LOOP_SCHEDULE schedule,
+                           size_type chunk_size,
+                           I1 begin1,
+                           I1 end1,
+                           I2 begin2,
+                           I2 end2,
+                           F &&routine,
+                           As && ... args)  {
+
+    if (schedule == LOOP_SCHEDULE::_static_ && chunk_size == 0)
+        return (parallel_loop2(begin1, end1, begin2, end2,
+                               std::forward<F>(routine),
+                               std::forward<As>(args) ...));
+
+    if (is_shutdown() || capacity_threads() == 0)
+        throw std::runtime_error("ThreadPool::parallel_loop2(): "
+                                 "Thread-pool has 0 thread capacity.");
+    if (chunk_size < 0)
+        throw std::runtime_error("ThreadPool::parallel_loop2(): "
+                                 "Chunk size cannot be negative.");
+
+    using task_return_t =
+        std::invoke_result_t<std::decay_t<F>,
+                             std::decay_t<I1>,
+                             std::decay_t<I1>,
+                             std::decay_t<I2>,
+                             std::decay_t<As> ...>;
+
+    size_type   n { 0 };
+
+    if constexpr (std::is_integral<I1>::value)
+        n = std::min(end1 - begin1, end2 - begin2);
+    else
+        n = std::min(std::distance(begin1, end1), std::distance(begin2, end2));
+
+    return (run_chunks_<task_return_t>(
+        schedule,
+        loop_chunks_(schedule, chunk_size, n),
+        [begin1, begin2,
+         routine = std::forward<F>(routine),
+         ... args = std::forward<As>(args)]
+        (size_type first, size_type last) mutable -> task_return_t  {
+            return (std::invoke(routine,
+                                begin1 + first,
+                                begin1 + last,
+                                begin2 + first,
+                                unwrap_ref_(args) ...));
+        }));
+}
+
+// ----------------------------------------------------------------------------
+
+inline ThreadPool::ChunkList
+ThreadPool::loop_chunks_(LOOP_SCHEDULE schedule,
+                         size_type chunk_size,
+                         size_type n) const  {
+
+    const size_type threads { std::max(capacity_threads(), size_type(1)) };
+    ChunkList       chunks;
+
+    if (n <= 0)  return (chunks);
+
+    if (schedule == LOOP_SCHEDULE::_static_ ||
+        schedule == LOOP_SCHEDULE::_dynamic_)  {
+        size_type   size { chunk_size };
+
+        // One chunk per thread for static, so it is the same as the plain
+        // parallel_loop(). Enough chunks to even out the load for dynamic.
+        //
+        if (size == 0)
+            size = (schedule == LOOP_SCHEDULE::_static_)
+                ? (n + threads - 1) / threads
+                : std::max(n / (threads * 8), size_type(1));
+
+        chunks.reserve((n + size - 1) / size);
+        for (size_type first = 0; first < n; first += size)
+            chunks.emplace_back(first, std::min(first + size, n));
+    }
+    else  {  // Guided or auto
+
+        // A chunk is a share of what is left, so the last ones are small
+        // and finish about together
+        //
+        size_type   min_size { chunk_size };
+
+        if (min_size == 0)
+            min_size = (schedule == LOOP_SCHEDULE::_auto_)
+                ? std::max(n / (threads * 16), size_type(1))
+                : size_type(1);
+
+        for (size_type first = 0; first < n; )  {
+            const size_type size {
+                std::max((n - first) / (threads * 2), min_size)
+            };
+            const size_type last { std::min(first + size, n) };
+
+            chunks.emplace_back(first, last);
+            first = last;
+        }
+    }
+    return (chunks);
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename R, typename C>
+std::vector<std::future<R>>
+ThreadPool::run_chunks_(LOOP_SCHEDULE schedule,
+                        ChunkList &&chunks,
+                        C &&run_chunk)  {
+
+    struct  LoopState  {
+
+        ChunkList                       chunks { };
+        std::vector<std::promise<R>>    promises { };
+
+        // Next chunk to claim, unless it is static
+        //
+        alignas(CACHE_LINE_SIZE) std::atomic<size_type> next { 0 };
+    };
+
+    const auto      state { std::make_shared<LoopState>() };
+    const size_type chunk_count = chunks.size();
+
+    state->chunks = std::move(chunks);
+    state->promises.reserve(chunk_count);
+
+    std::vector<std::future<R>> ret;
+
+    ret.reserve(chunk_count);
+    for (size_type i = 0; i < chunk_count; ++i)
+        ret.push_back(
+            state->promises.emplace_back(std::allocator_arg,
+                                         RecyclingAllocator<R> { })
+                .get_future());
+
+    // Every task has its own copy of the routine, as in the static loop
+    //
+    const size_type         task_count {
+        std::min(capacity_threads(), chunk_count)
+    };
+    const bool              claim { schedule != LOOP_SCHEDULE::_static_ };
+    std::vector<WorkUnit>   work_units;
+
+    work_units.reserve(task_count);
+    for (size_type t = 0; t < task_count; ++t)
+        work_units.emplace_back(
+            WORK_TYPE::_client_service_,
+            [state, t, task_count, claim, run_chunk]() mutable -> void  {
+                const size_type chunk_count = state->chunks.size();
+                const auto      run =
+                    [&state, &run_chunk](size_type k) -> void  {
+                        const auto      &[first, last] = state->chunks[k];
+                        std::promise<R> &promise = state->promises[k];
+
+                        try  {
+                            if constexpr (std::is_void_v<R>)  {
+                                run_chunk(first, last);
+                                promise.set_value();
+                            }
+                            else
+                                promise.set_value(run_chunk(first, last));
+                        }
+                        catch (...)  {
+                            promise.set_exception(std::current_exception());
+                        }
+                    };
+
+                if (claim)  {
+                    for (size_type k =
+                             state->next.fetch_add(1,
+                                                   std::memory_order_relaxed);
+                         k < chunk_count;
+                         k = state->next.fetch_add(1,
+                                                   std::memory_order_relaxed))
+                        run(k);
+                }
+                else  {
+                    for (size_type k = t; k < chunk_count; k += task_count)
+                        run(k);
+                }
+            });
+
+    // Static chunks of a thread are spread over the range, so there is no
+    // point in keeping them on a NUMA node
+    //
+    enqueue_bulk_(work_units);
+
+    return (ret);
+}
+
+// ----------------------------------------------------------------------------
+
+template<std::random_access_iterator I, long TH>
+void
+ThreadPool::parallel_sort(const I begin, const I end)  {
+
+    using value_type = typename std::iterator_traits<I>::value_type;
+
+    auto    compare = std::less<value_type>{ };
+
+    parallel_sort<I, decltype(compare), TH>(begin, end, std::move(compare));
+}
+
+// ----------------------------------------------------------------------------
+
+template<std::random_access_iterator I, typename P>
+static inline I
+_median_of_three_(I a, I b, I c, P &compare) {
+
+    if (compare(*b, *a))  std::swap(a, b);
+    if (compare(*c, *b))  std::swap(b, c);
+    if (compare(*b, *a))  std::swap(a, b);
+    return (b); // *a <= *b <= *c under compare
+}
+
+// --------------------------------------
+
+template<std::random_access_iterator I, typename P, long TH>
+void
+ThreadPool::parallel_sort(const I begin, const I end, P compare)  {
+
+    using value_type = typename std::iterator_traits<I>::value_type;
+
+    if constexpr (std::is_default_constructible_v<value_type>)
+        sample_sort_<I, P, TH>(begin, end, compare);
+    else
+        quick_sort_<I, P, TH>(begin, end, std::move(compare));
+}
+
+// ----------------------------------------------------------------------------
+
+template<std::random_access_iterator I, typename P, long TH>
+void
+ThreadPool::sample_sort_(const I begin, const I end, P &compare)  {
+
+    using value_type = typename std::iterator_traits<I>::value_type;
+    using bucket_type = std::uint16_t;
+
+    // Buckets per thread, to even out the load of sorting them
+    //
+    constexpr size_type bucket_factor { 4 };
+    constexpr size_type oversample { 32 };  // Samples per splitter
+    constexpr size_type max_buckets { 4096 };
+
+    const size_type n = std::distance(begin, end);
+    const size_type workers { capacity_threads() + 1 };  // And the caller
+    const size_type bucket_target {
+        std::min({ workers * bucket_factor,
+                   n / size_type(std::max(TH, 1L)),
+                   max_buckets })
+    };
+
+    if (n <= TH || workers == 1 || bucket_target < 2)  {
+        std::sort(begin, end, compare);
+        return;
+    }
+
+    // Splitters are every oversample'th value of a sorted random sample.
+    // Equivalent ones are dropped, since they would make empty buckets.
+    //
+    std::vector<value_type> splitters;
+
+    {
+        std::vector<value_type>                     sample;
+        std::minstd_rand                            gen {
+            static_cast<std::minstd_rand::result_type>(n)
+        };
+        std::uniform_int_distribution<size_type>    dist { 0, n - 1 };
+
+        sample.reserve(bucket_target * oversample);
+        for (size_type i = 0; i < bucket_target * oversample; ++i)
+            sample.push_back(*(begin + dist(gen)));
+        std::sort(sample.begin(), sample.end(), compare);
+
+        splitters.reserve(bucket_target - 1);
+        for (size_type i = 1; i < bucket_target; ++i)  {
+            const value_type    &s = sample[i * oversample];
+
+            if (splitters.empty() || compare(splitters.back(), s))
+                splitters.push_back(s);
+        }
+    }
+
+    // Bucket 2i holds values between splitters i - 1 and i, and bucket
+    // 2i + 1 holds values equivalent to splitter i. The latter are never
+    // sorted.
+    //
+    const size_type split_count = splitters.size();
+    const size_type bucket_count { split_count * 2 + 1 };
+    const auto      classify =
+        [&splitters, &compare, split_count](const value_type &x)
+            -> bucket_type  {
+            const size_type i =
+                std::lower_bound(splitters.begin(), splitters.end(),
+                                 x, compare) - splitters.begin();
+
+            return (bucket_type(i * 2 +
+                                (i < split_count &&
+                                 ! compare(x, splitters[i]))));
+        };
+
+    // Each worker classifies its own block, remembering the bucket of every
+    // element, and counts the elements it has for every bucket
+    //
+    const size_type             block_size { (n + workers - 1) / workers };
+    const size_type             blocks { (n + block_size - 1) / block_size };
+    std::vector<bucket_type>    ids (n);
+    std::vector<size_type>      offsets (blocks * bucket_count, 0);
+
+    run_workers_(blocks,
+                 [&](size_type block) -> void  {
+                     const size_type        first { block * block_size };
+                     const size_type        last {
+                         std::min(first + block_size, n)
+                     };
+                     std::vector<size_type> counts (bucket_count, 0);
+
+                     for (size_type i = first; i < last; ++i)  {
+                         const bucket_type  b = classify(*(begin + i));
+
+                         ids[i] = b;
+                         counts[b] += 1;
+                     }
+                     std::copy(counts.begin(), counts.end(),
+                               offsets.begin() + block * bucket_count);
+                 });
+
+    // Turn the counts into the position where each block writes its first
+    // element of each bucket. Blocks are laid out in order within a bucket.
+    //
+    std::vector<size_type>  bucket_first (bucket_count + 1, 0);
+    size_type               position { 0 };
+
+    for (size_type b = 0; b < bucket_count; ++b)  {
+        bucket_first[b] = position;
+        for (size_type block = 0; block < blocks; ++block)  {
+            size_type   &offset = offsets[block * bucket_count + b];
+            const auto  count = offset;
+
+            offset = position;
+            position += count;
+        }
+    }
+    bucket_first[bucket_count] = position;
+
+    std::vector<value_type> buffer (n);
+
+    run_workers_(blocks,
+                 [&](size_type block) -> void  {
+                     const size_type    first { block * block_size };
+                     const size_type    last {
+                         std::min(first + block_size, n)
+                     };
+                     size_type          *offset {
+                         offsets.data() + block * bucket_count
+                     };
+
+                     for (size_type i = first; i < last; ++i)
+                         buffer[offset[ids[i]]++] = std::move(*(begin + i));
+                 });
+
+    // The elements are moved back before they are sorted. So, if compare
+    // throws, they are all still in the range.
+    // The biggest buckets are claimed first.
+    //
+    std::vector<size_type>  order (bucket_count);
+
+    std::iota(order.begin(), order.end(), size_type(0));
+    std::sort(order.begin(), order.end(),
+              [&bucket_first](size_type a, size_type b) -> bool  {
+                  return (bucket_first[a + 1] - bucket_first[a] >
+                          bucket_first[b + 1] - bucket_first[b]);
+              });
+
+    std::atomic<size_type>  next_bucket { 0 };
+
+    run_workers_(std::min(workers, bucket_count),
+                 [&](size_type) -> void  {
+                     for (size_type c =
+                              next_bucket.fetch_add(
+                                  1, std::memory_order_relaxed);
+                          c < bucket_count;
+                          c = next_bucket.fetch_add(
+                                  1, std::memory_order_relaxed))  {
+                         const size_type    b { order[c] };
+                         const auto         first {
+                             buffer.begin() + bucket_first[b]
+                         };
+                         const auto         last {
+                             buffer.begin() + bucket_first[b + 1]
+                         };
+                         const auto         dest {
+                             begin + bucket_first[b]
+                         };
+
+                         std::move(first, last, dest);
+                         if (b % 2 == 0)
+                             std::sort(dest, dest + (last - first),
+                                       compare);
+                     }
+                 });
+}
+
+// ----------------------------------------------------------------------------
+
+template<std::random_access_iterator I, typename P, long TH>
+void
+ThreadPool::quick_sort_(const I begin, const I end, P compare)  {
+
+    if (begin >= end) return;
+
+    const size_type data_size = std::distance(begin, end);
+
+    if (data_size <= TH)  {
+        std::sort(begin, end, compare);
+        return;
+    }
+
+    // Pivot selection (median‑of‑three)
+    //
+    auto        mid = begin + (data_size / 2);
+    auto        pivot_it = _median_of_three_(begin, mid, end - 1, compare);
+    const auto  pivot = *pivot_it;
+
+    std::iter_swap(pivot_it, end - 1);  // Move pivot to end ‑ 1
+
+    auto    cut =
+        std::ranges::partition(begin, end - 1,
+                               [&pivot, &compare](const auto &x) -> bool {
+                                   return (compare(x, pivot));
+                               });
+
+    std::iter_swap(cut.begin(), end - 1);  // Restore pivot
+
+    // The left partition may go to another thread, and we sort the right
+    // one ourselves. Waiting on the group runs the left one here, if nobody
+    // has taken it yet.
+    //
+    TaskGroup   group { make_group() };
+
+    group.run(&ThreadPool::quick_sort_<I, P, TH>,
+              this,
+              begin,
+              cut.begin(),
+              compare);
+    quick_sort_<I, P, TH>(cut.begin() + 1, end, compare);
+    group.wait();
+}
+
+// ----------------------------------------------------------------------------
+
+template<std::random_access_iterator I, std::random_access_iterator O,
+         typename BOP, long TH>
+O ThreadPool::parallel_adjacent_difference(I begin, I end, O out, BOP op)  {
+
+    using value_type = std::iter_value_t<I>;
+
+    const size_type n = std::distance(begin, end);
+    const size_type block_target {
+        std::min(capacity_threads() + 1, n / size_type(std::max(TH, 1L)))
+    };
+
+    if (block_target < 2)
+        return (std::adjacent_difference(begin, end, out, op));
+
+    const size_type         block_size {
+        (n + block_target - 1) / block_target
+    };
+    const size_type         blocks { (n + block_size - 1) / block_size };
+    std::vector<value_type> halos;  // Element before each block but the 1st
+
+    halos.reserve(blocks - 1);
+    for (size_type block = 1; block < blocks; ++block)
+        halos.push_back(*(begin + (block * block_size - 1)));
+
+    run_workers_(blocks,
+                 [&](size_type block) -> void  {
+                     size_type          i { block * block_size };
+                     const size_type    last {
+                         std::min(i + block_size, n)
+                     };
+                     value_type         prev =
+                         block == 0 ? value_type(*begin)
+                                    : std::move(halos[block - 1]);
+
+                     if (block == 0)  {
+                         *out = prev;
+                         i += 1;
+                     }
+
+                     for (; i < last; ++i)  {
+                         value_type current = *(begin + i);
+
+                         *(out + i) = op(current, std::move(prev));
+                         prev = std::move(current);
+                     }
+                 });
+    return (out + n);
+}
+
+// ----------------------------------------------------------------------------
+
+template<std::random_access_iterator I, std::random_access_iterator O,
+         typename F, long TH>
+requires std::invocable<F &, I, I, I>
+O ThreadPool::parallel_stencil(I begin, I end,
+                               O out,
+                               size_type radius,
+                               F op)  {
+
+    if (radius < 0)
+        throw std::runtime_error("ThreadPool::parallel_stencil(): "
+                                 "radius cannot be negative.");
+
+    const size_type n = std::distance(begin, end);
+
+    if (n <= 0)  return (out);
+
+    const size_type block_target {
+        std::min(capacity_threads() + 1,
+                 std::max(n / size_type(std::max(TH, 1L)), size_type(1)))
+    };
+    const size_type block_size { (n + block_target - 1) / block_target };
+
+    run_workers_((n + block_size - 1) / block_size,
+                 [&](size_type block) -> void  {
+                     const size_type    first { block * block_size };
+                     const size_type    last {
+                         std::min(first + block_size, n)
+                     };
+
+                     for (size_type i = first; i < last; ++i)  {
+                         const auto center { begin + i };
+
+                         *(out + i) =
+                             std::invoke(op,
+                                         center - std::min(radius, i),
+                                         center,
+                                         center + (std::min(radius,
+                                                            n - 1 - i) + 1));
+                     }
+                 });
+    return (out + n);
+}
+
+// ----------------------------------------------------------------------------
+
+template<std::random_access_iterator I, long TH>
+void
+ThreadPool::parallel_stable_sort(I begin, I end)  {
+
+    parallel_stable_sort<I, std::less<std::iter_value_t<I>>, TH>(
+        begin, end, std::less<std::iter_value_t<I>> { });
+}
+
+// --------------------------------------
+
+template<std::random_access_iterator I, typename P, long TH>
+void
+ThreadPool::parallel_stable_sort(I begin, I end, P compare)  {
+
+    using value_type = std::iter_value_t<I>;
+
+    const size_type n = std::distance(begin, end);
+    const size_type workers { capacity_threads() + 1 };  // And the caller
+    const size_type run_count {
+        std::min(workers, n / size_type(std::max(TH, 1L)))
+    };
+
+    if constexpr (std::is_default_constructible_v<value_type>)  {
+        if (run_count < 2)  {
+            std::stable_sort(begin, end, compare);
+            return;
+        }
+
+        const size_type run_size { (n + run_count - 1) / run_count };
+
+        run_workers_((n + run_size - 1) / run_size,
+                     [&](size_type run) -> void  {
+                         const size_type    first { run * run_size };
+
+                         std::stable_sort(begin + first,
+                                          begin + std::min(first + run_size,
+                                                           n),
+                                          compare);
+                     });
+
+        // Pieces are small enough to even out the load, even in the last
+        // pass, which is one merge
+        //
+        const size_type         piece_size {
+            std::max(n / (workers * 4), size_type(std::max(TH, 1L)))
+        };
+        std::vector<value_type> buffer (n);
+        bool                    in_buffer { false };
+
+        for (size_type width = run_size; width < n; width *= 2)  {
+            if (in_buffer)
+                merge_pass_(buffer.begin(), begin,
+                            n, width, piece_size, compare);
+            else
+                merge_pass_(begin, buffer.begin(),
+                            n, width, piece_size, compare);
+            in_buffer = ! in_buffer;
+        }
+        if (in_buffer)
+            run_workers_((n + run_size - 1) / run_size,
+                         [&](size_type block) -> void  {
+                             const size_type    first { block * run_size };
+                             const auto         from {
+                                 buffer.begin() + first
+                             };
+
+                             std::move(from,
+                                       from + std::min(run_size, n - first),
+                                       begin + first);
+                         });
+    }
+    else  {
+        std::stable_sort(begin, end, compare);
+    }
+}
+
+// --------------------------------------
+
+// How many of the first k elements of the stable merge of a (of size na)
+// and b (of size nb) come from a. Elements of a go first among equivalent
+// ones.
+//
+template<typename S, typename P>
+static inline long
+_merge_co_rank_(S a, long na, S b, long nb, long k, P &compare)  {
+
+    long    low { k > nb ? k - nb : 0 };
+    long    high { std::min(k, na) };
+
+    while (low < high)  {
+        const long  i { low + (high - low) / 2 };
+        const long  j { k - i };
+
+        // If a[i] doesn't go after b[j - 1], more of a is in the first k
+        //
+        if (j > 0 && ! compare(*(b + (j - 1)), *(a + i)))
+            low = i + 1;
+        else
+            high = i;
+    }
+    return (low);
+}
+
+// --------------------------------------
+
+template<typename S, typename D, typename P>
+void ThreadPool::merge_pass_(S src,
+                             D dst,
+                             size_type n,
+                             size_type width,
+                             size_type piece_size,
+                             P &compare)  {
+
+    // A piece is [out_first, out_last) of the output of the merge of
+    // [first, mid) and [mid, last). A run without a partner is a merge
+    // with an empty one.
+    // The co-ranks are all found before merging starts, since merging
+    // moves elements out of src that other searches may look at.
+    //
+    struct  Piece  {
+
+        size_type   first;
+        size_type   mid;
+        size_type   out_first;
+        size_type   out_last;
+        size_type   a_first;  // Co-ranks of out_first and out_last
+        size_type   a_last;
+    };
+
+    std::vector<Piece>  pieces;
+
+    for (size_type first = 0; first < n; first += width * 2)  {
+        const size_type mid { std::min(first + width, n) };
+        const size_type last { std::min(first + width * 2, n) };
+        const auto      a { src + first };
+        const auto      b { src + mid };
+        size_type       a_first { 0 };
+
+        for (size_type k = 0; k < last - first; k += piece_size)  {
+            const size_type out_last { std::min(k + piece_size,
+                                                last - first) };
+            const size_type a_last = (out_last == last - first)
+                ? mid - first
+                : _merge_co_rank_(a, mid - first, b, last - mid,
+                                  out_last, compare);
+
+            pieces.push_back({ first, mid, k, out_last, a_first, a_last });
+            a_first = a_last;
+        }
+    }
+
+    const size_type         piece_count = pieces.size();
+    std::atomic<size_type>  next_piece { 0 };
+
+    run_workers_(std::min(capacity_threads() + 1, piece_count),
+                 [&](size_type) -> void  {
+                     for (size_type p =
+                              next_piece.fetch_add(
+                                  1, std::memory_order_relaxed);
+                          p < piece_count;
+                          p = next_piece.fetch_add(
+                                  1, std::memory_order_relaxed))  {
+                         const Piece    &piece = pieces[p];
+                         const auto     a { src + piece.first };
+                         const auto     b { src + piece.mid };
+
+                         std::merge(
+                             std::make_move_iterator(a + piece.a_first),
+                             std::make_move_iterator(a + piece.a_last),
+                             std::make_move_iterator(
+                                 b + (piece.out_first - piece.a_first)),
+                             std::make_move_iterator(
+                                 b + (piece.out_last - piece.a_last)),
+                             dst + (piece.first + piece.out_first),
+                             compare);
+                     }
+                 });
+}
+
+// ----------------------------------------------------------------------------
+
+// Unsigned bits of a key that sort in the same order as the key
+//
+template<RadixKey T>
+static inline auto
+_radix_bits_(T value) noexcept  {
+
+    using bits_type =
+        std::conditional_t<
+            sizeof(T) == 1, std::uint8_t,
+            std::conditional_t<
+                sizeof(T) == 2, std::uint16_t,
+                std::conditional_t<sizeof(T) == 4,
+                                   std::uint32_t,
+                                   std::uint64_t>>>;
+
+    constexpr bits_type sign_bit =
+        bits_type(bits_type(1) << (sizeof(T) * 8 - 1));
+    const bits_type     bits = std::bit_cast<bits_type>(value);
+
+    // Negative floating point numbers are in sign and magnitude. So, all
+    // their bits are flipped to reverse their order.
+    //
+    if constexpr (std::floating_point<T>)
+        return (bits_type((bits & sign_bit) ? ~bits : (bits | sign_bit)));
+    else if constexpr (std::is_signed_v<T>)
+        return (bits_type(bits ^ sign_bit));
+    else
+        return (bits);
+}
+
+// --------------------------------------
+
+template<std::random_access_iterator I, long TH>
+requires RadixKey<std::iter_value_t<I>>
+void
+ThreadPool::parallel_radix_sort(I begin, I end)  {
+
+    using value_type = std::iter_value_t<I>;
+
+    const size_type n = std::distance(begin, end);
+    const auto      bits =
+        [](value_type value) noexcept  { return (_radix_bits_(value)); };
+
+    if (n <= std::max(TH, 1L))  {
+        std::sort(begin, end,
+                  [&bits](value_type x, value_type y) -> bool  {
+                      return (bits(x) < bits(y));
+                  });
+        return;
+    }
+
+    const size_type         workers {
+        std::min(capacity_threads() + 1, n / std::max(TH, 1L) + 1)
+    };
+    const size_type         block_size { (n + workers - 1) / workers };
+    std::vector<value_type> buffer (n);
+
+    if constexpr (std::contiguous_iterator<I>)  {
+        radix_passes_(std::to_address(begin), buffer.data(), n, block_size,
+                      bits);
+    }
+    else  {
+        std::vector<value_type> data (begin, end);
+
+        radix_passes_(data.data(), buffer.data(), n, block_size, bits);
+        std::copy(data.begin(), data.end(), begin);
+    }
+}
+
+// --------------------------------------
+
+template<std::random_access_iterator I, typename K, long TH>
+requires RadixKey<std::remove_cvref_t<
+    std::invoke_result_t<K &, std::iter_reference_t<I>>>>
+void
+ThreadPool::parallel_radix_sort(I begin, I end, K key)  {
+
+    using value_type = std::iter_value_t<I>;
+
+    const size_type n = std::distance(begin, end);
+
+    if (n <= std::max(TH, 1L))  {
+        std::stable_sort(begin, end,
+                         [&key](const value_type &x,
+                                const value_type &y) -> bool  {
+                             return (_radix_bits_(std::invoke(key, x)) <
+                                     _radix_bits_(std::invoke(key, y)));
+                         });
+        return;
+    }
+
+    using bits_type = decltype(_radix_bits_(std::invoke(key, *begin)));
+
+    struct  KeyIndex  {
+
+        bits_type   bits;
+        size_type   index;
+    };
+
+    // Every block has at least one item, so none of them starts past n
+    //
+    const size_type         workers {
+        std::min(capacity_threads() + 1, n / std::max(TH, 1L) + 1)
+    };
+    const size_type         block_size { (n + workers - 1) / workers };
+    const size_type         blocks { (n + block_size - 1) / block_size };
+    std::vector<KeyIndex>   items (n);
+
+    run_workers_(blocks,
+                 [&](size_type block) -> void  {
+                     const size_type    last {
+                         std::min((block + 1) * block_size, n)
+                     };
+
+                     for (size_type i = block * block_size; i < last; ++i)
+                         items[i] = { _radix_bits_(std::invoke(key,
+                                                               *(begin + i))),
+                                      i };
+                 });
+
+    {
+        std::vector<KeyIndex>   buffer (n);
+
+        radix_passes_(items.data(), buffer.data(), n, block_size,
+                      [](const KeyIndex &item) noexcept  {
+                          return (item.bits);
+                      });
+    }
+
+    // items[i].index is where the record that belongs at i is now
+    //
+    if constexpr (std::is_default_constructible_v<value_type>)  {
+        std::vector<value_type> sorted (n);
+
+        run_workers_(blocks,
+                     [&](size_type block) -> void  {
+                         const size_type    last {
+                             std::min((block + 1) * block_size, n)
+                         };
+
+                         for (size_type i = block * block_size; i < last; ++i)
+                             sorted[i] = std::move(*(begin + items[i].index));
+                     });
+        run_workers_(blocks,
+                     [&](size_type block) -> void  {
+                         const size_type    first { block * block_size };
+                         const size_type    last {
+                             std::min(first + block_size, n)
+                         };
+
+                         std::move(sorted.begin() + first,
+                                   sorted.begin() + last,
+                                   begin + first);
+                     });
+    }
+    else  {  // Follow the cycles of the permutation
+        for (size_type i = 0; i < n; ++i)  {
+            if (items[i].index == i)  continue;
+
+            value_type  value = std::move(*(begin + i));
+            size_type   j { i };
+
+            while (true)  {
+                const size_type from { items[j].index };
+
+                items[j].index = j;  // Done
+                if (from == i)  {
+                    *(begin + j) = std::move(value);
+                    break;
+                }
+                *(begin + j) = std::move(*(begin + from));
+                j = from;
+            }
+        }
+    }
+}
+
+// --------------------------------------
+
+template<typename T, typename B>
+void ThreadPool::radix_passes_(T *data,
+                               T *buffer,
+                               size_type n,
+                               size_type block_size,
+                               const B &bits)  {
+
+    using bits_type = decltype(bits(*data));
+
+    constexpr size_type radix { 256 };
+    constexpr size_type passes { sizeof(bits_type) };
+
+    // Items going to the same bucket are gathered in a cache line before
+    // they are written. So, the scatter doesn't touch a new line of the
+    // output for every item.
+    //
+    constexpr size_type line_items {
+        std::max(CACHE_LINE_SIZE / sizeof(T), std::size_t(1))
+    };
+
+    const size_type         blocks { (n + block_size - 1) / block_size };
+    std::vector<size_type>  offsets (blocks * radix);
+    T                       *from { data };
+    T                       *to { buffer };
+
+    for (size_type pass = 0; pass < passes; ++pass)  {
+        const auto  digit =
+            [&bits, shift = pass * 8](const T &item) noexcept -> size_type  {
+                return (size_type((bits(item) >> shift) & 0xFF));
+            };
+
+        run_workers_(blocks,
+                     [&](size_type block) -> void  {
+                         const size_type    first { block * block_size };
+                         const size_type    last {
+                             std::min(first + block_size, n)
+                         };
+                         size_type          counts[radix] { };
+
+                         for (size_type i = first; i < last; ++i)
+                             counts[digit(from[i])] += 1;
+                         std::copy(counts, counts + radix,
+                                   offsets.begin() + block * radix);
+                     });
+
+        // Prefix sum over the counts, bucket by bucket and block by block
+        // within a bucket. It also finds out if all items have the same byte.
+        //
+        size_type   position { 0 };
+        bool        one_bucket { false };
+
+        for (size_type d = 0; d < radix; ++d)  {
+            const size_type start { position };
+
+            for (size_type block = 0; block < blocks; ++block)  {
+                size_type   &offset = offsets[block * radix + d];
+                const auto  count = offset;
+
+                offset = position;
+                position += count;
+            }
+            if (position - start == n)  {
+                one_bucket = true;
+                break;
+            }
+        }
+        if (one_bucket)  continue;
+
+        run_workers_(blocks,
+                     [&](size_type block) -> void  {
+                         const size_type    first { block * block_size };
+                         const size_type    last {
+                             std::min(first + block_size, n)
+                         };
+                         size_type          *offset {
+                             offsets.data() + block * radix
+                         };
+                         std::vector<T>     lines (radix * line_items);
+                         size_type          fill[radix] { };
+
+                         for (size_type i = first; i < last; ++i)  {
+                             const size_type    d { digit(from[i]) };
+                             T                  *line {
+                                 lines.data() + d * line_items
+                             };
+
+                             line[fill[d]++] = from[i];
+                             if (fill[d] == line_items)  {
+                                 std::copy(line, line + line_items,
+                                           to + offset[d]);
+                                 offset[d] += line_items;
+                                 fill[d] = 0;
+                             }
+                         }
+                         for (size_type d = 0; d < radix; ++d)
+                             std::copy(lines.data() + d * line_items,
+                                       lines.data() + d * line_items + fill[d],
+                                       to + offset[d]);
+                     });
+        std::swap(from, to);
+    }
+
+    if (from != data)
+        run_workers_(blocks,
+                     [&](size_type block) -> void  {
+                         const size_type    first { block * block_size };
+                         const size_type    last {
+                             std::min(first + block_size, n)
+                         };
+
+                         std::copy(from + first, from + last, data + first);
+                     });
+}
+
+// ----------------------------------------------------------------------------
+
+template<std::random_access_iterator I, long TH>
+void ThreadPool::parallel_nth_element(I begin, I nth, I end)  {
+
+    using value_type = std::iter_value_t<I>;
+
+    parallel_nth_element<I, std::less<value_type>, TH>(
+        begin, nth, end, std::less<value_type>{ });
+}
+
+// --------------------------------------
+
+template<std::random_access_iterator I, typename P, long TH>
+void ThreadPool::parallel_nth_element(I begin, I nth, I end, P compare)  {
+
+    if (nth < begin || nth >= end)  return;
+
+    // Bad pivots are given a limit, as in std::nth_element
+    //
+    size_type   steps_left { 0 };
+
+    for (size_type n = std::distance(begin, end); n > 1; n /= 2)
+        steps_left += 2;
+
+    while (std::distance(begin, end) > std::max(TH, 1L) && steps_left-- > 0)
+    {
+        const auto  pivot =
+            *_median_of_three_(begin,
+                               begin + std::distance(begin, end) / 2,
+                               end - 1,
+                               compare);
+        const I     less_end =
+            partition_<TH>(begin, end,
+                           [&pivot, &compare](const auto &x) -> bool  {
+                               return (compare(x, pivot));
+                           });
+
+        if (nth < less_end)  {
+            end = less_end;
+            continue;
+        }
+
+        // The pivot itself is in the equal part. So, every step drops at
+        // least one element, even if all of them are equal.
+        //
+        const I equal_end =
+            partition_<TH>(less_end, end,
+                           [&pivot, &compare](const auto &x) -> bool  {
+                               return (! compare(pivot, x));
+                           });
+
+        if (nth < equal_end)  return;
+        begin = equal_end;
+    }
+    std::nth_element(begin, nth, end, compare);
+}
+
+// ----------------------------------------------------------------------------
+
+template<std::random_access_iterator I, long TH>
+void ThreadPool::parallel_partial_sort(I begin, I middle, I end)  {
+
+    using value_type = std::iter_value_t<I>;
+
+    parallel_partial_sort<I, std::less<value_type>, TH>(
+        begin, middle, end, std::less<value_type>{ });
+}
+
+// --------------------------------------
+
+template<std::random_access_iterator I, typename P, long TH>
+void ThreadPool::parallel_partial_sort(I begin, I middle, I end, P compare)  {
+
+    if (middle <= begin)  return;
+
+    // The element before middle is the last one of the front
+    //
+    parallel_nth_element<I, P, TH>(begin, middle - 1, end, compare);
+    parallel_sort<I, P, TH>(begin, middle - 1, compare);
+}
+
+// ----------------------------------------------------------------------------
+
+template<std::random_access_iterator I, typename P, long TH>
+std::vector<std::iter_value_t<I>>
+ThreadPool::parallel_top_k(I begin, I end, size_type k, P compare)  {
+
+    using value_type = std::iter_value_t<I>;
+
+    if (k < 0)
+        throw std::runtime_error("ThreadPool::parallel_top_k(): "
+                                 "k cannot be negative.");
+
+    const size_type         n = std::distance(begin, end);
+    std::vector<value_type> result;
+
+    k = std::min(k, n);
+    if (k == 0)  return (result);
+
+    const size_type workers { capacity_threads() + 1 };  // And the caller
+    const size_type chunk_size {
+        std::max(n / (workers * 8), size_type(std::max(TH, 1L)))
+    };
+    const size_type chunk_count { (n + chunk_size - 1) / chunk_size };
+    const size_type slot_count { std::min(workers, chunk_count) };
+
+    if (k * slot_count >= n)  {
+        result.assign(begin, end);
+        parallel_partial_sort<typename std::vector<value_type>::iterator,
+                              P, TH>(result.begin(),
+                                     result.begin() + k,
+                                     result.end(),
+                                     compare);
+        result.erase(result.begin() + k, result.end());
+        return (result);
+    }
+
+    // The front of each heap is the worst of the best k its thread has
+    // seen so far
+    //
+    struct  alignas(CACHE_LINE_SIZE) Heap  {
+
+        std::vector<value_type> values { };
+    };
+
+    std::vector<Heap>       heaps (slot_count);
+    std::atomic<size_type>  next_chunk { 0 };
+    const auto              select =
+        [&](size_type slot) -> void  {
+            std::vector<value_type> &heap { heaps[slot].values };
+
+            heap.reserve(k);
+            try  {
+                for (size_type c =
+                         next_chunk.fetch_add(1, std::memory_order_relaxed);
+                     c < chunk_count;
+                     c = next_chunk.fetch_add(1, std::memory_order_relaxed))
+                {
+                    const I last {
+                        begin + std::min((c + 1) * chunk_size, n)
+                    };
+
+                    for (I iter = begin + c * chunk_size;
+                         iter != last; ++iter)  {
+                        if (size_type(heap.size()) < k)  {
+                            heap.push_back(*iter);
+                            std::push_heap(heap.begin(), heap.end(),
+                                           compare);
+                        }
+                        else if (compare(*iter, heap.front()))  {
+                            std::pop_heap(heap.begin(), heap.end(),
+                                          compare);
+                            heap.back() = *iter;
+                            std::push_heap(heap.begin(), heap.end(),
+                                           compare);
+                        }
+                    }
+                }
+            }
+            catch (...)  {  // Nobody needs the rest of the chunks
+                next_chunk.store(chunk_count, std::memory_order_relaxed);
+                throw;
+            }
+        };
+
+    run_workers_(slot_count, select);
+
+    result.reserve(k * slot_count);
+    for (auto &heap : heaps)
+        std::move(heap.values.begin(), heap.values.end(),
+                  std::back_inserter(result));
+    if (size_type(result.size()) > k)  {
+        std::nth_element(result.begin(), result.begin() + (k - 1),
+                         result.end(),
+                         compare);
+        result.erase(result.begin() + k, result.end());
+    }
+    std::sort(result.begin(), result.end(), compare);
+    return (result);
+}
+
+// ----------------------------------------------------------------------------
+
+template<std::random_access_iterator I, typename P, long TH>
+requires std::predicate<P &, std::iter_reference_t<I>>
+I ThreadPool::parallel_find_if(I begin, I end, P pred)  {
+
+    return (begin + find_if_<true, TH>(begin, end, pred));
+}
+
+// --------------------------------------
+
+template<std::random_access_iterator I, typename P, long TH>
+requires std::predicate<P &, std::iter_reference_t<I>>
+bool ThreadPool::parallel_any_of(I begin, I end, P pred)  {
+
+    return (find_if_<false, TH>(begin, end, pred) <
+            std::distance(begin, end));
+}
+
+// --------------------------------------
+
+template<std::random_access_iterator I, typename P, long TH>
+requires std::predicate<P &, std::iter_reference_t<I>>
+bool ThreadPool::parallel_all_of(I begin, I end, P pred)  {
+
+    auto    fails =
+        [&pred](std::iter_reference_t<I> value) -> bool  {
+            return (! std::invoke(pred, value));
+        };
+
+    return (find_if_<false, TH>(begin, end, fails) >=
+            std::distance(begin, end));
+}
+
+// --------------------------------------
+
+template<std::random_access_iterator I, typename P, long TH>
+requires std::predicate<P &, std::iter_reference_t<I>>
+bool ThreadPool::parallel_none_of(I begin, I end, P pred)  {
+
+    return (! parallel_any_of<I, P, TH>(begin, end, std::move(pred)));
+}
+
+// --------------------------------------
+
+template<bool lowest, long TH, std::random_access_iterator I, typename P>
+ThreadPool::size_type ThreadPool::find_if_(I begin, I end, P &pred)  {
+
+    const size_type n = std::distance(begin, end);
+
+    if (n <= std::max(TH, 1L))
+        return (std::distance(begin, std::find_if(begin, end, pred)));
+
+    // Small chunks, so threads don't go far past a match
+    //
+    const size_type         workers { capacity_threads() + 1 };
+    const size_type         chunk_size {
+        std::max(n / (workers * 32), size_type(std::max(TH, 1L)))
+    };
+    const size_type         chunk_count { (n + chunk_size - 1) / chunk_size };
+    std::atomic<size_type>  next_chunk { 0 };
+    std::atomic<size_type>  found { n };  // Lowest match so far
+    const auto              search =
+        [&](size_type) -> void  {
+            try  {
+                for (size_type c =
+                         next_chunk.fetch_add(1, std::memory_order_relaxed);
+                     c < chunk_count;
+                     c = next_chunk.fetch_add(1, std::memory_order_relaxed))
+                {
+                    const size_type first { c * chunk_size };
+                    const size_type last { std::min(first + chunk_size, n) };
+
+                    for (size_type i = first; i < last; ++i)  {
+                        const size_type best {
+                            found.load(std::memory_order_relaxed)
+                        };
+
+                        // Chunks are claimed in order. So, once this one
+                        // is past the best match, so are all later ones.
+                        //
+                        if (lowest ? i >= best : best < n)  return;
+                        if (std::invoke(pred, *(begin + i)))  {
+                            size_type   current { best };
+
+                            while (i < current &&
+                                   ! found.compare_exchange_weak(
+                                       current, i,
+                                       std::memory_order_relaxed))  { }
+                            break;
+                        }
+                    }
+                }
+            }
+            catch (...)  {  // Nobody needs the rest of the chunks
+                next_chunk.store(chunk_count, std::memory_order_relaxed);
+                throw;
+            }
+        };
+
+    run_workers_(std::min(workers, chunk_count), search);
+    return (found.load(std::memory_order_relaxed));
+}
+
+// ----------------------------------------------------------------------------
+
+template<long TH, std::random_access_iterator I, typename U>
+I ThreadPool::partition_(I begin, I end, const U &pred)  {
+
+    const size_type n = std::distance(begin, end);
+    const size_type workers { capacity_threads() + 1 };  // And the caller
+    const size_type block_size {
+        std::max((n + workers - 1) / workers, size_type(std::max(TH, 1L)))
+    };
+    const size_type blocks { (n + block_size - 1) / block_size };
+
+    if (blocks <= 1)  return (std::partition(begin, end, pred));
+
+    // Each block is partitioned by its own thread
+    //
+    std::vector<size_type>  block_trues (blocks);
+
+    run_workers_(blocks,
+                 [&](size_type b) -> void  {
+                     const I    first { begin + b * block_size };
+                     const I    last {
+                         begin + std::min((b + 1) * block_size, n)
+                     };
+
+                     block_trues[b] =
+                         std::distance(first,
+                                       std::partition(first, last, pred));
+                 });
+
+    // Now the false runs of blocks before the cut must be swapped with the
+    // true runs of blocks after it. Both have the same number of elements.
+    // Empty runs are left out, so the swaps never have to skip more than
+    // one run at a time.
+    //
+    struct  Run  {
+
+        size_type   first;
+        size_type   count;
+        size_type   before;  // Misplaced elements in earlier runs
+    };
+
+    const size_type cut {
+        std::accumulate(block_trues.begin(), block_trues.end(), size_type(0))
+    };
+    std::vector<Run>    falses;
+    std::vector<Run>    trues;
+    size_type           misplaced { 0 };
+
+    for (size_type b = 0; b < blocks; ++b)  {
+        const size_type first { b * block_size };
+        const size_type middle { first + block_trues[b] };
+        const size_type last { std::min((b + 1) * block_size, n) };
+
+        if (middle < cut && middle < last)  {
+            const size_type count { std::min(last, cut) - middle };
+
+            falses.push_back({ middle, count, misplaced });
+            misplaced += count;
+        }
+    }
+    misplaced = 0;
+    for (size_type b = 0; b < blocks; ++b)  {
+        const size_type first { b * block_size };
+        const size_type middle { first + block_trues[b] };
+
+        const size_type start { std::max(first, cut) };
+
+        if (middle > start)  {
+            trues.push_back({ start, middle - start, misplaced });
+            misplaced += middle - start;
+        }
+    }
+    if (misplaced == 0)  return (begin + cut);
+
+    const size_type piece_size {
+        std::max((misplaced + workers - 1) / workers,
+                 size_type(std::max(TH, 1L)))
+    };
+    const size_type pieces { (misplaced + piece_size - 1) / piece_size };
+
+    // Each piece swaps a range of the misplaced elements. It finds the runs
+    // its first element is in, and walks both lists of runs from there.
+    //
+    const auto  swap_piece =
+        [&](size_type piece) -> void  {
+            const size_type from { piece * piece_size };
+            const size_type to { std::min(from + piece_size, misplaced) };
+            const auto      run_of =
+                [from](const std::vector<Run> &runs) -> size_type  {
+                    return (std::distance(
+                                runs.begin(),
+                                std::upper_bound(
+                                    runs.begin(), runs.end(), from,
+                                    [](size_type i, const Run &run) -> bool {
+                                        return (i < run.before);
+                                    })) - 1);
+                };
+            size_type       f { run_of(falses) };
+            size_type       t { run_of(trues) };
+            size_type       f_pos {
+                falses[f].first + (from - falses[f].before)
+            };
+            size_type       t_pos {
+                trues[t].first + (from - trues[t].before)
+            };
+
+            for (size_type i = from; i < to; ++i)  {
+                if (f_pos == falses[f].first + falses[f].count)  {
+                    f += 1;
+                    f_pos = falses[f].first;
+                }
+                if (t_pos == trues[t].first + trues[t].count)  {
+                    t += 1;
+                    t_pos = trues[t].first;
+                }
+                std::iter_swap(begin + f_pos++, begin + t_pos++);
+            }
+        };
+
+    run_workers_(pieces, swap_piece);
+    return (begin + cut);
+}
+
+// ----------------------------------------------------------------------------
+
+template<std::random_access_iterator I, typename T, typename BOP, long TH>
+T ThreadPool::parallel_reduce(I begin, I end, T init, BOP reduce_op)  {
+
+    return (parallel_transform_reduce<I, T, BOP, std::identity, TH>(
+                begin, end, std::move(init), reduce_op, std::identity { }));
+}
+
+// ----------------------------------------------------------------------------
+
+template<std::random_access_iterator I, typename T, typename BOP,
+         typename UOP, long TH>
+T ThreadPool::parallel_transform_reduce(I begin, I end,
+                                        T init,
+                                        BOP reduce_op,
+                                        UOP transform_op)  {
+
+    const size_type n = std::distance(begin, end);
+
+    if (n <= 0)  return (init);
+
+    // Enough chunks to even out the load, but not smaller than TH
+    //
+    const size_type workers { capacity_threads() + 1 };  // And the caller
+    const size_type chunk_size {
+        std::max(n / (workers * 8), size_type(std::max(TH, 1L)))
+    };
+
+    return (reduce_chunks_(
+                n, chunk_size, 0,
+                std::move(init),
+                reduce_op,
+                [&](size_type first, size_type last) -> T  {
+                    return (std::transform_reduce(
+                                begin + (first + 1),
+                                begin + last,
+                                T(std::invoke(transform_op,
+                                              *(begin + first))),
+                                reduce_op,
+                                transform_op));
+                }));
+}
+
+// ----------------------------------------------------------------------------
+
+template<std::random_access_iterator I1, std::random_access_iterator I2,
+         typename T, typename BOP1, typename BOP2, long TH>
+T ThreadPool::parallel_inner_product(I1 begin1, I1 end1, I2 begin2,
+                                     T init,
+                                     BOP1 sum_op,
+                                     BOP2 product_op)  {
+
+    using value_type = std::iter_value_t<I1>;
+
+    const size_type n = std::distance(begin1, end1);
+
+    if (n <= 0)  return (init);
+
+    const size_type workers { capacity_threads() + 1 };  // And the caller
+    size_type       chunk_size {
+        std::max(n / (workers * 8), size_type(std::max(TH, 1L)))
+    };
+
+    constexpr bool  default_ops =
+        (std::same_as<BOP1, std::plus<>> ||
+         std::same_as<BOP1, std::plus<T>>) &&
+        (std::same_as<BOP2, std::multiplies<>> ||
+         std::same_as<BOP2, std::multiplies<value_type>>);
+    constexpr bool  simd_types =
+        std::same_as<value_type, std::iter_value_t<I2>> &&
+        (((std::same_as<value_type, float> ||
+           std::same_as<value_type, double>) &&
+          std::same_as<T, value_type>) ||
+         (std::same_as<value_type, std::int32_t> &&
+          std::integral<T> && sizeof(T) >= sizeof(std::int32_t)));
+
+    if constexpr (default_ops && simd_types &&
+                  std::contiguous_iterator<I1> &&
+                  std::contiguous_iterator<I2>)  {
+        const value_type    *a { std::to_address(begin1) };
+        const value_type    *b { std::to_address(begin2) };
+
+        // Chunks are whole cache lines of a. The first one also takes the
+        // elements before the first line boundary.
+        //
+        constexpr size_type line { CACHE_LINE_SIZE / sizeof(value_type) };
+        const size_type     head {
+            size_type((CACHE_LINE_SIZE -
+                       reinterpret_cast<std::uintptr_t>(a) %
+                       CACHE_LINE_SIZE) %
+                      CACHE_LINE_SIZE) / size_type(sizeof(value_type))
+        };
+
+        chunk_size = ((chunk_size + line - 1) / line) * line;
+        return (reduce_chunks_(
+                    n, chunk_size, head,
+                    std::move(init),
+                    sum_op,
+                    [a, b](size_type first, size_type last) -> T  {
+                        return (T(simd_dot(a + first, b + first,
+                                           std::size_t(last - first))));
+                    }));
+    }
+    else  {
+        return (reduce_chunks_(
+                    n, chunk_size, 0,
+                    std::move(init),
+                    sum_op,
+                    [&](size_type first, size_type last) -> T  {
+                        return (std::inner_product(
+                                    begin1 + (first + 1),
+                                    begin1 + last,
+                                    begin2 + (first + 1),
+                                    T(std::invoke(product_op,
+                                                  *(begin1 + first),
+                                                  *(begin2 + first))),
+                                    sum_op,
+                                    product_op));
+                    }));
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename T, typename BOP, typename F>
+T ThreadPool::reduce_chunks_(size_type n,
+                             size_type chunk_size,
+                             size_type head,
+                             T init,
+                             BOP &reduce_op,
+                             const F &fold)  {
+
+    const size_type workers { capacity_threads() + 1 };  // And the caller
+    const size_type chunk_count {
+        std::max((n - head + chunk_size - 1) / chunk_size, size_type(1))
+    };
+    const size_type slot_count { std::min(workers, chunk_count) };
+
+    if (slot_count == 1)
+        return (reduce_op(std::move(init), fold(size_type(0), n)));
+
+    // A partial result per worker, each in its own cache line
+    //
+    struct  alignas(CACHE_LINE_SIZE) Slot  {
+
+        std::optional<T>    value { };
+    };
+
+    std::vector<Slot>       slots (slot_count);
+    std::atomic<size_type>  next_chunk { 0 };
+    const auto              fold_chunks =
+        [&](size_type slot) -> void  {
+            std::optional<T>    &value { slots[slot].value };
+
+            try  {
+                for (size_type c =
+                         next_chunk.fetch_add(1, std::memory_order_relaxed);
+                     c < chunk_count;
+                     c = next_chunk.fetch_add(1, std::memory_order_relaxed))
+                {
+                    const size_type first {
+                        c == 0 ? size_type(0) : c * chunk_size + head
+                    };
+                    const size_type last {
+                        std::min((c + 1) * chunk_size + head, n)
+                    };
+                    T               partial = fold(first, last);
+
+                    if (value.has_value())
+                        value =
+                            reduce_op(std::move(*value), std::move(partial));
+                    else
+                        value.emplace(std::move(partial));
+                }
+            }
+            catch (...)  {  // Nobody needs the rest of the chunks
+                next_chunk.store(chunk_count, std::memory_order_relaxed);
+                throw;
+            }
+        };
+
+    run_workers_(slot_count, fold_chunks);
+
+    // Tree combine of the slots
+    //
+    for (size_type stride = 1; stride < slot_count; stride *= 2)
+        for (size_type s = 0; s + stride < slot_count; s += stride * 2)
+            if (slots[s + stride].value.has_value())  {
+                if (slots[s].value.has_value())
+                    slots[s].value =
+                        reduce_op(std::move(*slots[s].value),
+                                  std::move(*slots[s + stride].value));
+                else
+                    slots[s].value = std::move(slots[s + stride].value);
+            }
+
+    if (slots[0].value.has_value())
+        return (reduce_op(std::move(init), std::move(*slots[0].value)));
+    return (init);
+}
+
+// ----------------------------------------------------------------------------
+
+template<std::random_access_iterator I, std::random_access_iterator O,
+         typename BOP, typename UOP, long TH>
+O ThreadPool::parallel_inclusive_scan(I begin, I end, O out,
+                                      BOP op,
+                                      UOP transform)  {
+
+    using value_type =
+        std::decay_t<std::invoke_result_t<UOP &, std::iter_reference_t<I>>>;
+
+    return (scan_<TH>(begin, end, out,
+                      std::optional<value_type> { },
+                      op,
+                      transform));
+}
+
+// ----------------------------------------------------------------------------
+
+template<std::random_access_iterator I, std::random_access_iterator O,
+         typename T, typename BOP, typename UOP, long TH>
+O ThreadPool::parallel_exclusive_scan(I begin, I end, O out,
+                                      T init,
+                                      BOP op,
+                                      UOP transform)  {
+
+    return (scan_<TH>(begin, end, out,
+                      std::optional<T> { std::move(init) },
+                      op,
+                      transform));
+}
+
+// ----------------------------------------------------------------------------
+
+template<long TH, typename I, typename O, typename T,
+         typename BOP, typename UOP>
+O ThreadPool::scan_(I begin, I end, O out,
+                    std::optional<T> &&init,
+                    BOP &op,
+                    UOP &transform)  {
+
+    const size_type n = std::distance(begin, end);
+    const bool      exclusive = init.has_value();
+
+    if (n <= 0)  return (out);
+
+    const size_type block_target {
+        std::min(capacity_threads() + 1, n / size_type(std::max(TH, 1L)))
+    };
+
+    if (block_target < 2)  {
+        if (exclusive)
+            return (std::transform_exclusive_scan(begin, end, out,
+                                                  std::move(*init),
+                                                  op, transform));
+        return (std::transform_inclusive_scan(begin, end, out,
+                                              op, transform));
+    }
+
+    // carries[b] is what block b starts from. The first block of an
+    // inclusive scan starts from nothing.
+    //
+    const size_type                 block_size {
+        (n + block_target - 1) / block_target
+    };
+    const size_type                 blocks {
+        (n + block_size - 1) / block_size
+    };
+    std::vector<std::optional<T>>   carries (blocks);
+
+    run_workers_(blocks - 1,  // The sum of the last block isn't needed
+                 [&](size_type block) -> void  {
+                     const size_type    first { block * block_size };
+                     const size_type    last { first + block_size };
+                     T                  sum =
+                         std::invoke(transform, *(begin + first));
+
+                     for (size_type i = first + 1; i < last; ++i)
+                         sum = std::invoke(op,
+                                           std::move(sum),
+                                           std::invoke(transform,
+                                                       *(begin + i)));
+                     carries[block + 1].emplace(std::move(sum));
+                 });
+
+    carries[0] = std::move(init);
+    for (size_type b = 1; b < blocks; ++b)
+        if (carries[b - 1].has_value())
+            carries[b] = std::invoke(op,
+                                     *carries[b - 1],
+                                     std::move(*carries[b]));
+
+    run_workers_(blocks,
+                 [&](size_type block) -> void  {
+                     const size_type    first { block * block_size };
+                     const size_type    last {
+                         std::min(first + block_size, n)
+                     };
+
+                     if (exclusive)
+                         std::transform_exclusive_scan(begin + first,
+                                                       begin + last,
+                                                       out + first,
+                                                       *carries[block],
+                                                       op, transform);
+                     else if (carries[block].has_value())
+                         std::transform_inclusive_scan(begin + first,
+                                                       begin + last,
+                                                       out + first,
+                                                       op, transform,
+                                                       *carries[block]);
+                     else
+                         std::transform_inclusive_scan(begin + first,
+                                                       begin + last,
+                                                       out + first,
+                                                       op, transform);
+                 });
+    return (out + n);
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename F>
+void ThreadPool::run_workers_(size_type count, const F &routine)  {
+
+    // The workers use the caller's stack. So, the group must be waited for,
+    // even if the caller's share throws. Its wait() runs the workers that
+    // haven't started yet here.
+    //
+    std::exception_ptr  ex_ptr { };
+
+    {
+        TaskGroup   group { make_group() };
+
+        for (size_type w = 1; w < count; ++w)
+            group.run(routine, w);
+        try  {
+            routine(size_type(0));
+        }
+        catch (...)  {
+            ex_ptr = std::current_exception();
+        }
+        try  {
+            group.wait();
+        }
+        catch (...)  {
+            if (! ex_ptr)  ex_ptr = std::current_exception();
+        }
+    }
+    if (ex_ptr)  std::rethrow_exception(ex_ptr);
+}
+
+// ----------------------------------------------------------------------------
+
+inline TaskGroup ThreadPool::make_group()  { return (TaskGroup { *this }); }
+
+// ----------------------------------------------------------------------------
+
+inline TaskGroup ThreadPool::make_group(CancellationToken token)  {
+
+    return (TaskGroup { *this, std::move(token) });
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename F, typename ... As>
+requires std::invocable<F, As ...>
+ThreadPool::task_future_t<F, As ...>
+ThreadPool::async(F &&routine, As && ... args)  {
+
+    if (is_shutdown() || capacity_threads() == 0)
+        throw std::runtime_error("ThreadPool::async(): "
+                                 "Thread-pool has 0 thread capacity.");
+
+    using future_t = task_future_t<F, As ...>;
+    using state_t = typename future_t::State;
+
+    auto    state =
+        std::allocate_shared<state_t>(RecyclingAllocator<state_t> { }, *this);
+
+    enqueue_(
+        WorkUnit {
+            WORK_TYPE::_client_service_,
+            [state,
+             routine = std::forward<F>(routine),
+             ... args = std::forward<As>(args)]() mutable -> void  {
+                future_t::fulfill_(state->promise,
+                                   routine,
+                                   unwrap_ref_(args) ...);
+                state->finish();
+            }
+        });
+    return (future_t { std::move(state) });
+}
+
+// ----------------------------------------------------------------------------
+
+inline void ThreadPool::run_graph(TaskGraph &graph)  {
+
+    if (graph.empty())  return;
+    if (! graph.is_acyclic_())
+        throw std::runtime_error("ThreadPool::run_graph(): "
+                                 "The graph has a cycle.");
+
+    // Predecessors of each node that haven't finished yet
+    //
+    using count_t = std::atomic<TaskGraph::size_type>;
+
+    const TaskGraph::size_type          n { graph.nodes() };
+    const std::unique_ptr<count_t[]>    remaining { new count_t[n] };
+
+    for (TaskGraph::size_type i = 0; i < n; ++i)
+        remaining[i].store(graph.nodes_[i].in_degree,
+                           std::memory_order_relaxed);
+
+    TaskGroup   group { make_group() };
+
+    for (TaskGraph::node_type i = 0; i < n; ++i)
+        if (graph.nodes_[i].in_degree == 0)
+            group.run(&ThreadPool::run_graph_node_,
+                      std::ref(graph),
+                      remaining.get(),
+                      std::ref(group),
+                      i);
+    group.wait();
+}
+
+// ----------------------------------------------------------------------------
+
+template<std::random_access_iterator I, typename F,
+         typename K, typename V, typename BOP, typename H, typename KE>
+requires std::invocable<F &, std::iter_reference_t<I>,
+                        typename MapReduce<K, V, BOP, H, KE>::Emitter &>
+void ThreadPool::run_map_reduce(MapReduce<K, V, BOP, H, KE> &engine,
+                                I begin, I end,
+                                F map_func)  {
+
+    using emitter_t = typename MapReduce<K, V, BOP, H, KE>::Emitter;
+
+    const size_type n = std::distance(begin, end);
+    const size_type workers { capacity_threads() + 1 };  // And the caller
+
+    engine.prepare_(workers);
+    if (n <= 0)  return;
+
+    try  {
+        // Map. Workers take chunks of the items, emit into their own
+        // combiners, and split them into partitions at the end.
+        //
+        const size_type         chunk_size {
+            std::max(n / (workers * 8), size_type(1))
+        };
+        const size_type         chunk_count {
+            (n + chunk_size - 1) / chunk_size
+        };
+        std::atomic<size_type>  next_chunk { 0 };
+        const auto              map_chunks =
+            [&](size_type worker) -> void  {
+                emitter_t   emitter {
+                    engine, engine.locals_[worker].combined
+                };
+
+                try  {
+                    for (size_type c =
+                             next_chunk.fetch_add(1,
+                                                  std::memory_order_relaxed);
+                         c < chunk_count;
+                         c = next_chunk.fetch_add(1,
+                                                  std::memory_order_relaxed))
+                    {
+                        const I last {
+                            begin + std::min((c + 1) * chunk_size, n)
+                        };
+
+                        for (I iter = begin + c * chunk_size;
+                             iter != last; ++iter)
+                            map_func(*iter, emitter);
+                    }
+                }
+                catch (...)  {  // Nobody needs the rest of the chunks
+                    next_chunk.store(chunk_count, std::memory_order_relaxed);
+                    throw;
+                }
+                engine.split_(worker);
+            };
+
+        run_workers_(std::min(workers, chunk_count), map_chunks);
+
+        // Reduce. Workers take whole partitions, so they never touch the
+        // same keys.
+        //
+        const size_type         partition_count {
+            size_type(engine.partitions())
+        };
+        std::atomic<size_type>  next_partition { 0 };
+        const auto              reduce_partitions =
+            [&](size_type) -> void  {
+                for (size_type p =
+                         next_partition.fetch_add(1,
+                                                  std::memory_order_relaxed);
+                     p < partition_count;
+                     p = next_partition.fetch_add(1,
+                                                  std::memory_order_relaxed))
+                    engine.reduce_partition_(p);
+            };
+
+        run_workers_(std::min(workers, partition_count), reduce_partitions);
+    }
+    catch (...)  {
+        engine.clear();
+        throw;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+inline ThreadPool::ScheduleAwaiter
+ThreadPool::schedule(TASK_PRIORITY priority) noexcept  {
+
+    return (ScheduleAwaiter { *this, priority });
+}
+
+// ----------------------------------------------------------------------------
+
+inline void
+ThreadPool::ScheduleAwaiter::await_suspend(std::coroutine_handle<> awaiting)  {
+
+    if (pool_.is_shutdown() || pool_.capacity_threads() == 0)
+        throw std::runtime_error("ThreadPool::schedule(): "
+                                 "Thread-pool has 0 thread capacity.");
+
+    WorkUnit    work_unit {
+        WORK_TYPE::_client_service_,
+        [awaiting]() -> void  { awaiting.resume(); }
+    };
+
+    work_unit.priority = priority_;
+    pool_.enqueue_(std::move(work_unit));
+}
+
+// ----------------------------------------------------------------------------
+
+inline void
+ThreadPool::run_graph_node_(TaskGraph &graph,
+                            std::atomic<TaskGraph::size_type> *remaining,
+                            TaskGroup &group,
+                            TaskGraph::node_type node)  {
+
+    constexpr TaskGraph::node_type  none {
+        std::numeric_limits<TaskGraph::node_type>::max()
+    };
+
+    while (node != none)  {
+        TaskGraph::Node         &current { graph.nodes_[node] };
+        TaskGraph::node_type    next { none };
+
+        current.task();  // If it throws, successors are never ready
+
+        // Whoever finishes the last predecessor of a node runs it
+        //
+        for (const TaskGraph::node_type succ : current.successors)
+            if (remaining[succ].fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                if (next == none)
+                    next = succ;
+                else
+                    group.run(&ThreadPool::run_graph_node_,
+                              std::ref(graph),
+                              remaining,
+                              std::ref(group),
+                              succ);
+            }
+        node = next;
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+void
+ThreadPool::attach(thread_type &&this_thr)  {
+
+    if (is_shutdown())
+        throw std::runtime_error("ThreadPool::attach(): "
+                                 "Thread pool is shutdown.");
+
+    LocalQueue  *local_q { nullptr };
+
+    {
+        const guard_type    guard { state_ };
+
+        local_q = acquire_local_queue_();
+        threads_.push_back(std::move(this_thr));
+    }
+    thread_routine_(local_q);
+}
+
+// ----------------------------------------------------------------------------
+
+inline ThreadPool::size_type
+ThreadPool::available_threads() const noexcept  {
+
+    return (available_threads_.load(std::memory_order_relaxed));
+}
+
+// ----------------------------------------------------------------------------
+
+inline ThreadPool::size_type
+ThreadPool::capacity_threads() const noexcept  {
+
+    return (capacity_threads_.load(std::memory_order_relaxed));
+}
+
+// ----------------------------------------------------------------------------
+
+inline bool
+ThreadPool::is_shutdown() const noexcept  {
+
+    return (shutdown_flag_.load(std::memory_order_relaxed));
+}
+
+// ----------------------------------------------------------------------------
+
+inline ThreadPool::size_type
+ThreadPool::pending_tasks() const noexcept  {
+
+    size_type   ret { 0 };
+
+    for (const auto &node_q : node_queues_)
+        for (const GlobalQueueType &lane : node_q->tasks)
+            ret += lane.size();
+    return (ret);
+}
+
+// ----------------------------------------------------------------------------
+
+inline ThreadPool::size_type
+ThreadPool::node_count() const noexcept  {
+
+    return (size_type(node_queues_.size()));
+}
+
+// ----------------------------------------------------------------------------
+
+inline ThreadPool::size_type
+ThreadPool::pending_timers() const noexcept  {
+
+    return (size_type(timer_count_.load(std::memory_order_relaxed)));
+}
+
+// ----------------------------------------------------------------------------
+
+inline bool ThreadPool::cancel_timer(TimerId id) noexcept  {
+
+    std::optional<TimerTask>    timer { };
+
+    {
+        const guard_type    guard { timer_mutex_ };
+
+        timer = timer_wheel_.cancel(id.value);
+        timer_next_due_.store(timer_wheel_.next_due());
+        timer_count_.store(timer_wheel_.size());
+    }
+    if (! timer.has_value())  return (false);
+
+    cancel_timer_task_(*timer);
+    return (true);
+}
+
+// ----------------------------------------------------------------------------
+
+inline bool
+ThreadPool::shutdown() noexcept  {
+
+    bool    expected { false };
+
+    if (shutdown_flag_.compare_exchange_strong(expected, true,
+                                               std::memory_order_relaxed,
+                                               std::memory_order_relaxed))  {
+        const size_type capacity { capacity_threads() + 10 };
+
+        for (const auto &node_q : node_queues_)  {
+            for (size_type i = 0; i < capacity; ++i)
+                node_q->tasks[NORMAL_LANE].push(
+                    WorkUnit { WORK_TYPE::_terminate_ });
+            node_q->parking.notify_all();
+        }
+
+        // Timers that haven't fired never will
+        //
+        const guard_type    guard { timer_mutex_ };
+
+        timer_wheel_.drain([](TimerTask &&timer) -> void  {
+            cancel_timer_task_(timer);
+        });
+        timer_next_due_.store(TimerWheelType::NEVER);
+        timer_count_.store(0);
+    }
+
+    return (true);
+}
+
+// ----------------------------------------------------------------------------
+
+inline std::vector<WorkerStats>
+ThreadPool::worker_stats() const  {
+
+    std::vector<WorkerStats>    ret;
+    const guard_type            guard { state_ };
+
+    ret.reserve(local_queues_.size());
+    for (const LocalQueue &q : local_queues_)
+        ret.push_back(
+            WorkerStats {
+                q.executed.load(std::memory_order_relaxed),
+                q.steals.load(std::memory_order_relaxed),
+                q.stolen.load(std::memory_order_relaxed),
+                q.stolen_from.load(std::memory_order_relaxed) });
+    return (ret);
+}
+
+// ----------------------------------------------------------------------------
+
+inline QueueWaitStats
+ThreadPool::queue_wait_stats(TASK_PRIORITY priority) const  {
+
+    QueueWaitStats      ret { };
+    const std::size_t   lane { std::size_t(priority) };
+    const guard_type    guard { state_ };
+
+    for (const LocalQueue &q : local_queues_)  {
+        const WaitCounters  &waits { q.waits[lane] };
+
+        ret.count += waits.count.load(std::memory_order_relaxed);
+        ret.total_ns += waits.total_ns.load(std::memory_order_relaxed);
+        ret.max_ns =
+            std::max(ret.max_ns, waits.max_ns.load(std::memory_order_relaxed));
+        for (std::size_t i = 0; i < QueueWaitStats::BUCKETS; ++i)
+            ret.histogram[i] +=
+                waits.histogram[i].load(std::memory_order_relaxed);
+    }
+    return (ret);
+}
+
+// ----------------------------------------------------------------------------
+
+inline void
+ThreadPool::set_exception_handler(exception_handler_type handler)  {
+
+    const guard_type    guard { state_ };
+
+    exception_handler_ = std::move(handler);
+}
+
+// ----------------------------------------------------------------------------
+
+inline ThreadPool::LocalQueue *
+ThreadPool::acquire_local_queue_()  {
+
+    LocalQueue  *local_q { nullptr };
+
+    if (! free_local_queues_.empty())  {
+        local_q = free_local_queues_.back();
+        free_local_queues_.pop_back();
+    }
+    else  {
+        const StealList *current {
+            steal_list_.load(std::memory_order_relaxed)
+        };
+        StealList       new_list { };
+
+        if (current)  new_list = *current;
+        local_q = &(local_queues_.emplace_back());
+
+        // The thread of the n'th queue runs on the n'th planned CPU
+        //
+        if (! cpu_plan_.empty())  {
+            const CpuInfo   &cpu {
+                cpu_plan_[(local_queues_.size() - 1) % cpu_plan_.size()]
+            };
+
+            local_q->cpu = int(cpu.id);
+            local_q->node = std::size_t(cpu_to_node_[cpu.id]);
+            local_q->l3 = cpu.l3;
+        }
+        new_list.push_back(local_q);
+        steal_lists_.push_back(std::move(new_list));
+        steal_list_.store(&(steal_lists_.back()), std::memory_order_release);
+    }
+    return (local_q);
+}
+
+// ----------------------------------------------------------------------------
+
+inline void
+ThreadPool::release_local_queue_(LocalQueue *local_q) noexcept  {
+
+    free_local_queues_.push_back(local_q);
+}
+
+// ----------------------------------------------------------------------------
+
+inline void ThreadPool::init_nodes_(const PoolOptions &options)  {
+
+    if (options.affinity != THREAD_AFFINITY::_none_)  {
+        const Topology  &topology {
+            options.topology ? *options.topology : Topology::system()
+        };
+
+        if (options.affinity == THREAD_AFFINITY::_spread_)
+            cpu_plan_ = topology.spread_order();
+        else if (options.cpu_set.empty())
+            cpu_plan_ = topology.cpus();
+        else
+            for (const unsigned int id : options.cpu_set)  {
+                const CpuInfo   *cpu { topology.find(id) };
+
+                if (! cpu)  {
+                    char    err[1024];
+
+                    ::snprintf(err, sizeof(err) - 1,
+                               "ThreadPool::ThreadPool(): "
+                               "CPU '%u' is not online", id);
+                    throw std::runtime_error(err);
+                }
+                cpu_plan_.push_back(*cpu);
+            }
+
+        // Number the nodes that have threads on them 0, 1, ...
+        //
+        std::vector<int>    node_index;
+
+        for (const CpuInfo &cpu : cpu_plan_)  {
+            if (cpu.node >= node_index.size())
+                node_index.resize(cpu.node + 1, -1);
+            node_index[cpu.node] = 0;
+        }
+
+        int node_count { 0 };
+
+        for (int &index : node_index)
+            if (index == 0)  index = node_count++;
+
+        for (const CpuInfo &cpu : topology.cpus())  {
+            if (cpu.id >= cpu_to_node_.size())
+                cpu_to_node_.resize(cpu.id + 1, -1);
+            if (cpu.node < node_index.size())
+                cpu_to_node_[cpu.id] = node_index[cpu.node];
+        }
+    }
+
+    int node_count { 1 };
+
+    for (const int node : cpu_to_node_)
+        node_count = std::max(node_count, node + 1);
+    for (int i = 0; i < node_count; ++i)
+        node_queues_.push_back(
+            std::make_unique<NodeQueue>(options.global_queue_capacity));
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename F, typename ... As>
+ThreadPool::dispatch_res_t<F, As ...>
+ThreadPool::make_task_(WorkUnit &work_unit, F &&routine, As && ... args)  {
+
+    using task_return_t =
+        std::invoke_result_t<std::decay_t<F>, std::decay_t<As> ...>;
+    using future_t = dispatch_res_t<F, As ...>;
+
+    // The promise shared state comes from the recycling allocator and the
+    // task is stored inside the WorkUnit. So, in the steady state dispatching
+    // doesn't touch the global allocator.
+    //
+    std::promise<task_return_t> promise {
+        std::allocator_arg, RecyclingAllocator<task_return_t> { }
+    };
+    future_t                    return_fut { promise.get_future() };
+
+    work_unit = WorkUnit {
+        WORK_TYPE::_client_service_,
+        [promise = std::move(promise),
+         routine = std::forward<F>(routine),
+         ... args = std::forward<As>(args)]() mutable -> void  {
+            try  {
+                if constexpr (std::is_void_v<task_return_t>)  {
+                    std::invoke(routine, unwrap_ref_(args) ...);
+                    promise.set_value();
+                }
+                else
+                    promise.set_value(
+                        std::invoke(routine, unwrap_ref_(args) ...));
+            }
+            catch (...)  {
+                promise.set_exception(std::current_exception());
+            }
+        }
+    };
+    return (return_fut);
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename F, typename ... As>
+ThreadPool::dispatch_res_t<F, As ...>
+ThreadPool::make_cancellable_task_(WorkUnit &work_unit,
+                                   CancellationToken token,
+                                   F &&routine,
+                                   As && ... args)  {
+
+    using task_return_t =
+        std::invoke_result_t<std::decay_t<F>, std::decay_t<As> ...>;
+    using future_t = dispatch_res_t<F, As ...>;
+
+    std::promise<task_return_t> promise {
+        std::allocator_arg, RecyclingAllocator<task_return_t> { }
+    };
+    future_t                    return_fut { promise.get_future() };
+
+    work_unit = WorkUnit {
+        WORK_TYPE::_client_service_,
+        [promise = std::move(promise),
+         token = std::move(token),
+         routine = std::forward<F>(routine),
+         ... args = std::forward<As>(args)]() mutable -> void  {
+            try  {
+                token.throw_if_cancelled();
+                if constexpr (std::is_void_v<task_return_t>)  {
+                    std::invoke(routine, unwrap_ref_(args) ...);
+                    promise.set_value();
+                }
+                else
+                    promise.set_value(
+                        std::invoke(routine, unwrap_ref_(args) ...));
+            }
+            catch (...)  {
+                promise.set_exception(std::current_exception());
+            }
+        }
+    };
+    return (return_fut);
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename F, typename ... As>
+ThreadPool::WorkUnit
+ThreadPool::make_post_task_(F &&routine, As && ... args)  {
+
+    return (WorkUnit {
+        WORK_TYPE::_client_service_,
+        [this,
+         routine = std::forward<F>(routine),
+         ... args = std::forward<As>(args)]() mutable -> void  {
+            try  {
+                std::invoke(routine, unwrap_ref_(args) ...);
+            }
+            catch (...)  {
+                handle_exception_(std::current_exception());
+            }
+        }
+    });
+}
+
+// ----------------------------------------------------------------------------
+
+inline void ThreadPool::enqueue_(WorkUnit &&work_unit)  {
+
+    const std::size_t   node { caller_node_() };
+    const std::size_t   lane { std::size_t(work_unit.priority) };
+
+    if (lane != NORMAL_LANE)
+        lane_pending_[lane].value.fetch_add(1, std::memory_order_relaxed);
+    if (track_queue_wait_)  work_unit.enqueued_ns = now_ns_();
+
+    // If this is one of our pool threads, push it to its local queue.
+    // If the local queue is full, it goes to the global queue.
+    //
+    if (local_pool_ != this ||
+        ! local_queue_->tasks[lane].push(std::move(work_unit)))
+        node_queues_[node]->tasks[lane].push(std::move(work_unit));
+    wake_(node, 1);
+}
+
+// ----------------------------------------------------------------------------
+
+inline void
+ThreadPool::enqueue_bulk_(std::vector<WorkUnit> &work_units,
+                          bool split_by_node)  {
+
+    const std::size_t   node_count { node_queues_.size() };
+    const std::size_t   n { work_units.size() };
+
+    if (track_queue_wait_)  {
+        const std::uint64_t now { now_ns_() };
+
+        for (WorkUnit &work_unit : work_units)
+            work_unit.enqueued_ns = now;
+    }
+    if (! split_by_node || node_count == 1)  {
+        const std::size_t   node { caller_node_() };
+
+        node_queues_[node]->tasks[NORMAL_LANE].push_bulk(work_units.begin(),
+                                                         work_units.end());
+        wake_(node, n);
+        return;
+    }
+
+    // Node i gets the i'th contiguous slice
+    //
+    for (std::size_t node = 0; node < node_count; ++node)  {
+        const std::size_t   first { n * node / node_count };
+        const std::size_t   last { n * (node + 1) / node_count };
+
+        if (first == last)  continue;
+        node_queues_[node]->tasks[NORMAL_LANE].push_bulk(
+            work_units.begin() + first, work_units.begin() + last);
+        wake_(node, last - first);
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+inline void ThreadPool::enqueue_continuation_(routine_type &&routine)  {
+
+    if (is_shutdown())  {  // Nobody would run it
+        routine();
+        return;
+    }
+
+    auto    cont =
+        std::allocate_shared<Continuation>(RecyclingAllocator<Continuation> { },
+                                           std::move(routine));
+
+    enqueue_(WorkUnit {
+        WORK_TYPE::_client_service_,
+        [cont]() -> void  { cont->run(); }
+    });
+
+    // shutdown() may have put the terminates ahead of it. The queue orders
+    // our push after theirs, so we see the flag then.
+    //
+    if (is_shutdown())  cont->run();
+}
+
+// ----------------------------------------------------------------------------
+
+inline std::size_t ThreadPool::caller_node_() const noexcept  {
+
+    if (node_queues_.size() == 1)  return (0);
+    if (local_pool_ == this)  return (local_queue_->node);
+
+    const int   cpu { Topology::current_cpu() };
+
+    if (cpu >= 0 && std::size_t(cpu) < cpu_to_node_.size() &&
+        cpu_to_node_[cpu] >= 0)
+        return (std::size_t(cpu_to_node_[cpu]));
+    return (std::size_t(next_random_() % node_queues_.size()));
+}
+
+// ----------------------------------------------------------------------------
+
+inline void ThreadPool::wake_(std::size_t node, std::size_t n) noexcept  {
+
+    const std::size_t   node_count { node_queues_.size() };
+
+    // If nobody is parked on the node, somebody elsewhere must run them
+    //
+    for (std::size_t i = 0; i < node_count && n > 0; ++i, ++node)  {
+        if (node == node_count)  node = 0;
+        n -= node_queues_[node]->parking.notify(n);
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+inline void
+ThreadPool::handle_exception_(std::exception_ptr ex_ptr) noexcept  {
+
+    try  {
+        exception_handler_type  handler { };
+
+        {
+            const guard_type    guard { state_ };
+
+            handler = exception_handler_;
+        }
+        if (handler)  handler(ex_ptr);
+    }
+    catch (...)  {   }  // Nowhere else to send it
+}
+
+// ----------------------------------------------------------------------------
+
+inline std::uint64_t ThreadPool::next_random_() noexcept  {
+
+    if (random_state_ == 0)  {  // Seed it once per thread
+        random_state_ =
+            std::hash<std::thread::id> { }(std::this_thread::get_id()) |
+            std::uint64_t(1);
+    }
+    random_state_ ^= random_state_ >> 12;
+    random_state_ ^= random_state_ << 25;
+    random_state_ ^= random_state_ >> 27;
+    return (random_state_ * 0x2545F4914F6CDD1DULL);
+}
+
+// ----------------------------------------------------------------------------
+
+inline void
+ThreadPool::add_to_(std::atomic<std::size_t> &counter,
+                    std::size_t n) noexcept  {
+
+    counter.store(counter.load(std::memory_order_relaxed) + n,
+                  std::memory_order_relaxed);
+}
+
+// ----------------------------------------------------------------------------
+
+inline ThreadPool::WorkUnit
+ThreadPool::get_one_local_task_(std::size_t lane) noexcept  {
+
+    WorkUnit    work_unit;
+
+    // Our own queue in LIFO order first
+    //
+    if (local_pool_ == this && local_queue_->tasks[lane].pop(work_unit))
+        return (work_unit);
+
+    // Then the nearest victims. Other nodes come after our node's global
+    // queue (see next_task_()).
+    //
+    if (! steal_(work_unit, LOCALITY::_same_l3_, lane) &&
+        ! cpu_plan_.empty())
+        steal_(work_unit, LOCALITY::_same_node_, lane);
+    return (work_unit);
+}
+
+// ----------------------------------------------------------------------------
+
+inline bool
+ThreadPool::steal_(WorkUnit &work_unit,
+                   LOCALITY locality,
+                   std::size_t lane) noexcept  {
+
+    // Try to steal tasks from other queues in FIFO order.
+    // Start from a random victim, so thieves spread out evenly instead of
+    // all going after the first few queues.
+    //
+    const StealList *victims { steal_list_.load(std::memory_order_acquire) };
+
+    if (! victims || victims->empty())  return (false);
+
+    const bool          is_ours { local_pool_ == this };
+    const bool          by_distance { is_ours && ! cpu_plan_.empty() };
+    const std::size_t   victim_count { victims->size() };
+    std::size_t         idx { std::size_t(next_random_() % victim_count) };
+
+    // Without a known distance, all victims count as the nearest ones
+    //
+    if (! by_distance && locality != LOCALITY::_same_l3_)  return (false);
+
+    for (std::size_t i = 0; i < victim_count; ++i, ++idx)  {
+        if (idx == victim_count)  idx = 0;
+
+        LocalQueue  *victim { (*victims)[idx] };
+
+        if (victim == local_queue_)  continue;
+        if (by_distance)  {
+            const LOCALITY  distance {
+                victim->node != local_queue_->node
+                    ? LOCALITY::_other_node_
+                    : victim->l3 != local_queue_->l3
+                        ? LOCALITY::_same_node_
+                        : LOCALITY::_same_l3_
+            };
+
+            if (distance != locality)  continue;
+        }
+        if (! victim->tasks[lane].steal(work_unit))  continue;
+
+        std::size_t count { 1 };
+
+        // Take up to half of the rest into our own queue
+        //
+        if (is_ours && steal_half_)  {
+            const std::size_t   more { victim->tasks[lane].size() / 2 };
+
+            for (std::size_t j = 0; j < more; ++j, ++count)  {
+                WorkUnit    extra;
+
+                if (! victim->tasks[lane].steal(extra))  break;
+                if (! local_queue_->tasks[lane].push(std::move(extra)))
+                    node_queues_[local_queue_->node]->tasks[lane].push(
+                        std::move(extra));
+            }
+        }
+
+        victim->stolen_from.fetch_add(count, std::memory_order_relaxed);
+        if (is_ours)  {
+            add_to_(local_queue_->steals, 1);
+            add_to_(local_queue_->stolen, count);
+        }
+        return (true);
+    }
+    return (false);
+}
+
+// ----------------------------------------------------------------------------
+
+inline void ThreadPool::execute_(WorkUnit &work_unit) noexcept  {
+
+    if (local_pool_ == this)  {
+        add_to_(local_queue_->executed, 1);
+        if (track_queue_wait_)  record_wait_(work_unit);
+    }
+    (work_unit.func)();  // Execute the callable
+}
+
+// ----------------------------------------------------------------------------
+
+inline void ThreadPool::record_wait_(const WorkUnit &work_unit) noexcept  {
+
+    const std::uint64_t now { now_ns_() };
+    const std::uint64_t wait {
+        now > work_unit.enqueued_ns ? now - work_unit.enqueued_ns : 0
+    };
+    WaitCounters        &waits {
+        local_queue_->waits[std::size_t(work_unit.priority)]
+    };
+    const std::size_t   bucket {
+        std::min(std::size_t(std::bit_width(wait)),
+                 QueueWaitStats::BUCKETS - 1)
+    };
 
-    return (capacity_threads_.load(std::memory_order_relaxed));
+    add_to_(waits.count, 1);
+    waits.total_ns.store(waits.total_ns.load(std::memory_order_relaxed) + wait,
+                         std::memory_order_relaxed);
+    if (wait > waits.max_ns.load(std::memory_order_relaxed))
+        waits.max_ns.store(wait, std::memory_order_relaxed);
+    add_to_(waits.histogram[bucket], 1);
 }
 
 // ----------------------------------------------------------------------------
 
-inline bool
-ThreadPool::is_shutdown() const noexcept  {
+inline std::uint64_t ThreadPool::now_ns_() noexcept  {
 
-    return (shutdown_flag_.load(std::memory_order_relaxed));
+    using namespace std::chrono;
+
+    return (std::uint64_t(duration_cast<nanoseconds>(
+        steady_clock::now().time_since_epoch()).count()));
 }
 
 // ----------------------------------------------------------------------------
 
-inline ThreadPool::size_type
-ThreadPool::pending_tasks() const noexcept  {
+inline ThreadPool::tick_type ThreadPool::current_tick_() const noexcept  {
 
-    return (global_queue_.size());
+    return (tick_type((std::chrono::steady_clock::now() - timer_epoch_) /
+                      timer_tick_));
 }
 
 // ----------------------------------------------------------------------------
 
-inline bool
-ThreadPool::shutdown() noexcept  {
+template<typename C, typename D>
+ThreadPool::tick_type
+ThreadPool::due_tick_(const std::chrono::time_point<C, D> &when) const  {
 
-    bool    expected { false };
+    using namespace std::chrono;
 
-    if (shutdown_flag_.compare_exchange_strong(expected, true,
-                                               std::memory_order_relaxed,
-                                               std::memory_order_relaxed))  {
-        const size_type capacity { capacity_threads() + 10 };
+    nanoseconds since { };
 
-        for (size_type i = 0; i < capacity; ++i)  {
-            const WorkUnit  work_unit { WORK_TYPE::_terminate_ };
+    if constexpr (std::is_same_v<C, steady_clock>)
+        since = ceil<nanoseconds>(when - timer_epoch_);
+    else  // From another clock, as of now
+        since = ceil<nanoseconds>(when - C::now()) +
+                (steady_clock::now() - timer_epoch_);
 
-            global_queue_.push(work_unit);
+    if (since.count() <= 0)  return (0);
+    return (tick_type((since + timer_tick_ - nanoseconds(1)) / timer_tick_));
+}
+
+// ----------------------------------------------------------------------------
+
+inline std::chrono::steady_clock::time_point
+ThreadPool::tick_time_(tick_type tick) const noexcept  {
+
+    return (timer_epoch_ + timer_tick_ * tick);
+}
+
+// ----------------------------------------------------------------------------
+
+inline TimerId
+ThreadPool::add_timer_(tick_type due, tick_type period, TimerTask &&timer)  {
+
+    TimerId     id { };
+    tick_type   old_due { 0 };
+    tick_type   new_due { 0 };
+
+    {
+        const guard_type    guard { timer_mutex_ };
+
+        // The wheel was drained. The timer would never fire.
+        //
+        if (is_shutdown())  {
+            cancel_timer_task_(timer);
+            return (id);
         }
+
+        id.value = timer_wheel_.insert(due, std::move(timer), period);
+        old_due = timer_next_due_.load();
+        new_due = timer_wheel_.next_due();
+        timer_next_due_.store(new_due);
+        timer_count_.store(timer_wheel_.size());
     }
 
-    return (true);
+    // The keeper may be sleeping past it. Otherwise, a parked thread must
+    // become the keeper.
+    //
+    if (new_due < old_due)  {
+        const std::size_t   keeper { timer_keeper_.load() };
+
+        if (keeper != 0)
+            node_queues_[keeper - 1]->parking.notify_all();
+        else
+            wake_(caller_node_(), 1);
+    }
+    return (id);
+}
+
+// ----------------------------------------------------------------------------
+
+inline void ThreadPool::service_timers_() noexcept  {
+
+    if (timer_count_.load(std::memory_order_relaxed) == 0)  return;
+
+    const tick_type now { current_tick_() };
+
+    if (now < timer_next_due_.load(std::memory_order_relaxed))  return;
+
+    std::vector<WorkUnit>   work_units { };
+
+    {
+        std::unique_lock<std::mutex>    lock { timer_mutex_,
+                                               std::try_to_lock };
+
+        if (! lock.owns_lock())  return;  // Somebody else is at it
+
+        timer_wheel_.advance(
+            now,
+            [this, &work_units](TimerTask &timer) -> void  {
+                if (! timer.periodic)  {
+                    work_units.emplace_back(WORK_TYPE::_client_service_,
+                                            std::move(timer.once));
+                    return;
+                }
+                work_units.emplace_back(
+                    WORK_TYPE::_client_service_,
+                    [this,
+                     periodic = timer.periodic,
+                     token = timer.source.token()]() -> void  {
+                        if (token.is_cancelled() ||
+                            periodic->running.test_and_set(
+                                std::memory_order_acquire))
+                            return;
+                        try  {
+                            periodic->routine();
+                        }
+                        catch (...)  {
+                            handle_exception_(std::current_exception());
+                        }
+                        periodic->running.clear(std::memory_order_release);
+                    });
+            });
+        timer_next_due_.store(timer_wheel_.next_due());
+        timer_count_.store(timer_wheel_.size());
+    }
+    if (! work_units.empty())
+        enqueue_bulk_(work_units);
+}
+
+// ----------------------------------------------------------------------------
+
+inline void ThreadPool::cancel_timer_task_(TimerTask &timer) noexcept  {
+
+    timer.source.cancel();
+    if (timer.once)
+        timer.once();  // It only sets the future to TaskCancelled
 }
 
 // ----------------------------------------------------------------------------
 
 inline ThreadPool::WorkUnit
-ThreadPool::get_one_local_task_() noexcept  {
+ThreadPool::next_task_() noexcept  {
 
-    WorkUnit            work_unit;
-    const guard_type    guard { state_ };
+    // The weights decide which lane we start with, then the rest are tried
+    // in priority order
+    //
+    const std::size_t   pick {
+        schedule_tick_++ % lane_bounds_[TASK_PRIORITY_COUNT - 1]
+    };
+    std::size_t         first { 0 };
 
-    if (local_queue_ && (! local_queue_->empty()))  {
-        work_unit = local_queue_->front();
-        local_queue_->pop();
+    while (pick >= lane_bounds_[first])  ++first;
+    for (std::size_t i = 0; i <= TASK_PRIORITY_COUNT; ++i)  {
+        const std::size_t   lane { i == 0 ? first : i - 1 };
+
+        if (i != 0 && lane == first)  continue;
+
+        // Side lanes are skipped cheaply, when they are empty
+        //
+        if (lane != NORMAL_LANE &&
+            lane_pending_[lane].value.load(std::memory_order_relaxed) <= 0)
+            continue;
+
+        WorkUnit    work_unit = next_task_(lane);
+
+        if (work_unit.work_type != WORK_TYPE::_undefined_)  {
+            if (lane != NORMAL_LANE)
+                lane_pending_[lane].value.fetch_sub(
+                    1, std::memory_order_relaxed);
+            return (work_unit);
+        }
     }
-    else  {  // Try to steal tasks from other queues
-        for (auto &q : local_queues_)
-            if (! q.empty())  {
-                work_unit = q.front();
-                q.pop();
-                break;
-            }
+    return (WorkUnit { });
+}
+
+// ----------------------------------------------------------------------------
+
+inline ThreadPool::WorkUnit
+ThreadPool::next_task_(std::size_t lane) noexcept  {
+
+    WorkUnit    work_unit = get_one_local_task_(lane);
+
+    if (work_unit.work_type != WORK_TYPE::_undefined_)  return (work_unit);
+
+    // Our node's global queue, then other nodes' threads and global queues
+    //
+    const std::size_t   node_count { node_queues_.size() };
+    std::size_t         node { caller_node_() };
+
+    for (std::size_t i = 0; i < node_count; ++i, ++node)  {
+        if (node == node_count)  node = 0;
+
+        auto    opt_ret = node_queues_[node]->tasks[lane].pop_front(false);
+
+        if (opt_ret.has_value())  return (std::move(*opt_ret));
+        if (i == 0 && node_count > 1 &&
+            steal_(work_unit, LOCALITY::_other_node_, lane))
+            return (work_unit);
     }
     return (work_unit);
 }
@@ -478,67 +3684,531 @@ ThreadPool::get_one_local_task_() noexcept  {
 // ----------------------------------------------------------------------------
 
 inline bool
-ThreadPool::run_task() noexcept  {
+ThreadPool::has_pending_tasks_() const noexcept  {
 
-    WorkUnit    work_unit = get_one_local_task_();
+    for (const auto &node_q : node_queues_)
+        for (const GlobalQueueType &lane : node_q->tasks)
+            if (! lane.empty())
+                return (true);
 
-    if (work_unit.work_type == WORK_TYPE::_undefined_)  {
-        const auto  opt_ret = global_queue_.pop_front(false); // Don't wait
+    const StealList *queues { steal_list_.load(std::memory_order_acquire) };
+
+    if (queues)
+        for (const LocalQueue *q : *queues)
+            for (const WorkStealingDeque<WorkUnit> &lane : q->tasks)
+                if (! lane.empty())
+                    return (true);
+    return (false);
+}
+
+// ----------------------------------------------------------------------------
+
+inline bool
+ThreadPool::run_task() noexcept  {
+
+    WorkUnit    work_unit = next_task_();
 
-        if (opt_ret.has_value())
-            work_unit = opt_ret.value();
-    }
     if (work_unit.work_type == WORK_TYPE::_client_service_) {
-        (work_unit.func)();  // Execute the callable
+        execute_(work_unit);
         return (true);
     }
-    else if (work_unit.work_type != WORK_TYPE::_undefined_)
-        global_queue_.push(work_unit);  // Put it back
+    else if (work_unit.work_type != WORK_TYPE::_undefined_)  {
+        const std::size_t   node { caller_node_() };
+
+        // Put it back
+        //
+        node_queues_[node]->tasks[NORMAL_LANE].push(std::move(work_unit));
+        wake_(node, 1);
+    }
     return (false);
 }
 
 // ----------------------------------------------------------------------------
 
 inline bool
-ThreadPool::thread_routine_(size_type local_q_idx) noexcept  {
+ThreadPool::thread_routine_(LocalQueue *local_q) noexcept  {
 
-    if (is_shutdown())
+    if (is_shutdown())  {
+        const guard_type    guard { state_ };
+
+        release_local_queue_(local_q);
         return (false);
+    }
 
+    if (local_q->cpu >= 0)
+        Topology::pin_current_thread(static_cast<unsigned int>(local_q->cpu));
     pre_conditioner_.execute();
 
-    auto    iter = local_queues_.begin();
-
-    std::advance(iter, local_q_idx);
-    local_queue_ = &(*iter);
+    local_queue_ = local_q;
+    local_pool_ = this;
     ++capacity_threads_;
+    ++available_threads_;
+
+    EventCount  &parking { node_queues_[local_q->node]->parking };
+    std::size_t spun { 0 };
+    std::size_t backoff { 1 };
+
     while (true)  {
-        ++available_threads_;
+        service_timers_();
+
+        WorkUnit    work_unit = next_task_();
 
-        size_type   counter { 0 };
+        if (work_unit.work_type == WORK_TYPE::_client_service_)  {
+            --available_threads_;
+            execute_(work_unit);
+            ++available_threads_;
+            spun = 0;
+            backoff = 1;
+        }
+        else if (work_unit.work_type == WORK_TYPE::_terminate_)  {
 
-        while (++counter < 80)  run_task();
+            // Terminates are only in the normal lane. So, the weighted pick
+            // may get one before the side lanes are drained. Then it goes
+            // back behind them.
+            //
+            bool    side_pending { false };
 
-        WorkUnit    work_unit { };
-        const auto  opt_ret = global_queue_.pop_front(true); // Wait
+            for (std::size_t lane = 0; lane < TASK_PRIORITY_COUNT; ++lane)
+                if (lane != NORMAL_LANE &&
+                    lane_pending_[lane].value.load(
+                        std::memory_order_relaxed) > 0)
+                    side_pending = true;
+            if (! side_pending)  break;
+            node_queues_[local_q->node]->tasks[NORMAL_LANE].push(
+                std::move(work_unit));
+        }
+        else if (spun < spin_count_)  {  // Spin with exponential backoff
+            if (backoff < MAX_BACKOFF)  {
+                for (std::size_t i = 0; i < backoff; ++i)
+                    cpu_relax();
+                spun += backoff;
+                backoff *= 2;
+            }
+            else  {  // Let other threads run on an oversubscribed system
+                std::this_thread::yield();
+                spun += MAX_BACKOFF;
+            }
+        }
+        else  {  // Park until a task is queued
+            const auto  key = parking.prepare_wait();
+            std::size_t no_keeper { 0 };
 
-        if (opt_ret.has_value())
-            work_unit = opt_ret.value();
+            if (has_pending_tasks_())
+                parking.cancel_wait();
+            else if (timer_count_.load() > 0 &&
+                     timer_keeper_.compare_exchange_strong(
+                         no_keeper, local_q->node + 1))  {
+                // We keep time for the pool, until the next timer is due
+                //
+                const tick_type due { timer_next_due_.load() };
+                bool            notified { true };
 
-        --available_threads_;
+                if (due == TimerWheelType::NEVER)
+                    parking.commit_wait(key);
+                else
+                    notified = parking.commit_wait_until(key, tick_time_(due));
+                timer_keeper_.store(0);
 
-        if (work_unit.work_type == WORK_TYPE::_client_service_)
-            (work_unit.func)();  // Execute the callable
-        else if (work_unit.work_type == WORK_TYPE::_terminate_)
-            break;
+                // We were woken up for a task. Another parked thread must
+                // keep time.
+                //
+                if (notified &&
+                    timer_count_.load(std::memory_order_relaxed) > 0)
+                    wake_(local_q->node, 1);
+            }
+            else
+                parking.commit_wait(key);
+            spun = 0;
+            backoff = 1;
+        }
     }
+    --available_threads_;
     --capacity_threads_;
     local_queue_ = nullptr;
+    local_pool_ = nullptr;
+    {
+        const guard_type    guard { state_ };
+
+        release_local_queue_(local_q);
+    }
+
+    // Somebody else must run what is left in our queue
+    //
+    std::size_t left { 0 };
+
+    for (const WorkStealingDeque<WorkUnit> &lane : local_q->tasks)
+        left += lane.size();
+    if (left > 0)
+        wake_(local_q->node, left);
     post_conditioner_.execute();
 
     return (true);
 }
 
+// ----------------------------------------------------------------------------
+
+inline TaskGroup::TaskGroup(ThreadPool &pool, CancellationToken token)
+    : state_(std::allocate_shared<State>(RecyclingAllocator<State> { },
+                                         pool,
+                                         std::move(token)))  {   }
+
+// ----------------------------------------------------------------------------
+
+inline TaskGroup::~TaskGroup()  {
+
+    if (state_)  {
+        try  {
+            wait();
+        }
+        catch (...)  {   }
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename F, typename ... As>
+requires std::invocable<F, As ...>
+void TaskGroup::run(F &&routine, As && ... args)  {
+
+    State   &state { *state_ };
+
+    if (state.token.is_cancelled())  {
+        cancelled_(state);
+        return;
+    }
+
+    state.pending.fetch_add(1, std::memory_order_relaxed);
+    state.tasks.push(
+        routine_type {
+            [routine = std::forward<F>(routine),
+             ... args = std::forward<As>(args)]() mutable -> void  {
+                std::invoke(routine, ThreadPool::unwrap_ref_(args) ...);
+            }
+        });
+
+    // The pool gets a proxy that runs whichever task of the group is next.
+    // If wait() has already run them all, the proxy does nothing.
+    //
+    state.pool.enqueue_(
+        ThreadPool::WorkUnit {
+            ThreadPool::WORK_TYPE::_client_service_,
+            [state = state_]() -> void  { run_one_(*state); }
+        });
+
+    // A parked waiter may run it sooner than the pool
+    //
+    state.finished.notify_all();
+}
+
+// ----------------------------------------------------------------------------
+
+inline bool TaskGroup::run_one_(State &state) noexcept  {
+
+    auto    task = state.tasks.pop_front(false);
+
+    if (! task.has_value())  return (false);
+
+    if (state.token.is_cancelled())
+        cancelled_(state);
+    else  {
+        try  {
+            (*task)();
+        }
+        catch (...)  {
+            const std::lock_guard<std::mutex>   guard { state.mutex };
+
+            if (! state.exception)
+                state.exception = std::current_exception();
+        }
+    }
+    if (state.pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        state.finished.notify_all();
+    return (true);
+}
+
+// ----------------------------------------------------------------------------
+
+inline void TaskGroup::wait()  {
+
+    State               &state { *state_ };
+    ThreadPool          &pool { state.pool };
+    const bool          is_ours { ThreadPool::local_pool_ == &pool };
+    std::size_t         spun { 0 };
+    std::size_t         backoff { 1 };
+
+    while (state.pending.load(std::memory_order_acquire) > 0)  {
+
+        // Our own tasks first, then anything else, if we are a pool thread
+        //
+        if (run_one_(state) || (is_ours && pool.run_task()))  {
+            spun = 0;
+            backoff = 1;
+        }
+        else if (spun < pool.spin_count_)  {
+            if (backoff < ThreadPool::MAX_BACKOFF)  {
+                for (std::size_t i = 0; i < backoff; ++i)
+                    cpu_relax();
+                spun += backoff;
+                backoff *= 2;
+            }
+            else  {
+                std::this_thread::yield();
+                spun += ThreadPool::MAX_BACKOFF;
+            }
+        }
+        else  {  // The rest are running on other threads
+            const auto  key = state.finished.prepare_wait();
+
+            if (state.pending.load(std::memory_order_acquire) == 0 ||
+                ! state.tasks.empty())
+                state.finished.cancel_wait();
+            else
+                state.finished.commit_wait(key);
+            spun = 0;
+            backoff = 1;
+        }
+    }
+
+    std::exception_ptr  ex_ptr { };
+
+    {
+        const std::lock_guard<std::mutex>   guard { state.mutex };
+
+        std::swap(ex_ptr, state.exception);
+    }
+    if (ex_ptr)  std::rethrow_exception(ex_ptr);
+}
+
+// ----------------------------------------------------------------------------
+
+inline TaskGroup::size_type TaskGroup::pending() const noexcept  {
+
+    return (state_->pending.load(std::memory_order_relaxed));
+}
+
+// ----------------------------------------------------------------------------
+
+inline const CancellationToken &TaskGroup::token() const noexcept  {
+
+    return (state_->token);
+}
+
+// ----------------------------------------------------------------------------
+
+inline void TaskGroup::cancelled_(State &state)  {
+
+    const std::lock_guard<std::mutex>   guard { state.mutex };
+
+    if (! state.exception)
+        state.exception = std::make_exception_ptr(TaskCancelled { });
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename T>
+void TaskFuture<T>::State::finish() noexcept  {
+
+    routine_type    next { };
+    bool            wake { false };
+
+    {
+        const std::lock_guard<std::mutex>   guard { mutex };
+
+        ready = true;
+        std::swap(next, continuation);
+        wake = parked > 0;
+    }
+
+    // A waiter on a pool thread parks with the workers of its node
+    //
+    if (wake)
+        for (const auto &node_q : pool.node_queues_)
+            node_q->parking.notify_all();
+    if (next)  pool.enqueue_continuation_(std::move(next));
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename T>
+TaskFuture<T>::TaskFuture(std::shared_ptr<State> state)
+    : state_(std::move(state))  {   }
+
+// ----------------------------------------------------------------------------
+
+template<typename T>
+template<typename F, typename ... As>
+void
+TaskFuture<T>::fulfill_(std::promise<T> &promise, F &routine, As && ... args)
+{
+    try  {
+        if constexpr (std::is_void_v<T>)  {
+            std::invoke(routine, std::forward<As>(args) ...);
+            promise.set_value();
+        }
+        else
+            promise.set_value(
+                std::invoke(routine, std::forward<As>(args) ...));
+    }
+    catch (...)  {
+        promise.set_exception(std::current_exception());
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename T>
+template<typename F>
+requires (std::is_void_v<T> && std::invocable<std::decay_t<F> &>) ||
+         (! std::is_void_v<T> && std::invocable<std::decay_t<F> &, T>)
+auto TaskFuture<T>::then(F &&routine)  {
+
+    if (! state_)
+        throw std::runtime_error("TaskFuture::then(): "
+                                 "The future is not valid.");
+
+    using next_t =
+        typename std::conditional_t<
+            std::is_void_v<T>,
+            std::invoke_result<std::decay_t<F> &>,
+            std::invoke_result<std::decay_t<F> &, T>>::type;
+    using future_t = TaskFuture<next_t>;
+    using state_t = typename future_t::State;
+
+    const std::shared_ptr<State>    prev { std::move(state_) };
+    auto                            next {
+        std::allocate_shared<state_t>(RecyclingAllocator<state_t> { },
+                                      prev->pool)
+    };
+    routine_type                    task {
+        [prev, next, routine = std::forward<F>(routine)]() mutable -> void  {
+            if constexpr (std::is_void_v<T>)  {
+                try  {
+                    prev->future.get();
+                    future_t::fulfill_(next->promise, routine);
+                }
+                catch (...)  {
+                    next->promise.set_exception(std::current_exception());
+                }
+            }
+            else  {
+                try  {
+                    future_t::fulfill_(next->promise,
+                                       routine,
+                                       prev->future.get());
+                }
+                catch (...)  {
+                    next->promise.set_exception(std::current_exception());
+                }
+            }
+            next->finish();
+        }
+    };
+
+    // Either the predecessor runs it when it finishes, or it has already
+    // finished and we queue it now
+    //
+    {
+        const std::lock_guard<std::mutex>   guard { prev->mutex };
+
+        if (! prev->ready)  {
+            prev->continuation = std::move(task);
+            return (future_t { std::move(next) });
+        }
+    }
+    prev->pool.enqueue_continuation_(std::move(task));
+    return (future_t { std::move(next) });
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename T>
+T TaskFuture<T>::get()  {
+
+    wait();
+
+    const std::shared_ptr<State>    state { std::move(state_) };
+
+    return (state->future.get());
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename T>
+void TaskFuture<T>::wait() const  {
+
+    if (! state_)
+        throw std::runtime_error("TaskFuture::wait(): "
+                                 "The future is not valid.");
+
+    State       &state { *state_ };
+    ThreadPool  &pool { state.pool };
+
+    // A pool thread runs other tasks, maybe the one we are waiting for.
+    // When there are none, it parks with the workers of its node. Either a
+    // new task or finish() wakes it up. Once the pool is shut down, the
+    // queues hold terminates, so it just blocks.
+    //
+    if (ThreadPool::local_pool_ == &pool)  {
+        EventCount  &parking {
+            pool.node_queues_[ThreadPool::local_queue_->node]->parking
+        };
+        std::size_t spun { 0 };
+        std::size_t backoff { 1 };
+
+        while (! is_ready() && ! pool.is_shutdown())  {
+            if (pool.run_task())  {
+                spun = 0;
+                backoff = 1;
+            }
+            else if (spun < pool.spin_count_)  {
+                if (backoff < ThreadPool::MAX_BACKOFF)  {
+                    for (std::size_t i = 0; i < backoff; ++i)
+                        cpu_relax();
+                    spun += backoff;
+                    backoff *= 2;
+                }
+                else  {
+                    std::this_thread::yield();
+                    spun += ThreadPool::MAX_BACKOFF;
+                }
+            }
+            else  {
+                const auto  key = parking.prepare_wait();
+                bool        ready { false };
+
+                {
+                    const std::lock_guard<std::mutex>   guard { state.mutex };
+
+                    ready = state.ready;
+                    if (! ready)  state.parked += 1;
+                }
+                if (ready || pool.has_pending_tasks_())
+                    parking.cancel_wait();
+                else
+                    parking.commit_wait(key);
+                if (! ready)  {
+                    const std::lock_guard<std::mutex>   guard { state.mutex };
+
+                    state.parked -= 1;
+                }
+                spun = 0;
+                backoff = 1;
+            }
+        }
+    }
+    state.future.wait();
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename T>
+bool TaskFuture<T>::is_ready() const noexcept  {
+
+    return (state_ &&
+            state_->future.wait_for(std::chrono::seconds { 0 }) ==
+                std::future_status::ready);
+}
+
 } // namespace hmthrp
 
 // ----------------------------------------------------------------------------
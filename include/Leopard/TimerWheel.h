@@ -0,0 +1,176 @@
+// Hossein Moein
+// October 18, 2026
+/*
+Copyright (c) 2023-2028, Hossein Moein
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+* Neither the name of Hossein Moein and/or the Leopard nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL Hossein Moein BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <vector>
+
+// ----------------------------------------------------------------------------
+
+namespace hmthrp
+{
+
+// A hierarchical timing wheel of timers carrying a T. Time is counted in
+// ticks. It is not thread-safe. ThreadPool keeps one behind a mutex for
+// dispatch_after(), dispatch_at() and dispatch_every().
+//
+// There are LEVELS wheels of SLOTS slots. A slot of level l spans SLOTS^l
+// ticks, and holds a doubly linked list of timers. A timer goes in the
+// lowest level whose span covers its distance from now. When the lower
+// level comes around, the next slot of the level above is cascaded into it.
+// So inserting and cancelling is O(1), and a timer is moved at most LEVELS
+// times before it expires. Timers farther than MAX_SPAN ticks go in the
+// top level, and are put back in it until they are close enough.
+// Timers are kept in one vector and recycled, so in the steady state
+// inserting doesn't allocate.
+//
+template<typename T>
+class   TimerWheel  {
+
+public:
+
+    using value_type = T;
+    using size_type = std::size_t;
+    using tick_type = std::uint64_t;
+    using id_type = std::uint64_t;  // 0 is never the id of a timer
+
+    inline static constexpr std::size_t LEVEL_BITS = 6;
+    inline static constexpr std::size_t SLOTS = 1 << LEVEL_BITS;
+    inline static constexpr std::size_t LEVELS = 4;
+    inline static constexpr tick_type   MAX_SPAN =
+        tick_type(1) << (LEVEL_BITS * LEVELS);
+    inline static constexpr tick_type   NEVER =
+        std::numeric_limits<tick_type>::max();
+
+    // now is the first tick advance() looks at
+    //
+    explicit TimerWheel(tick_type now = 0) noexcept;
+    TimerWheel(TimerWheel &&) = default;
+    TimerWheel &operator = (TimerWheel &&) = default;
+    TimerWheel(const TimerWheel &) = delete;
+    TimerWheel &operator = (const TimerWheel &) = delete;
+
+    // It adds a timer that expires at tick due. If period is not 0, it
+    // expires again every period ticks after that, until it is cancelled.
+    // A due in the past expires at the next advance().
+    //
+    id_type insert(tick_type due, value_type &&value, tick_type period = 0);
+
+    // It removes the timer and returns its value. If the timer has already
+    // expired (or was never there), it returns nothing.
+    //
+    std::optional<value_type> cancel(id_type id);
+
+    // It moves time up to tick now, and calls expired(value_type &) for every
+    // timer that expires on the way, in order of ticks. The value of a one
+    // shot timer may be moved from. It is destroyed after expired() returns.
+    // A periodic timer that missed some of its ticks expires once, and is
+    // due next after now. expired() must not call the wheel.
+    // It returns the number of expirations.
+    //
+    template<typename F>
+    size_type advance(tick_type now, F &&expired);
+
+    // The first tick at which advance() has something to do, or NEVER if
+    // there are no timers. Timers expire no sooner than that.
+    //
+    tick_type next_due() const noexcept;
+
+    // The first tick advance() hasn't looked at
+    //
+    tick_type now() const noexcept;
+
+    size_type size() const noexcept;
+    bool empty() const noexcept;
+
+    // It calls func(value_type &&) for every timer, and removes them all
+    //
+    template<typename F>
+    void drain(F &&func);
+
+private:
+
+    using index_type = std::uint32_t;
+
+    inline static constexpr index_type  NIL =
+        std::numeric_limits<index_type>::max();
+    inline static constexpr tick_type   SLOT_MASK = SLOTS - 1;
+
+    struct  Node  {
+
+        std::optional<value_type>   value { };  // Empty if free
+        tick_type                   due { 0 };
+        tick_type                   period { 0 };
+        index_type                  prev { NIL };
+        index_type                  next { NIL };  // Or next free node
+        index_type                  slot { NIL };  // level * SLOTS + slot
+        std::uint32_t               generation { 0 };
+    };
+
+    // A slot of the level spans 1 << shift_(level) ticks
+    //
+    static std::size_t shift_(std::size_t level) noexcept;
+
+    void link_(index_type index) noexcept;
+    void unlink_(index_type index) noexcept;
+
+    // It takes the list of a slot out of the wheel, and returns its head
+    //
+    index_type detach_(std::size_t slot) noexcept;
+
+    void free_(index_type index) noexcept;
+
+    std::vector<Node>                       nodes_ { };
+    std::array<index_type, LEVELS * SLOTS>  heads_ { };
+    std::array<std::uint64_t, LEVELS>       occupied_ { };  // Bit per slot
+    index_type                              free_head_ { NIL };
+    tick_type                               now_ { 0 };
+    size_type                               size_ { 0 };
+};
+
+} // namespace hmthrp
+
+// ----------------------------------------------------------------------------
+
+#ifndef HMTHRP_DO_NOT_INCLUDE_TCC_FILES
+#  include <Leopard/TimerWheel.tcc>
+#endif // HMTHRP_DO_NOT_INCLUDE_TCC_FILES
+
+// ----------------------------------------------------------------------------
+
+// Local Variables:
+// mode:C++
+// tab-width:4
+// c-basic-offset:4
+// End:
@@ -0,0 +1,315 @@
+// Hossein Moein
+// October 18, 2026
+/*
+Copyright (c) 2023-2028, Hossein Moein
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+* Neither the name of Hossein Moein and/or the Leopard nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL Hossein Moein BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <Leopard/TimerWheel.h>
+
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+#include <utility>
+
+// ----------------------------------------------------------------------------
+
+namespace hmthrp
+{
+
+template<typename T>
+TimerWheel<T>::TimerWheel(tick_type now) noexcept : now_(now)  {
+
+    heads_.fill(NIL);
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename T>
+typename TimerWheel<T>::id_type
+TimerWheel<T>::insert(tick_type due, value_type &&value, tick_type period)  {
+
+    if (free_head_ == NIL)  {
+        if (nodes_.size() >= std::size_t(NIL))
+            throw std::runtime_error("TimerWheel::insert(): "
+                                     "Too many timers.");
+        nodes_.emplace_back();
+        free_head_ = index_type(nodes_.size() - 1);
+    }
+
+    const index_type    index { free_head_ };
+    Node                &node { nodes_[index] };
+
+    node.value.emplace(std::move(value));  // If it throws, node stays free
+    free_head_ = node.next;
+    node.due = due;
+    node.period = period;
+    link_(index);
+    size_ += 1;
+    return ((id_type(node.generation) << 32) | (id_type(index) + 1));
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename T>
+std::optional<typename TimerWheel<T>::value_type>
+TimerWheel<T>::cancel(id_type id)  {
+
+    const id_type   low { id & 0xFFFFFFFFULL };
+
+    if (low == 0 || low > nodes_.size())  return (std::nullopt);
+
+    const index_type    index { index_type(low - 1) };
+    Node                &node { nodes_[index] };
+
+    if (! node.value.has_value() || node.generation != (id >> 32))
+        return (std::nullopt);
+
+    std::optional<value_type>   ret { std::move(node.value) };
+
+    unlink_(index);
+    free_(index);
+    return (ret);
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename T>
+template<typename F>
+typename TimerWheel<T>::size_type
+TimerWheel<T>::advance(tick_type now, F &&expired)  {
+
+    size_type   count { 0 };
+
+    while (now_ <= now)  {
+        const tick_type next { next_due() };
+
+        // Nothing happens in between, so skip it
+        //
+        if (next > now)  {
+            now_ = now + 1;
+            break;
+        }
+        now_ = next;
+
+        // Bring the slots that come around now down a level. A level can
+        // only come around, if the ones below it just did.
+        //
+        for (std::size_t level = 1; level < LEVELS; ++level)  {
+            if ((now_ & ((tick_type(1) << shift_(level)) - 1)) != 0)  break;
+
+            index_type  index {
+                detach_(level * SLOTS +
+                        std::size_t((now_ >> shift_(level)) & SLOT_MASK))
+            };
+
+            while (index != NIL)  {
+                const index_type    next_index { nodes_[index].next };
+
+                link_(index);
+                index = next_index;
+            }
+        }
+
+        index_type  index { detach_(std::size_t(now_ & SLOT_MASK)) };
+
+        while (index != NIL)  {
+            Node                &node { nodes_[index] };
+            const index_type    next_index { node.next };
+
+            expired(*node.value);
+            count += 1;
+            if (node.period == 0)
+                free_(index);
+            else  {  // The next one of its ticks after now
+                node.due += ((now - node.due) / node.period + 1) * node.period;
+                link_(index);
+            }
+            index = next_index;
+        }
+        now_ += 1;
+    }
+    return (count);
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename T>
+typename TimerWheel<T>::tick_type
+TimerWheel<T>::next_due() const noexcept  {
+
+    if (size_ == 0)  return (NEVER);
+
+    tick_type   ret { NEVER };
+
+    for (std::size_t level = 0; level < LEVELS; ++level)  {
+        if (occupied_[level] == 0)  continue;
+
+        const std::size_t   shift { shift_(level) };
+        const tick_type     base { now_ >> shift };
+
+        // Bit i is the i'th slot from the current one. The current slot
+        // comes around now, if we are on its boundary. Otherwise, it has
+        // just come around and holds timers of the next round.
+        //
+        const std::uint64_t ahead {
+            std::rotr(occupied_[level], int(base & SLOT_MASK))
+        };
+        tick_type           slots { SLOTS };
+
+        if ((ahead & 1) && (now_ & ((tick_type(1) << shift) - 1)) == 0)
+            slots = 0;
+        else if ((ahead & ~std::uint64_t(1)) != 0)
+            slots = std::countr_zero(ahead & ~std::uint64_t(1));
+        ret = std::min(ret, (base + slots) << shift);
+    }
+    return (ret);
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename T>
+inline typename TimerWheel<T>::tick_type
+TimerWheel<T>::now() const noexcept  { return (now_); }
+
+// ----------------------------------------------------------------------------
+
+template<typename T>
+inline typename TimerWheel<T>::size_type
+TimerWheel<T>::size() const noexcept  { return (size_); }
+
+// ----------------------------------------------------------------------------
+
+template<typename T>
+inline bool TimerWheel<T>::empty() const noexcept  { return (size_ == 0); }
+
+// ----------------------------------------------------------------------------
+
+template<typename T>
+template<typename F>
+void TimerWheel<T>::drain(F &&func)  {
+
+    for (std::size_t i = 0; i < nodes_.size(); ++i)
+        if (nodes_[i].value.has_value())  {
+            func(std::move(*nodes_[i].value));
+            free_(index_type(i));
+        }
+    heads_.fill(NIL);
+    occupied_.fill(0);
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename T>
+inline std::size_t TimerWheel<T>::shift_(std::size_t level) noexcept  {
+
+    return (level * LEVEL_BITS);
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename T>
+void TimerWheel<T>::link_(index_type index) noexcept  {
+
+    Node                &node { nodes_[index] };
+
+    // Overdue timers go in the current slot. Far ones go as far as it gets.
+    //
+    const tick_type     when {
+        std::clamp(node.due, now_, now_ + (MAX_SPAN - 1))
+    };
+    const tick_type     distance { when - now_ };
+    const std::size_t   level {
+        distance == 0 ? 0 : (std::bit_width(distance) - 1) / LEVEL_BITS
+    };
+    const std::size_t   slot {
+        std::size_t((when >> shift_(level)) & SLOT_MASK)
+    };
+
+    node.slot = index_type(level * SLOTS + slot);
+    node.prev = NIL;
+    node.next = heads_[node.slot];
+    if (node.next != NIL)
+        nodes_[node.next].prev = index;
+    heads_[node.slot] = index;
+    occupied_[level] |= std::uint64_t(1) << slot;
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename T>
+void TimerWheel<T>::unlink_(index_type index) noexcept  {
+
+    Node    &node { nodes_[index] };
+
+    if (node.prev != NIL)
+        nodes_[node.prev].next = node.next;
+    else  {
+        heads_[node.slot] = node.next;
+        if (node.next == NIL)
+            occupied_[node.slot / SLOTS] &=
+                ~(std::uint64_t(1) << (node.slot & SLOT_MASK));
+    }
+    if (node.next != NIL)
+        nodes_[node.next].prev = node.prev;
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename T>
+typename TimerWheel<T>::index_type
+TimerWheel<T>::detach_(std::size_t slot) noexcept  {
+
+    const index_type    head { heads_[slot] };
+
+    heads_[slot] = NIL;
+    occupied_[slot / SLOTS] &= ~(std::uint64_t(1) << (slot & SLOT_MASK));
+    return (head);
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename T>
+void TimerWheel<T>::free_(index_type index) noexcept  {
+
+    Node    &node { nodes_[index] };
+
+    node.value.reset();
+    node.generation += 1;
+    node.slot = NIL;
+    node.next = free_head_;
+    free_head_ = index;
+    size_ -= 1;
+}
+
+} // namespace hmthrp
+
+// ----------------------------------------------------------------------------
+
+// Local Variables:
+// mode:C++
+// tab-width:4
+// c-basic-offset:4
+// End:
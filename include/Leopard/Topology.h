@@ -0,0 +1,112 @@
+// Hossein Moein
+// October 18, 2026
+/*
+Copyright (c) 2023-2028, Hossein Moein
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+* Neither the name of Hossein Moein and/or the Leopard nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL Hossein Moein BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// ----------------------------------------------------------------------------
+
+namespace hmthrp
+{
+
+// Where a logical CPU sits in the machine
+//
+struct  CpuInfo  {
+
+    unsigned int    id { 0 };    // As the OS numbers it
+    unsigned int    node { 0 };  // NUMA node
+    unsigned int    l3 { 0 };    // Lowest CPU id sharing its L3 cache
+};
+
+// ----------------------------------------------------------------------------
+
+// CPU topology of the machine. On Linux, it is read from /sys. Elsewhere,
+// all CPUs are assumed to be on one node, sharing one L3 cache.
+//
+class   Topology  {
+
+public:
+
+    using size_type = std::size_t;
+    using CpuVector = std::vector<CpuInfo>;
+
+    Topology() = default;
+    explicit Topology(CpuVector cpus);
+
+    // The topology of this machine. It is read once.
+    //
+    static const Topology &system();
+
+    const CpuVector &cpus() const noexcept;
+    size_type node_count() const noexcept;
+
+    // nullptr, if cpu_id is not in this topology
+    //
+    const CpuInfo *find(unsigned int cpu_id) const noexcept;
+
+    // CPUs ordered so that consecutive ones go to different nodes, and
+    // within a node to different L3 caches, as far as possible
+    //
+    CpuVector spread_order() const;
+
+    // It parses the Linux CPU list format, e.g. "0-3,8,10-11"
+    //
+    static std::vector<unsigned int> parse_cpu_list(const std::string &list);
+
+    // They return false / -1 where it is not supported
+    //
+    static bool pin_current_thread(unsigned int cpu_id) noexcept;
+    static int current_cpu() noexcept;
+
+private:
+
+    static Topology detect_();
+
+    CpuVector   cpus_ { };  // Sorted by id
+    size_type   node_count_ { 0 };
+};
+
+} // namespace hmthrp
+
+// ----------------------------------------------------------------------------
+
+#ifndef HMTHRP_DO_NOT_INCLUDE_TCC_FILES
+#  include <Leopard/Topology.tcc>
+#endif // HMTHRP_DO_NOT_INCLUDE_TCC_FILES
+
+// ----------------------------------------------------------------------------
+
+// Local Variables:
+// mode:C++
+// tab-width:4
+// c-basic-offset:4
+// End:
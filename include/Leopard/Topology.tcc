@@ -0,0 +1,288 @@
+// Hossein Moein
+// October 18, 2026
+/*
+Copyright (c) 2023-2028, Hossein Moein
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+* Neither the name of Hossein Moein and/or the Leopard nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL Hossein Moein BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <Leopard/Topology.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <set>
+#include <thread>
+#include <utility>
+
+#ifdef __linux__
+#  include <pthread.h>
+#  include <sched.h>
+#endif // __linux__
+
+// ----------------------------------------------------------------------------
+
+namespace hmthrp
+{
+
+inline Topology::Topology(CpuVector cpus) : cpus_(std::move(cpus))  {
+
+    std::sort(cpus_.begin(), cpus_.end(),
+              [](const CpuInfo &lhs, const CpuInfo &rhs) -> bool  {
+                  return (lhs.id < rhs.id);
+              });
+
+    std::set<unsigned int>  nodes;
+
+    for (const CpuInfo &cpu : cpus_)
+        nodes.insert(cpu.node);
+    node_count_ = nodes.size();
+}
+
+// ----------------------------------------------------------------------------
+
+inline const Topology &Topology::system()  {
+
+    static const Topology   topology { detect_() };
+
+    return (topology);
+}
+
+// ----------------------------------------------------------------------------
+
+inline const Topology::CpuVector &Topology::cpus() const noexcept  {
+
+    return (cpus_);
+}
+
+// ----------------------------------------------------------------------------
+
+inline Topology::size_type Topology::node_count() const noexcept  {
+
+    return (node_count_);
+}
+
+// ----------------------------------------------------------------------------
+
+inline const CpuInfo *Topology::find(unsigned int cpu_id) const noexcept  {
+
+    const auto  iter =
+        std::lower_bound(cpus_.begin(), cpus_.end(), cpu_id,
+                         [](const CpuInfo &cpu, unsigned int id) -> bool  {
+                             return (cpu.id < id);
+                         });
+
+    if (iter != cpus_.end() && iter->id == cpu_id)  return (&(*iter));
+    return (nullptr);
+}
+
+// ----------------------------------------------------------------------------
+
+inline Topology::CpuVector Topology::spread_order() const  {
+
+    // node -> L3 -> CPUs
+    //
+    std::map<unsigned int, std::map<unsigned int, CpuVector>>   tree;
+
+    for (const CpuInfo &cpu : cpus_)
+        tree[cpu.node][cpu.l3].push_back(cpu);
+
+    // Round-robin over the L3 caches of each node, then over the nodes
+    //
+    std::vector<CpuVector>  per_node;
+
+    for (auto &[node, caches] : tree)  {
+        CpuVector   order;
+        bool        more { true };
+
+        for (size_type i = 0; more; ++i)  {
+            more = false;
+            for (auto &[l3, cpus] : caches)
+                if (i < cpus.size())  {
+                    order.push_back(cpus[i]);
+                    more = true;
+                }
+        }
+        per_node.push_back(std::move(order));
+    }
+
+    CpuVector   ret;
+
+    ret.reserve(cpus_.size());
+    for (size_type i = 0; ret.size() < cpus_.size(); ++i)
+        for (const CpuVector &order : per_node)
+            if (i < order.size())
+                ret.push_back(order[i]);
+    return (ret);
+}
+
+// ----------------------------------------------------------------------------
+
+inline std::vector<unsigned int>
+Topology::parse_cpu_list(const std::string &list)  {
+
+    std::vector<unsigned int>   ret;
+    const char                  *str { list.c_str() };
+
+    while (*str)  {
+        char                *end { nullptr };
+        const unsigned long first { ::strtoul(str, &end, 10) };
+
+        if (end == str)  break;  // Not a number
+
+        unsigned long   last { first };
+
+        str = end;
+        if (*str == '-')  {
+            last = ::strtoul(str + 1, &end, 10);
+            str = end;
+        }
+        for (unsigned long id = first; id <= last; ++id)
+            ret.push_back(static_cast<unsigned int>(id));
+        if (*str == ',')  ++str;
+        else  break;
+    }
+    return (ret);
+}
+
+// ----------------------------------------------------------------------------
+
+inline bool Topology::pin_current_thread(unsigned int cpu_id) noexcept  {
+
+#ifdef __linux__
+    if (cpu_id >= CPU_SETSIZE)  return (false);
+
+    cpu_set_t   cpu_set;
+
+    CPU_ZERO(&cpu_set);
+    CPU_SET(cpu_id, &cpu_set);
+    return (::pthread_setaffinity_np(::pthread_self(),
+                                     sizeof(cpu_set), &cpu_set) == 0);
+#else
+    (void) cpu_id;
+    return (false);
+#endif // __linux__
+}
+
+// ----------------------------------------------------------------------------
+
+inline int Topology::current_cpu() noexcept  {
+
+#ifdef __linux__
+    return (::sched_getcpu());
+#else
+    return (-1);
+#endif // __linux__
+}
+
+// ----------------------------------------------------------------------------
+
+inline Topology Topology::detect_()  {
+
+    CpuVector   cpus;
+
+#ifdef __linux__
+    namespace fs = std::filesystem;
+
+    const auto  read_line = [](const fs::path &path) -> std::string  {
+        std::ifstream   file { path };
+        std::string     line;
+
+        std::getline(file, line);
+        return (line);
+    };
+    const fs::path  cpu_dir { "/sys/devices/system/cpu" };
+    const fs::path  node_dir { "/sys/devices/system/node" };
+
+    for (const unsigned int id :
+             parse_cpu_list(read_line(cpu_dir / "online")))
+        cpus.push_back(CpuInfo { id, 0, 0 });
+
+    std::error_code ec;
+
+    // nodeN/cpulist holds the CPUs of node N
+    //
+    for (const auto &entry : fs::directory_iterator { node_dir, ec })  {
+        const std::string   name { entry.path().filename().string() };
+
+        if (name.size() < 5 || name.compare(0, 4, "node") != 0 ||
+            name.find_first_not_of("0123456789", 4) != std::string::npos)
+            continue;
+
+        const unsigned int  node {
+            static_cast<unsigned int>(::atoi(name.c_str() + 4))
+        };
+
+        for (const unsigned int id :
+                 parse_cpu_list(read_line(entry.path() / "cpulist")))
+            for (CpuInfo &cpu : cpus)
+                if (cpu.id == id)  cpu.node = node;
+    }
+
+    // The L3 cache is the level 3 one in cpuN/cache/indexM. If there is no
+    // L3, the CPU is alone in its domain.
+    //
+    for (CpuInfo &cpu : cpus)  {
+        const fs::path  cache_dir {
+            cpu_dir / ("cpu" + std::to_string(cpu.id)) / "cache"
+        };
+
+        cpu.l3 = cpu.id;
+        for (const auto &entry : fs::directory_iterator { cache_dir, ec })
+            if (read_line(entry.path() / "level") == "3")  {
+                const auto  shared {
+                    parse_cpu_list(
+                        read_line(entry.path() / "shared_cpu_list"))
+                };
+
+                if (! shared.empty())
+                    cpu.l3 = *std::min_element(shared.begin(),
+                                               shared.end());
+                break;
+            }
+    }
+#endif // __linux__
+
+    if (cpus.empty())  {  // Unknown platform or no /sys
+        const unsigned int  n {
+            std::max(std::thread::hardware_concurrency(), 1U)
+        };
+
+        for (unsigned int id = 0; id < n; ++id)
+            cpus.push_back(CpuInfo { id, 0, 0 });
+    }
+    return (Topology { std::move(cpus) });
+}
+
+} // namespace hmthrp
+
+// ----------------------------------------------------------------------------
+
+// Local Variables:
+// mode:C++
+// tab-width:4
+// c-basic-offset:4
+// End:
@@ -0,0 +1,126 @@
+// Hossein Moein
+// October 18, 2026
+/*
+Copyright (c) 2023-2028, Hossein Moein
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+* Neither the name of Hossein Moein and/or the Leopard nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL Hossein Moein BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include <Leopard/Common.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+
+// ----------------------------------------------------------------------------
+
+namespace hmthrp
+{
+
+// This is a bounded Chase-Lev work-stealing deque.
+// Only the owner thread may push() and pop(). Those operate on the bottom
+// end in LIFO order. Any thread may steal(), which takes from the top end in
+// FIFO order. None of the operations take a lock.
+//
+// Unlike the textbook version, elements are moved in and out of their slots.
+// A thief first claims an element by advancing the top index, and then
+// moves it out. Each slot has a flag so the owner never overwrites a slot
+// that a thief is still moving out of.
+// The deque does not grow. When it is full, push() fails and the element
+// must go somewhere else (e.g. the global queue).
+//
+template<typename T>
+class   WorkStealingDeque  {
+
+public:
+
+    using value_type = T;
+    using size_type = std::size_t;
+
+    static_assert(std::is_nothrow_move_assignable_v<value_type>,
+                  "WorkStealingDeque: value_type must be nothrow movable");
+
+    inline static constexpr size_type   DEFAULT_CAPACITY = 1024;
+
+    // Capacity is rounded up to a power of 2
+    //
+    explicit
+    WorkStealingDeque(size_type capacity = DEFAULT_CAPACITY);
+    WorkStealingDeque(const WorkStealingDeque &) = delete;
+    WorkStealingDeque &operator = (const WorkStealingDeque &) = delete;
+
+    // Owner thread only.
+    // push() returns false, if the deque is full. In that case element is
+    // left untouched.
+    // pop() returns false, if the deque is empty.
+    //
+    bool push(value_type &&element) noexcept;
+    bool pop(value_type &element) noexcept;
+
+    // Any thread.
+    // It returns false, if the deque is empty.
+    //
+    bool steal(value_type &element) noexcept;
+
+    // These are approximations, if other threads are operating on the deque
+    //
+    bool empty() const noexcept;
+    size_type size() const noexcept;
+
+    size_type capacity() const noexcept;
+
+private:
+
+    using index_type = std::int64_t;
+
+    struct  Slot  {
+
+        std::atomic_bool    full { false };
+        value_type          value { };
+    };
+
+    alignas(CACHE_LINE_SIZE) std::atomic<index_type>    top_ { 0 };
+    alignas(CACHE_LINE_SIZE) std::atomic<index_type>    bottom_ { 0 };
+    alignas(CACHE_LINE_SIZE) const index_type           mask_;
+    std::unique_ptr<Slot[]>                             slots_;
+};
+
+} // namespace hmthrp
+
+// ----------------------------------------------------------------------------
+
+#ifndef HMTHRP_DO_NOT_INCLUDE_TCC_FILES
+#  include <Leopard/WorkStealingDeque.tcc>
+#endif // HMTHRP_DO_NOT_INCLUDE_TCC_FILES
+
+// ----------------------------------------------------------------------------
+
+// Local Variables:
+// mode:C++
+// tab-width:4
+// c-basic-offset:4
+// End:
@@ -0,0 +1,168 @@
+// Hossein Moein
+// October 18, 2026
+/*
+Copyright (c) 2023-2028, Hossein Moein
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+* Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+* Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+* Neither the name of Hossein Moein and/or the Leopard nor the
+  names of its contributors may be used to endorse or promote products
+  derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL Hossein Moein BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <Leopard/WorkStealingDeque.h>
+
+#include <bit>
+
+// ----------------------------------------------------------------------------
+
+namespace hmthrp
+{
+
+template<typename T>
+WorkStealingDeque<T>::WorkStealingDeque(size_type capacity)
+    : mask_(index_type(std::bit_ceil(capacity < 2 ? 2 : capacity)) - 1),
+      slots_(std::make_unique<Slot[]>(mask_ + 1))  {   }
+
+// ----------------------------------------------------------------------------
+
+template<typename T>
+bool WorkStealingDeque<T>::push(value_type &&element) noexcept  {
+
+    const index_type    b { bottom_.load(std::memory_order_relaxed) };
+    const index_type    t { top_.load(std::memory_order_acquire) };
+
+    if (b - t > mask_)  return (false);  // Full
+
+    Slot    &slot { slots_[b & mask_] };
+
+    // A thief that claimed this slot on the previous lap may still be moving
+    // its element out
+    //
+    while (slot.full.load(std::memory_order_acquire))
+        cpu_relax();
+
+    slot.value = std::move(element);
+    slot.full.store(true, std::memory_order_relaxed);
+    bottom_.store(b + 1, std::memory_order_release);
+    return (true);
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename T>
+bool WorkStealingDeque<T>::pop(value_type &element) noexcept  {
+
+    const index_type    b { bottom_.load(std::memory_order_relaxed) - 1 };
+
+    bottom_.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    index_type  t { top_.load(std::memory_order_relaxed) };
+
+    if (t > b)  {  // Empty
+        bottom_.store(b + 1, std::memory_order_release);
+        return (false);
+    }
+
+    Slot    &slot { slots_[b & mask_] };
+
+    if (t == b)  {  // Last element. We must race the thieves for it
+        const bool  won {
+            top_.compare_exchange_strong(t, t + 1,
+                                         std::memory_order_seq_cst,
+                                         std::memory_order_relaxed)
+        };
+
+        bottom_.store(b + 1, std::memory_order_release);
+        if (! won)  return (false);
+    }
+
+    element = std::move(slot.value);
+    slot.full.store(false, std::memory_order_release);
+    return (true);
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename T>
+bool WorkStealingDeque<T>::steal(value_type &element) noexcept  {
+
+    while (true)  {
+        index_type  t { top_.load(std::memory_order_acquire) };
+
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        const index_type    b { bottom_.load(std::memory_order_acquire) };
+
+        if (t >= b)  return (false);  // Empty
+
+        if (top_.compare_exchange_strong(t, t + 1,
+                                         std::memory_order_seq_cst,
+                                         std::memory_order_relaxed))  {
+            Slot    &slot { slots_[t & mask_] };
+
+            element = std::move(slot.value);
+            slot.full.store(false, std::memory_order_release);
+            return (true);
+        }
+
+        // We lost the race to another thief or the owner. The bottom we read
+        // may be stale now, so start over.
+        //
+        cpu_relax();
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename T>
+bool WorkStealingDeque<T>::empty() const noexcept  { return (size() == 0); }
+
+// ----------------------------------------------------------------------------
+
+template<typename T>
+typename WorkStealingDeque<T>::size_type
+WorkStealingDeque<T>::size() const noexcept  {
+
+    const index_type    t { top_.load(std::memory_order_acquire) };
+    const index_type    b { bottom_.load(std::memory_order_acquire) };
+
+    return ((b > t) ? size_type(b - t) : 0);
+}
+
+// ----------------------------------------------------------------------------
+
+template<typename T>
+typename WorkStealingDeque<T>::size_type
+WorkStealingDeque<T>::capacity() const noexcept  {
+
+    return (size_type(mask_ + 1));
+}
+
+} // namespace hmthrp
+
+// ----------------------------------------------------------------------------
+
+// Local Variables:
+// mode:C++
+// tab-width:4
+// c-basic-offset:4
+// End:
@@ -16,12 +16,40 @@ SRCS = ../test/thrpool_tester.cc \
        ../test/par_map_reduce.cc \
        ../test/par_partial_sum.cc \
        ../test/par_adjcent_diff.cc \
-       ../test/par_dot_product.cc
-
-HEADERS = $(LOCAL_INCLUDE_DIR)/Leopard/SharedQueue.h \
+       ../test/par_dot_product.cc \
+       ../benchmarks/task_throughput.cc \
+       ../benchmarks/dispatch_overhead.cc \
+       ../benchmarks/task_graph.cc
+
+HEADERS = $(LOCAL_INCLUDE_DIR)/Leopard/BoundedMPMCQueue.h \
+          $(LOCAL_INCLUDE_DIR)/Leopard/BoundedMPMCQueue.tcc \
+          $(LOCAL_INCLUDE_DIR)/Leopard/Cancellation.h \
+          $(LOCAL_INCLUDE_DIR)/Leopard/Cancellation.tcc \
+          $(LOCAL_INCLUDE_DIR)/Leopard/Common.h \
+          $(LOCAL_INCLUDE_DIR)/Leopard/EventCount.h \
+          $(LOCAL_INCLUDE_DIR)/Leopard/EventCount.tcc \
+          $(LOCAL_INCLUDE_DIR)/Leopard/InlineTask.h \
+          $(LOCAL_INCLUDE_DIR)/Leopard/InlineTask.tcc \
+          $(LOCAL_INCLUDE_DIR)/Leopard/MapReduce.h \
+          $(LOCAL_INCLUDE_DIR)/Leopard/MapReduce.tcc \
+          $(LOCAL_INCLUDE_DIR)/Leopard/RecyclingAllocator.h \
+          $(LOCAL_INCLUDE_DIR)/Leopard/RecyclingAllocator.tcc \
+          $(LOCAL_INCLUDE_DIR)/Leopard/SharedQueue.h \
           $(LOCAL_INCLUDE_DIR)/Leopard/SharedQueue.tcc \
+          $(LOCAL_INCLUDE_DIR)/Leopard/Simd.h \
+          $(LOCAL_INCLUDE_DIR)/Leopard/Simd.tcc \
+          $(LOCAL_INCLUDE_DIR)/Leopard/Task.h \
+          $(LOCAL_INCLUDE_DIR)/Leopard/Task.tcc \
+          $(LOCAL_INCLUDE_DIR)/Leopard/TaskGraph.h \
+          $(LOCAL_INCLUDE_DIR)/Leopard/TaskGraph.tcc \
           $(LOCAL_INCLUDE_DIR)/Leopard/ThreadPool.h \
-          $(LOCAL_INCLUDE_DIR)/Leopard/ThreadPool.tcc
+          $(LOCAL_INCLUDE_DIR)/Leopard/ThreadPool.tcc \
+          $(LOCAL_INCLUDE_DIR)/Leopard/TimerWheel.h \
+          $(LOCAL_INCLUDE_DIR)/Leopard/TimerWheel.tcc \
+          $(LOCAL_INCLUDE_DIR)/Leopard/Topology.h \
+          $(LOCAL_INCLUDE_DIR)/Leopard/Topology.tcc \
+          $(LOCAL_INCLUDE_DIR)/Leopard/WorkStealingDeque.h \
+          $(LOCAL_INCLUDE_DIR)/Leopard/WorkStealingDeque.tcc
 
 LIB_NAME =
 TARGET_LIB =
@@ -32,7 +60,10 @@ TARGETS += $(LOCAL_BIN_DIR)/thrpool_tester \
            $(LOCAL_BIN_DIR)/par_map_reduce \
            $(LOCAL_BIN_DIR)/par_partial_sum \
            $(LOCAL_BIN_DIR)/par_adjcent_diff \
-           $(LOCAL_BIN_DIR)/par_dot_product
+           $(LOCAL_BIN_DIR)/par_dot_product \
+           $(LOCAL_BIN_DIR)/task_throughput \
+           $(LOCAL_BIN_DIR)/dispatch_overhead \
+           $(LOCAL_BIN_DIR)/task_graph
 
 # -----------------------------------------------------------------------------
 
@@ -108,6 +139,18 @@ PAR_DOT_PRODUCT_OBJ = $(LOCAL_OBJ_DIR)/par_dot_product.o
 $(LOCAL_BIN_DIR)/par_dot_product: $(PAR_DOT_PRODUCT_OBJ)
 	$(CXX) -o $@ $(PAR_DOT_PRODUCT_OBJ) $(LIBS)
 
+TASK_THROUGHPUT_OBJ = $(LOCAL_OBJ_DIR)/task_throughput.o
+$(LOCAL_BIN_DIR)/task_throughput: $(TASK_THROUGHPUT_OBJ)
+	$(CXX) -o $@ $(TASK_THROUGHPUT_OBJ) $(LIBS)
+
+DISPATCH_OVERHEAD_OBJ = $(LOCAL_OBJ_DIR)/dispatch_overhead.o
+$(LOCAL_BIN_DIR)/dispatch_overhead: $(DISPATCH_OVERHEAD_OBJ)
+	$(CXX) -o $@ $(DISPATCH_OVERHEAD_OBJ) $(LIBS)
+
+TASK_GRAPH_OBJ = $(LOCAL_OBJ_DIR)/task_graph.o
+$(LOCAL_BIN_DIR)/task_graph: $(TASK_GRAPH_OBJ)
+	$(CXX) -o $@ $(TASK_GRAPH_OBJ) $(LIBS)
+
 # -----------------------------------------------------------------------------
 
 depend:
@@ -117,7 +160,8 @@ clobber:
 	rm -f $(LIB_OBJS) $(TARGETS) $(THRPOOL_TESTER_OBJ) $(PAR_SORT_TESTER_OBJ) \
           $(PAR_ACCUMULATE_TESTER_OBJ) $(PAR_MAP_REDUCE_OBJ) \
           $(PAR_PARTIAL_SUM_OBJ) $(PAR_ADJCENT_DIFF_OBJ) \
-          $(PAR_DOT_PRODUCT_OBJ)
+          $(PAR_DOT_PRODUCT_OBJ) $(TASK_THROUGHPUT_OBJ) \
+          $(DISPATCH_OVERHEAD_OBJ) $(TASK_GRAPH_OBJ)
 
 install_lib:
 	cp -pf $(TARGET_LIB) $(PROJECT_LIB_DIR)/.
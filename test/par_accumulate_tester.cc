@@ -33,8 +33,11 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <cstdio>
 #include <cstdlib>
 #include <ctime>
+#include <algorithm>
+#include <functional>
 #include <iostream>
 #include <numeric>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -86,9 +89,96 @@ static void parallel_accumulate()  {
 
 // ----------------------------------------------------------------------------
 
+// Same as above, with the pool folding the blocks
+//
+static void parallel_reduce_accumulate()  {
+
+    std::cout << "Running parallel_reduce_accumulate() ..." << std::endl;
+
+    constexpr std::size_t       n { 1000003 };
+    constexpr std::size_t       the_sum { (n * (n + 1)) / 2 };
+    std::vector<std::size_t>    vec (n);
+    ThreadPool                  thr_pool { THREAD_COUNT };
+
+    std::iota(vec.begin(), vec.end(), 1);
+
+    assert(thr_pool.parallel_reduce(vec.cbegin(), vec.cend(),
+                                    std::size_t(0),
+                                    std::plus<std::size_t> { }) == the_sum);
+    assert(thr_pool.parallel_reduce(vec.cbegin(), vec.cend(),
+                                    std::size_t(10),
+                                    std::plus<std::size_t> { }) ==
+               the_sum + 10);
+
+    // Sum of squares
+    //
+    assert(thr_pool.parallel_transform_reduce(
+               vec.cbegin(), vec.cend(),
+               std::size_t(0),
+               std::plus<std::size_t> { },
+               [](std::size_t x) -> std::size_t  { return (x * x); }) ==
+           (n * (n + 1) * (2 * n + 1)) / 6);
+
+    // Max, with small chunks
+    //
+    auto    max_op =
+        [](std::size_t x, std::size_t y) -> std::size_t  {
+            return (std::max(x, y));
+        };
+
+    std::swap(vec[n / 3], vec.back());
+    assert((thr_pool.parallel_reduce<decltype(vec.cbegin()),
+                                     std::size_t,
+                                     decltype(max_op),
+                                     64L>(vec.cbegin(), vec.cend(),
+                                          std::size_t(0),
+                                          max_op) == n));
+
+    // Empty and tiny ranges
+    //
+    assert(thr_pool.parallel_reduce(vec.cbegin(), vec.cbegin(),
+                                    std::size_t(7),
+                                    std::plus<std::size_t> { }) == 7);
+    assert(thr_pool.parallel_reduce(vec.cbegin(), vec.cbegin() + 3,
+                                    std::size_t(0),
+                                    std::plus<std::size_t> { }) == 6);
+
+    // Without threads, the caller does it all
+    //
+    ThreadPool  empty_pool { 0 };
+
+    assert(empty_pool.parallel_reduce(vec.cbegin(), vec.cend(),
+                                      std::size_t(0),
+                                      std::plus<std::size_t> { }) ==
+               the_sum);
+
+    // The exception of a chunk comes out
+    //
+    bool    caught { false };
+
+    try  {
+        thr_pool.parallel_transform_reduce(
+            vec.cbegin(), vec.cend(),
+            std::size_t(0),
+            std::plus<std::size_t> { },
+            [](std::size_t x) -> std::size_t  {
+                if (x == 777777)  throw std::runtime_error("reduce");
+                return (x);
+            });
+    }
+    catch (const std::runtime_error &ex)  {
+        caught = std::string(ex.what()) == "reduce";
+    }
+    assert(caught);
+    return;
+}
+
+// ----------------------------------------------------------------------------
+
 int main (int, char *[])  {
 
     parallel_accumulate();
+    parallel_reduce_accumulate();
 
     return (EXIT_SUCCESS);
 }
@@ -29,6 +29,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <Leopard/ThreadPool.h>
 
+#include <algorithm>
 #include <cassert>
 #include <cstdio>
 #include <cstdlib>
@@ -118,9 +119,105 @@ static void parallel_adjacent_diff()  {
 
 // ----------------------------------------------------------------------------
 
+// Same as above, with the pool's own adjacent difference. It also runs in
+// place.
+//
+static void builtin_adjacent_diff()  {
+
+    std::cout << "Running builtin_adjacent_diff() ..." << std::endl;
+
+    constexpr std::size_t   n { 1000003 };
+    std::vector<int>        data (n);
+
+    std::iota(data.begin(), data.end(), 1);
+    data[0] = 100;
+    data[5] = 50;
+
+    std::vector<int>    expected (n, 0);
+    std::vector<int>    result (n, 0);
+    ThreadPool          thr_pool { THREAD_COUNT };
+
+    std::adjacent_difference(data.cbegin(), data.cend(), expected.begin());
+    assert(thr_pool.parallel_adjacent_difference(data.cbegin(), data.cend(),
+                                                 result.begin()) ==
+           result.end());
+    assert(result == expected);
+    assert(result[0] == 100);
+    assert(result[1] == -98);
+    assert(result[5] == 45);
+    assert(result[6] == -43);
+
+    thr_pool.parallel_adjacent_difference(data.begin(), data.end(),
+                                          data.begin());
+    assert(data == expected);
+    return;
+}
+
+// ----------------------------------------------------------------------------
+
+// A centered rolling mean and a second difference over a time series. The
+// windows are clipped at both ends of the series.
+//
+static void stencil()  {
+
+    std::cout << "Running stencil() ..." << std::endl;
+
+    constexpr std::size_t   n { 1000003 };
+    constexpr long          radius { 3 };
+    std::vector<double>     series (n);
+
+    for (std::size_t i = 0; i < n; ++i)
+        series[i] = double((i * 37) % 101);
+
+    std::vector<double> means (n);
+    std::vector<double> second_diffs (n);
+    ThreadPool          thr_pool { THREAD_COUNT };
+
+    using citer_t = std::vector<double>::const_iterator;
+
+    assert(thr_pool.parallel_stencil(
+               series.cbegin(), series.cend(),
+               means.begin(),
+               radius,
+               [](citer_t first, citer_t, citer_t last) -> double  {
+                   return (std::accumulate(first, last, 0.0) /
+                           double(last - first));
+               }) == means.end());
+    thr_pool.parallel_stencil(
+        series.cbegin(), series.cend(),
+        second_diffs.begin(),
+        1,
+        [](citer_t first, citer_t center, citer_t last) -> double  {
+            if (first == center || last - center < 2)  return (0);
+            return (*(center + 1) - 2.0 * *center + *(center - 1));
+        });
+
+    for (std::size_t i = 0; i < n; ++i)  {
+        const std::size_t   first { i < radius ? 0 : i - radius };
+        const std::size_t   last { std::min(i + radius + 1, n) };
+        const double        mean {
+            std::accumulate(series.cbegin() + first,
+                            series.cbegin() + last,
+                            0.0) / double(last - first)
+        };
+
+        assert(means[i] == mean);
+        if (i == 0 || i == n - 1)
+            assert(second_diffs[i] == 0);
+        else
+            assert(second_diffs[i] ==
+                   series[i + 1] - 2.0 * series[i] + series[i - 1]);
+    }
+    return;
+}
+
+// ----------------------------------------------------------------------------
+
 int main (int, char *[])  {
 
     parallel_adjacent_diff();
+    builtin_adjacent_diff();
+    stencil();
 
     return (EXIT_SUCCESS);
 }
@@ -30,6 +30,10 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <Leopard/ThreadPool.h>
 
 #include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <functional>
 #include <iostream>
 #include <numeric>
 #include <vector>
@@ -98,9 +102,190 @@ static void parallel_dot_product()  {
 
 // ----------------------------------------------------------------------------
 
+template<typename T>
+static double time_it(const T &func, std::size_t repeat)  {
+
+    const auto  start = std::chrono::steady_clock::now();
+
+    for (std::size_t i = 0; i < repeat; ++i)  func();
+
+    return (std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - start).count());
+}
+
+// ----------------------------------------------------------------------------
+
+static void builtin_dot_product()  {
+
+    std::cout << "Running builtin_dot_product() ..." << std::endl;
+
+    ThreadPool  thr_pool { THREAD_COUNT };
+
+    // Generic path
+    //
+    {
+        constexpr std::size_t       n { 1000003 };
+        std::vector<std::size_t>    data1 (n);
+        std::vector<std::size_t>    data2 (n);
+
+        std::iota(data1.begin(), data1.end(), 1);
+        std::iota(data2.begin(), data2.end(), data1.back() + 1);
+        assert((thr_pool.parallel_inner_product(data1.begin(), data1.end(),
+                                                data2.begin(),
+                                                std::size_t(0)) ==
+                std::inner_product(data1.begin(), data1.end(),
+                                   data2.begin(), std::size_t(0))));
+
+        // Count of equal elements
+        //
+        assert((thr_pool.parallel_inner_product(
+                    data1.begin(), data1.end(), data1.begin(), 5L,
+                    std::plus<long>{ }, std::equal_to<>{ }) == long(n + 5)));
+    }
+
+    // Vector path. An odd size and offset starts make the head and tail
+    // chunks uneven.
+    //
+    {
+        constexpr std::size_t       n { 10000019 };
+        std::vector<std::int32_t>   idata1 (n);
+        std::vector<std::int32_t>   idata2 (n);
+
+        for (std::size_t i = 0; i < n; ++i)  {
+            idata1[i] = std::int32_t(i % 2001) - 1000;
+            idata2[i] = std::int32_t(i % 997) - 498;
+        }
+
+        long    expected { 7 };
+
+        for (std::size_t i = 1; i < n; ++i)
+            expected += long(idata1[i]) * long(idata2[i]);
+        assert((thr_pool.parallel_inner_product(idata1.begin() + 1,
+                                                idata1.end(),
+                                                idata2.begin() + 1,
+                                                7L) == expected));
+        assert((thr_pool.parallel_inner_product(idata1.begin(),
+                                                idata1.begin(),
+                                                idata2.begin(),
+                                                7L) == 7));
+
+        std::vector<double> ddata1 (n);
+        std::vector<double> ddata2 (n);
+
+        for (std::size_t i = 0; i < n; ++i)  {
+            ddata1[i] = double(idata1[i]) / 8.0;
+            ddata2[i] = double(idata2[i]) / 4.0;
+        }
+
+        // Exact in double, so the order of the adds doesn't matter
+        //
+        assert((thr_pool.parallel_inner_product(ddata1.begin() + 3,
+                                                ddata1.end(),
+                                                ddata2.begin() + 3,
+                                                0.0) ==
+                std::inner_product(ddata1.begin() + 3, ddata1.end(),
+                                   ddata2.begin() + 3, 0.0)));
+
+        std::vector<float>  fdata1 (n);
+        std::vector<float>  fdata2 (n);
+
+        for (std::size_t i = 0; i < n; ++i)  {
+            fdata1[i] = float(i % 101) / 101.0f;
+            fdata2[i] = float(i % 103) / 103.0f;
+        }
+
+        double  fexpected { 0 };
+
+        for (std::size_t i = 0; i < n; ++i)
+            fexpected += double(fdata1[i]) * double(fdata2[i]);
+
+        const float fresult =
+            thr_pool.parallel_inner_product(fdata1.begin(), fdata1.end(),
+                                            fdata2.begin(), 0.0f);
+
+        assert((std::fabs(fresult - fexpected) / fexpected < 1e-4));
+
+        for (auto level : { SIMD_LEVEL::_scalar_, SIMD_LEVEL::_avx2_,
+                            SIMD_LEVEL::_avx512_ })  {
+            assert((simd_dot(idata1.data() + 5, idata2.data() + 5, n - 9,
+                             level) ==
+                    std::inner_product(idata1.begin() + 5,
+                                       idata1.end() - 4,
+                                       idata2.begin() + 5,
+                                       std::int64_t(0),
+                                       std::plus<>{ },
+                                       [](std::int64_t x,
+                                          std::int64_t y)  {
+                                           return (x * y);
+                                       })));
+
+            // Short enough for a float accumulator
+            //
+            constexpr std::size_t   short_n { 100003 };
+            double                  short_expected { 0 };
+
+            for (std::size_t i = 0; i < short_n; ++i)
+                short_expected += double(fdata1[i]) * double(fdata2[i]);
+            assert((std::fabs(simd_dot(fdata1.data(), fdata2.data(),
+                                       short_n, level) - short_expected) /
+                    short_expected < 1e-4));
+        }
+    }
+
+    // Speedups. Vector over scalar on one thread with the data in cache,
+    // then the pool over one thread on data that isn't.
+    //
+    {
+        constexpr std::size_t   small_n { 4096 };
+        constexpr std::size_t   repeat { 20000 };
+        std::vector<float>      data1 (small_n, 0.5f);
+        std::vector<float>      data2 (small_n, 2.0f);
+        float                   sink { 0 };
+        const double            scalar_time =
+            time_it([&]() -> void  {
+                        sink += simd_dot(data1.data(), data2.data(), small_n,
+                                         SIMD_LEVEL::_scalar_);
+                    }, repeat);
+        const double            vector_time =
+            time_it([&]() -> void  {
+                        sink += simd_dot(data1.data(), data2.data(), small_n);
+                    }, repeat);
+
+        std::cout << "SIMD level: " << int(simd_level())
+                  << ", vector over scalar speedup: "
+                  << scalar_time / vector_time << std::endl;
+        assert((sink == float(2 * repeat * small_n)));
+    }
+    {
+        constexpr std::size_t   n { 50000000 };
+        constexpr std::size_t   repeat { 10 };
+        std::vector<float>      data1 (n, 0.5f);
+        std::vector<float>      data2 (n, 0.25f);
+        double                  sink { 0 };
+        const double            single_time =
+            time_it([&]() -> void  {
+                        sink += simd_dot(data1.data(), data2.data(), n);
+                    }, repeat);
+        const double            pool_time =
+            time_it([&]() -> void  {
+                        sink += thr_pool.parallel_inner_product(
+                                    data1.begin(), data1.end(),
+                                    data2.begin(), 0.0f);
+                    }, repeat);
+
+        std::cout << "Pool over single thread speedup: "
+                  << single_time / pool_time << std::endl;
+        assert((sink > 0));
+    }
+    return;
+}
+
+// ----------------------------------------------------------------------------
+
 int main (int, char *[])  {
 
     parallel_dot_product();
+    builtin_dot_product();
 
     return (EXIT_SUCCESS);
 }
@@ -30,11 +30,13 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <Leopard/ThreadPool.h>
 
 #include <algorithm>
+#include <cassert>
 #include <chrono>
 #include <cstdint>
 #include <iostream>
 #include <numeric>
 #include <random>
+#include <stdexcept>
 #include <string>
 #include <vector>
 #include <unordered_map>
@@ -131,14 +133,10 @@ struct  ReduceFunc  {
 
 // -----------------------------------------------------------------------------
 
-static void par_map_reduce()  {
+static WordCountMap par_map_reduce()  {
 
     std::cout << "Running par_map_reduce() ..." << std::endl;
 
-    generate_data();
-
-    std::cout << "Done generating data ..." << std::endl;
-
     ThreadPool  thr_pool (THREAD_COUNT);
     const auto  start = std::chrono::high_resolution_clock::now();
 
@@ -212,12 +210,92 @@ static void par_map_reduce()  {
               << std::chrono::duration_cast
                      <std::chrono::duration<double>>(last - start).count()
               << std::endl;
+    return (final_map);
+}
+
+// -----------------------------------------------------------------------------
+
+static void map_reduce_engine(const WordCountMap &expected)  {
+
+    std::cout << "Running map_reduce_engine() ..." << std::endl;
+
+    using WordCount = MapReduce<std::string, std::size_t>;
+
+    ThreadPool  thr_pool (THREAD_COUNT);
+    WordCount   counts;
+    const auto  start = std::chrono::high_resolution_clock::now();
+
+    thr_pool.run_map_reduce(
+        counts, data.begin(), data.end(),
+        [](const WordVector &words, WordCount::Emitter &emitter) -> void  {
+            for (const auto &word : words)
+                emitter.emit(word, 1);
+        });
+
+    const auto  last = std::chrono::high_resolution_clock::now();
+
+    std::cout << "Calculation Time: "
+              << "Overall Time: "
+              << std::chrono::duration_cast
+                     <std::chrono::duration<double>>(last - start).count()
+              << std::endl;
+
+    assert(counts.size() == expected.size());
+    counts.for_each([&expected](const std::string &word,
+                                std::size_t count) -> void  {
+                        assert(expected.at(word) == count);
+                    });
+    assert(*counts.find(expected.begin()->first) ==
+           expected.begin()->second);
+    assert(counts.find("ABCDEFG") == nullptr);
+
+    // A second run replaces the results, with as many partitions as asked
+    //
+    WordCount   firsts (3);
+
+    thr_pool.run_map_reduce(
+        firsts, data.begin(), data.begin() + 10,
+        [](const WordVector &words, WordCount::Emitter &emitter) -> void  {
+            emitter.emit(std::string(1, words.front().front()), 1);
+        });
+    assert(firsts.partitions() == 3);
+    assert(firsts.size() <= 7);
+
+    std::size_t total { 0 };
+
+    firsts.for_each([&total](const std::string &,
+                             std::size_t count) -> void  {
+                        total += count;
+                    });
+    assert(total == 10);
+
+    // Exceptions reach the caller and leave nothing behind
+    //
+    try  {
+        thr_pool.run_map_reduce(
+            firsts, data.begin(), data.end(),
+            [](const WordVector &words, WordCount::Emitter &) -> void  {
+                if (&words == &data[500])
+                    throw std::runtime_error("map failed");
+            });
+        assert(false);
+    }
+    catch (const std::runtime_error &)  {
+        assert(firsts.empty());
+    }
     return;
 }
 
+// -----------------------------------------------------------------------------
+
 int main(int, char *[]) {
 
-    par_map_reduce();
+    generate_data();
+    std::cout << "Done generating data ..." << std::endl;
+
+    const WordCountMap  expected = par_map_reduce();
+
+    map_reduce_engine(expected);
 
     return (EXIT_SUCCESS);
 }
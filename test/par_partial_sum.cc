@@ -29,10 +29,13 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <Leopard/ThreadPool.h>
 
+#include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <cstdio>
 #include <cstdlib>
 #include <ctime>
+#include <functional>
 #include <iostream>
 #include <iterator>
 #include <numeric>
@@ -124,9 +127,164 @@ static void parallel_partial_sum()  {
 
 // ----------------------------------------------------------------------------
 
-int main (int, char *[])  {
+// Same as above, as a graph. The blocks are summed in parallel, and the last
+// value of the previous block is added to a block after both are done. So,
+// no task waits for another one.
+//
+static void graph_partial_sum()  {
+
+    std::cout << "Running graph_partial_sum() ..." << std::endl;
+
+    constexpr std::size_t       n { 1000003 };
+    std::vector<std::size_t>    data (n);
+
+    std::iota(data.begin(), data.end(), 1);
+
+    std::vector<std::size_t>    result (n, 0);
+    constexpr std::size_t       block_size { n / THREAD_COUNT };
+    ThreadPool                  thr_pool { THREAD_COUNT };
+    TaskGraph                   graph;
+    TaskGraph::node_type        prev_block { 0 };
+
+    for (std::size_t i = 0; i < n; i += block_size)  {
+        const std::size_t  block_end {
+            ((i + block_size) > n) ? n : i + block_size
+        };
+        const auto         sum {
+            graph.add_node([&data, &result, i, block_end]() -> void  {
+                               std::partial_sum(data.begin() + i,
+                                                data.begin() + block_end,
+                                                result.begin() + i);
+                           })
+        };
+
+        if (i == 0)  {
+            prev_block = sum;
+            continue;
+        }
+
+        const auto  add_prev {
+            graph.add_node([&result, i, block_end]() -> void  {
+                               const std::size_t   prev_value {
+                                   result[i - 1]
+                               };
+
+                               for (std::size_t j = i; j < block_end; ++j)
+                                   result[j] += prev_value;
+                           })
+        };
+
+        graph.add_edge(sum, add_prev);
+        graph.add_edge(prev_block, add_prev);
+        prev_block = add_prev;
+    }
+    thr_pool.run_graph(graph);
+
+    constexpr std::size_t   last_sum { (n * (n + 1)) / 2 };
+
+    assert(result.back() == last_sum);
+    return;
+}
+
+// ----------------------------------------------------------------------------
+
+// Same as above, with the pool's own scans. Both passes are fully parallel
+// and no task waits for another one.
+//
+static void builtin_partial_sum()  {
+
+    std::cout << "Running builtin_partial_sum() ..." << std::endl;
+
+    constexpr std::size_t       n { 1000003 };
+    std::vector<std::size_t>    data (n);
+
+    std::iota(data.begin(), data.end(), 1);
+
+    std::vector<std::size_t>    result (n, 0);
+    ThreadPool                  thr_pool { THREAD_COUNT };
+    constexpr std::size_t       last_sum { (n * (n + 1)) / 2 };
+
+    assert(thr_pool.parallel_inclusive_scan(data.cbegin(), data.cend(),
+                                            result.begin()) == result.end());
+    assert(result.back() == last_sum);
+
+    thr_pool.parallel_exclusive_scan(data.cbegin(), data.cend(),
+                                     result.begin(),
+                                     std::size_t(0));
+    assert(result.front() == 0);
+    assert(result.back() == last_sum - n);
+
+    // Sum of squares
+    //
+    thr_pool.parallel_inclusive_scan(
+        data.cbegin(), data.cend(),
+        result.begin(),
+        std::plus<std::size_t> { },
+        [](std::size_t x) -> std::size_t  { return (x * x); });
+    assert(result.back() == (n * (n + 1) * (2 * n + 1)) / 6);
+
+    // Running max, which is not a sum
+    //
+    std::vector<long>   prices (n);
+
+    for (std::size_t i = 0; i < n; ++i)
+        prices[i] = long((i * 7919) % 1000);
+
+    std::vector<long>   expected (n);
+
+    std::inclusive_scan(prices.cbegin(), prices.cend(), expected.begin(),
+                        [](long x, long y) -> long  {
+                            return (std::max(x, y));
+                        });
+    thr_pool.parallel_inclusive_scan(prices.cbegin(), prices.cend(),
+                                     prices.begin(),  // In place
+                                     [](long x, long y) -> long  {
+                                         return (std::max(x, y));
+                                     });
+    assert(prices == expected);
+    return;
+}
+
+// ----------------------------------------------------------------------------
+
+// Timing of an in place scan against std::inclusive_scan. It only runs if
+// the size is given on the command line, e.g. 100000000.
+//
+static void scan_compare(std::size_t n)  {
+
+    std::cout << "Running scan_compare() ..." << std::endl;
+
+    ThreadPool                  thr_pool { THREAD_COUNT };
+    std::vector<std::size_t>    data (n, 1);
+    const auto                  first = std::chrono::steady_clock::now();
+
+    thr_pool.parallel_inclusive_scan(data.begin(), data.end(), data.begin());
+
+    const auto  second = std::chrono::steady_clock::now();
+
+    assert(data.back() == n);
+    std::inclusive_scan(data.begin(), data.end(), data.begin());
+
+    const auto  third = std::chrono::steady_clock::now();
+
+    assert(data.back() == (n * (n + 1)) / 2);
+    std::cout << "Scanning " << n << " items time: "
+              << std::chrono::duration<double>(second - first).count()
+              << " secs, std::inclusive_scan: "
+              << std::chrono::duration<double>(third - second).count()
+              << " secs" << std::endl;
+    return;
+}
+
+// ----------------------------------------------------------------------------
+
+int main (int argc, char *argv [])  {
 
     parallel_partial_sum();
+    graph_partial_sum();
+    builtin_partial_sum();
+    if (argc > 1)
+        scan_compare(std::strtoul(argv[1], nullptr, 10));
 
     return (EXIT_SUCCESS);
 }
@@ -32,13 +32,19 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <algorithm>
 #include <cassert>
 #include <chrono>
+#include <cmath>
+#include <cstdint>
 #include <cstdio>
 #include <cstdlib>
+#include <deque>
 #include <iostream>
+#include <limits>
 #include <list>
 #include <numeric>
+#include <random>
 #include <stack>
 #include <string>
+#include <vector>
 
 using namespace hmthrp;
 using namespace std::chrono;
@@ -365,13 +371,463 @@ static void interative_sort()  {
 
 // ----------------------------------------------------------------------------
 
-int main (int, char *[])  {
+// This is the recursive quick sort that ThreadPool::parallel_sort() used
+// before it became a sample sort. The top-level partition runs on one
+// thread.
+//
+template<typename I, typename P, long TH = 5000L>
+static void quick_sort(const I begin, const I end, P compare,
+                       ThreadPool &thr_pool)  {
+
+    if (begin >= end) return;
+
+    const long  data_size = std::distance(begin, end);
+
+    if (data_size <= TH)  {
+        std::sort(begin, end, compare);
+        return;
+    }
+
+    auto        mid = begin + (data_size / 2);
+    auto        pivot_it = _median_of_three_(begin, mid, end - 1, compare);
+    const auto  pivot = *pivot_it;
+
+    std::iter_swap(pivot_it, end - 1);
+
+    auto    cut =
+        std::ranges::partition(begin, end - 1,
+                               [&pivot, &compare](const auto &x) -> bool {
+                                   return (compare(x, pivot));
+                               });
+
+    std::iter_swap(cut.begin(), end - 1);
+
+    TaskGroup   group { thr_pool.make_group() };
+
+    group.run(quick_sort<I, P, TH>,
+              begin,
+              cut.begin(),
+              compare,
+              std::ref(thr_pool));
+    quick_sort<I, P, TH>(cut.begin() + 1, end, compare, thr_pool);
+    group.wait();
+}
+
+// --------------------------------------
+
+// The same data is sorted by the sample sort of parallel_sort(), by the
+// old quick sort above, and by std::sort.
+// Sizes go up to max_n, which may be given on the command line. The default
+// is the smallest size, so ctest runs stay short. One billion needs about
+// 18 GB of memory.
+//
+static void sample_sort_compare(std::size_t max_n)  {
+
+    std::cout << "Running sample_sort_compare() ..." << std::endl;
+
+    ThreadPool  thr_pool { };
+    const auto  run =
+        [](const char *name, std::size_t n, auto &&sorter) -> void  {
+            std::vector<double> data (n);
+
+            ::srand(10);
+            for (auto &iter : data) iter = ::rand();
+
+            const auto  first = high_resolution_clock::now();
+
+            sorter(data);
+
+            const auto  second = high_resolution_clock::now();
+
+            std::cout << name << ' ' << n << " items time: "
+                      << double(duration_cast<microseconds>(
+                             second - first).count()) / 1000000.0
+                      << " secs" << std::endl;
+
+            assert(std::is_sorted(data.cbegin(), data.cend()));
+        };
+
+    for (const std::size_t n : { 10'000'000UL,
+                                 100'000'000UL,
+                                 1'000'000'000UL })  {
+        if (n > max_n)  break;
+
+        run("Sample sort", n,
+            [&thr_pool](std::vector<double> &data) -> void  {
+                thr_pool.parallel_sort(data.begin(), data.end());
+            });
+        run("Quick sort ", n,
+            [&thr_pool](std::vector<double> &data) -> void  {
+                quick_sort(data.begin(), data.end(),
+                           std::less<double> { },
+                           thr_pool);
+            });
+        run("std::sort  ", n,
+            [](std::vector<double> &data) -> void  {
+                std::sort(data.begin(), data.end());
+            });
+    }
+    return;
+}
+
+// ----------------------------------------------------------------------------
+
+// Integral and floating point keys, and records by key, sorted by
+// parallel_radix_sort() and checked against std::sort.
+//
+static void radix_sort_compare(std::size_t max_n)  {
+
+    std::cout << "Running radix_sort_compare() ..." << std::endl;
+
+    ThreadPool      thr_pool { };
+    std::mt19937_64 gen { 17 };
+
+    // Against std::sort, above and below the threshold
+    //
+    const auto  check =
+        [&thr_pool, &gen]<typename T>(std::size_t n, T low, T high) -> void  {
+            std::vector<T>  data (n);
+
+            if constexpr (std::floating_point<T>)  {
+                std::uniform_real_distribution<T>   dist { low, high };
+
+                for (auto &iter : data)  iter = dist(gen);
+            }
+            else  {
+                std::uniform_int_distribution<T>    dist { low, high };
+
+                for (auto &iter : data)  iter = dist(gen);
+            }
+
+            std::vector<T>  expected { data };
+
+            std::sort(expected.begin(), expected.end());
+            thr_pool.parallel_radix_sort(data.begin(), data.end());
+            assert(data == expected);
+        };
+
+    for (const std::size_t n : { 0UL, 1UL, 1000UL, 500'000UL })  {
+        check(n, std::numeric_limits<int>::min(),
+              std::numeric_limits<int>::max());
+        check(n, std::uint64_t(0), std::numeric_limits<std::uint64_t>::max());
+        check(n, -1000L, 1000L);  // Most passes are skipped
+        check(n, std::int16_t(-300), std::int16_t(300));
+        check(n, -1.0e6, 1.0e6);
+        check(n, -1.0f, 1.0f);
+    }
+
+    // Floating point specials
+    //
+    constexpr double    inf { std::numeric_limits<double>::infinity() };
+    std::vector<double> specials (100'000, 1.5);
+
+    specials[10] = inf;
+    specials[20] = -0.0;
+    specials[30] = 0.0;
+    specials[40] = -inf;
+    specials[50] = -1.0e300;
+    thr_pool.parallel_radix_sort(specials.begin(), specials.end());
+    assert(specials[0] == -inf);
+    assert(specials[1] == -1.0e300);
+    assert(specials[2] == 0.0 && std::signbit(specials[2]));
+    assert(specials[3] == 0.0 && ! std::signbit(specials[3]));
+    assert(specials[4] == 1.5);
+    assert(specials.back() == inf);
+
+    // Not contiguous
+    //
+    std::deque<long>    deq (200'000);
+
+    for (auto &iter : deq)  iter = long(gen() % 100'000) - 50'000;
+    thr_pool.parallel_radix_sort(deq.begin(), deq.end());
+    assert(std::is_sorted(deq.begin(), deq.end()));
+
+    // Records by key are sorted stably, with and without a scratch buffer
+    //
+    struct  Order  {
+
+        double      price { 0 };
+        std::size_t seq { 0 };
+    };
+    struct  Event  {
+
+        Event(std::int64_t t, std::size_t s) : time(t), seq(s)  {   }
+
+        std::int64_t    time;
+        std::size_t     seq;
+    };
+
+    std::vector<Order>  orders (300'000);
+    std::vector<Event>  events;
+
+    for (std::size_t i = 0; i < orders.size(); ++i)  {
+        orders[i] = { double(gen() % 500) / 4.0 - 50.0, i };
+        events.emplace_back(std::int64_t(gen() % 1000) - 500, i);
+    }
+    thr_pool.parallel_radix_sort(orders.begin(), orders.end(),
+                                 [](const Order &o)  { return (o.price); });
+    thr_pool.parallel_radix_sort(events.begin(), events.end(), &Event::time);
+    for (std::size_t i = 1; i < orders.size(); ++i)  {
+        assert(orders[i - 1].price < orders[i].price ||
+               (orders[i - 1].price == orders[i].price &&
+                orders[i - 1].seq < orders[i].seq));
+        assert(events[i - 1].time < events[i].time ||
+               (events[i - 1].time == events[i].time &&
+                events[i - 1].seq < events[i].seq));
+    }
+
+    // A tiny threshold, so the last blocks of a few items may be short or
+    // not there at all
+    //
+    {
+        ThreadPool  small_pool { 3 };
+        const auto  price = [](const Order &o)  { return (o.price); };
+
+        for (std::size_t n = 2; n < 40; ++n)  {
+            std::vector<long>   vals (n);
+            std::vector<Order>  recs (n);
+
+            for (std::size_t i = 0; i < n; ++i)  {
+                vals[i] = long(gen() % 100) - 50;
+                recs[i] = { double(gen() % 10), i };
+            }
+            small_pool.parallel_radix_sort<
+                std::vector<long>::iterator, 1L>(vals.begin(), vals.end());
+            small_pool.parallel_radix_sort<
+                std::vector<Order>::iterator, decltype(price), 1L>(
+                    recs.begin(), recs.end(), price);
+            assert(std::is_sorted(vals.begin(), vals.end()));
+            for (std::size_t i = 1; i < n; ++i)
+                assert(recs[i - 1].price < recs[i].price ||
+                       (recs[i - 1].price == recs[i].price &&
+                        recs[i - 1].seq < recs[i].seq));
+        }
+    }
+
+    // Timing against std::sort
+    //
+    for (const std::size_t n : { 10'000'000UL,
+                                 100'000'000UL,
+                                 1'000'000'000UL })  {
+        if (n > max_n)  break;
+
+        std::vector<std::uint64_t>  stamps (n);
+
+        for (auto &iter : stamps)  iter = gen() >> 8;
+
+        std::vector<std::uint64_t>  copy { stamps };
+        const auto                  first = high_resolution_clock::now();
+
+        thr_pool.parallel_radix_sort(stamps.begin(), stamps.end());
+
+        const auto  second = high_resolution_clock::now();
+
+        std::sort(copy.begin(), copy.end());
+
+        const auto  third = high_resolution_clock::now();
+
+        std::cout << "Radix sorting " << n << " items time: "
+                  << double(duration_cast<microseconds>(
+                         second - first).count()) / 1000000.0
+                  << " secs, std::sort: "
+                  << double(duration_cast<microseconds>(
+                         third - second).count()) / 1000000.0
+                  << " secs" << std::endl;
+        assert(stamps == copy);
+    }
+    return;
+}
+
+// ----------------------------------------------------------------------------
+
+// Events with many equal timestamps, sorted by parallel_stable_sort() and by
+// std::stable_sort(). Since both are stable, the results must be identical.
+//
+static void stable_sort_compare(std::size_t max_n)  {
+
+    std::cout << "Running stable_sort_compare() ..." << std::endl;
+
+    struct  Event  {
+
+        int         time { 0 };
+        unsigned    seq { 0 };
+
+        bool operator == (const Event &) const = default;
+    };
+
+    ThreadPool  thr_pool { };
+    const auto  by_time =
+        [](const Event &lhs, const Event &rhs) -> bool  {
+            return (lhs.time < rhs.time);
+        };
+
+    for (const std::size_t n : { 10'000'000UL,
+                                 100'000'000UL,
+                                 1'000'000'000UL })  {
+        if (n > max_n)  break;
+
+        std::vector<Event>  data (n);
+
+        ::srand(10);
+        for (std::size_t i = 0; i < n; ++i)
+            data[i] = { ::rand() % 100'000, unsigned(i) };
+
+        std::vector<Event>  expected { data };
+        const auto          first = high_resolution_clock::now();
+
+        thr_pool.parallel_stable_sort(data.begin(), data.end(), by_time);
+
+        const auto  second = high_resolution_clock::now();
+
+        std::stable_sort(expected.begin(), expected.end(), by_time);
+
+        const auto  third = high_resolution_clock::now();
+
+        std::cout << "Stable sorting " << n << " items time: "
+                  << double(duration_cast<microseconds>(
+                         second - first).count()) / 1000000.0
+                  << " secs, std::stable_sort: "
+                  << double(duration_cast<microseconds>(
+                         third - second).count()) / 1000000.0
+                  << " secs" << std::endl;
+
+        assert(data == expected);
+    }
+    return;
+}
+
+// ----------------------------------------------------------------------------
+
+static void selection_compare(std::size_t max_n)  {
+
+    std::cout << "Running selection_compare() ..." << std::endl;
+
+    ThreadPool  thr_pool { };
+
+    for (const std::size_t n : { 10'000'000UL,
+                                 100'000'000UL,
+                                 1'000'000'000UL })  {
+        if (n > max_n)  break;
+
+        std::vector<double> data (n);
+
+        ::srand(20);
+        for (std::size_t i = 0; i < n; ++i)
+            data[i] = double(::rand()) / double(RAND_MAX);
+
+        // The 99th percentile
+        //
+        const std::size_t   pct { n / 100 * 99 };
+        std::vector<double> expected { data };
+        auto                first = high_resolution_clock::now();
+
+        thr_pool.parallel_nth_element(data.begin(), data.begin() + pct,
+                                      data.end());
+
+        auto    second = high_resolution_clock::now();
+
+        std::nth_element(expected.begin(), expected.begin() + pct,
+                         expected.end());
+
+        auto    third = high_resolution_clock::now();
+
+        std::cout << "nth_element of " << n << " items time: "
+                  << double(duration_cast<microseconds>(
+                         second - first).count()) / 1000000.0
+                  << " secs, std::nth_element: "
+                  << double(duration_cast<microseconds>(
+                         third - second).count()) / 1000000.0
+                  << " secs" << std::endl;
+        assert(data[pct] == expected[pct]);
+        assert((std::all_of(data.begin(), data.begin() + pct,
+                            [&data, pct](double x) -> bool  {
+                                return (x <= data[pct]);
+                            })));
+
+        // The smallest 1000, in order
+        //
+        constexpr std::size_t   k { 1000 };
+
+        first = high_resolution_clock::now();
+        thr_pool.parallel_partial_sort(data.begin(), data.begin() + k,
+                                       data.end());
+        second = high_resolution_clock::now();
+        std::partial_sort(expected.begin(), expected.begin() + k,
+                          expected.end());
+        third = high_resolution_clock::now();
+
+        std::cout << "partial_sort of " << k << " from " << n
+                  << " items time: "
+                  << double(duration_cast<microseconds>(
+                         second - first).count()) / 1000000.0
+                  << " secs, std::partial_sort: "
+                  << double(duration_cast<microseconds>(
+                         third - second).count()) / 1000000.0
+                  << " secs" << std::endl;
+        assert((std::equal(data.begin(), data.begin() + k,
+                           expected.begin())));
+
+        // The largest 1000, in order. data is not changed by top_k.
+        //
+        std::vector<double> top (k);
+
+        first = high_resolution_clock::now();
+
+        const auto  result =
+            thr_pool.parallel_top_k(data.begin(), data.end(), k);
+
+        second = high_resolution_clock::now();
+        std::partial_sort_copy(expected.begin(), expected.end(),
+                               top.begin(), top.end(),
+                               std::greater<double>{ });
+        third = high_resolution_clock::now();
+
+        std::cout << "top_k of " << k << " from " << n
+                  << " items time: "
+                  << double(duration_cast<microseconds>(
+                         second - first).count()) / 1000000.0
+                  << " secs, std::partial_sort_copy: "
+                  << double(duration_cast<microseconds>(
+                         third - second).count()) / 1000000.0
+                  << " secs" << std::endl;
+        assert(result == top);
+    }
+
+    // Edge cases: many duplicates, k of 0, k bigger than the range, and a
+    // compare other than the default
+    //
+    std::vector<int>    dups (1'000'000);
+
+    for (std::size_t i = 0; i < dups.size(); ++i)
+        dups[i] = int(i % 7);
+    thr_pool.parallel_nth_element(dups.begin(), dups.begin() + 500'000,
+                                  dups.end(), std::greater<int>{ });
+    assert(dups[500'000] == 3);
+    assert(thr_pool.parallel_top_k(dups.begin(), dups.end(), 0).empty());
+    assert((thr_pool.parallel_top_k(dups.begin(), dups.begin() + 3, 10,
+                                    std::less<int>{ }).size() == 3));
+    return;
+}
+
+// ----------------------------------------------------------------------------
+
+int main (int argc, char *argv [])  {
 
     parallel_sort1();
     parallel_sort2();
     standard_sort();
     interative_sort();
 
+    // Give 100000000 or 1000000000 for the bigger comparisons
+    //
+    const std::size_t   max_n =
+        argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10'000'000UL;
+
+    sample_sort_compare(max_n);
+    radix_sort_compare(max_n);
+    stable_sort_compare(max_n);
+    selection_compare(max_n);
+
     return (EXIT_SUCCESS);
 }
 
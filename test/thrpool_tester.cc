@@ -29,15 +29,23 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <Leopard/ThreadPool.h>
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <chrono>
 #include <cstdio>
 #include <cstdlib>
 #include <ctime>
+#include <exception>
+#include <functional>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <numeric>
+#include <random>
 #include <stdexcept>
 #include <string>
+#include <thread>
 #include <vector>
 
 using namespace hmthrp;
@@ -445,6 +453,1583 @@ static void parallel_sort_test()  {
 
 // ----------------------------------------------------------------------------
 
+static void work_stealing_deque_test()  {
+
+    std::cout << "Running work_stealing_deque_test() ..." << std::endl;
+
+    constexpr std::size_t           n { 1'000'000 };
+    constexpr std::size_t           thieves_n { 3 };
+    WorkStealingDeque<std::size_t>  deque { 256 };
+    std::vector<std::atomic_int>    seen (n);
+    std::atomic_bool                done { false };
+    std::vector<std::thread>        thieves;
+
+    for (std::size_t t = 0; t < thieves_n; ++t)
+        thieves.emplace_back([&deque, &seen, &done]() -> void {
+                                 std::size_t    value;
+
+                                 while (! done.load())
+                                     if (deque.steal(value))
+                                         ++seen[value];
+                             });
+
+    // The owner pushes everything and pops every third element itself
+    //
+    for (std::size_t i = 0; i < n; ++i)  {
+        std::size_t value { i };
+
+        while (! deque.push(std::move(value)))
+            std::this_thread::yield();
+        if (i % 3 == 0 && deque.pop(value))
+            ++seen[value];
+    }
+
+    std::size_t value;
+
+    while (deque.pop(value))
+        ++seen[value];
+    while (! deque.empty())
+        std::this_thread::yield();
+    done = true;
+    for (auto &thr : thieves)
+        thr.join();
+
+    for (const auto &citer : seen)
+        assert(citer == 1);
+}
+
+// ----------------------------------------------------------------------------
+
+static std::atomic<std::size_t> FORK_JOIN_LEAVES { 0 };
+
+static void fork_join(ThreadPool &thr_pool, std::size_t depth)  {
+
+    if (depth == 0)  {
+        ++FORK_JOIN_LEAVES;
+        return;
+    }
+
+    auto    lf = thr_pool.dispatch(false, fork_join,
+                                   std::ref(thr_pool), depth - 1);
+    auto    rf = thr_pool.dispatch(false, fork_join,
+                                   std::ref(thr_pool), depth - 1);
+
+    while (lf.wait_for(seconds(0)) == std::future_status::timeout)
+        thr_pool.run_task();
+    while (rf.wait_for(seconds(0)) == std::future_status::timeout)
+        thr_pool.run_task();
+}
+
+// --------------------------------------
+
+static void nested_dispatch_test()  {
+
+    std::cout << "Running nested_dispatch_test() ..." << std::endl;
+
+    constexpr std::size_t   depth { 16 };
+    ThreadPool              thr_pool { THREAD_COUNT };
+
+    FORK_JOIN_LEAVES = 0;
+    thr_pool.dispatch(false, fork_join, std::ref(thr_pool), depth).get();
+    assert(FORK_JOIN_LEAVES == (std::size_t(1) << depth));
+}
+
+// ----------------------------------------------------------------------------
+
+static void steal_half_test()  {
+
+    std::cout << "Running steal_half_test() ..." << std::endl;
+
+    constexpr std::size_t   depth { 14 };
+    constexpr std::size_t   tasks { (std::size_t(1) << (depth + 1)) - 1 };
+    PoolOptions             options { };
+
+    options.steal_half = true;
+
+    ThreadPool  thr_pool { THREAD_COUNT, options };
+
+    FORK_JOIN_LEAVES = 0;
+    thr_pool.dispatch(false, fork_join, std::ref(thr_pool), depth).get();
+    assert(FORK_JOIN_LEAVES == (std::size_t(1) << depth));
+
+    const auto  stats = thr_pool.worker_stats();
+    WorkerStats total { };
+
+    assert(stats.size() == std::size_t(THREAD_COUNT));
+    for (const auto &stat : stats)  {
+        std::cout << "executed: " << stat.executed
+                  << ", steals: " << stat.steals
+                  << ", stolen: " << stat.stolen
+                  << ", stolen_from: " << stat.stolen_from << std::endl;
+        total.executed += stat.executed;
+        total.steals += stat.steals;
+        total.stolen += stat.stolen;
+        total.stolen_from += stat.stolen_from;
+    }
+
+    // Only the pool threads ran and stole tasks
+    //
+    assert(total.executed == tasks);
+    assert(total.stolen == total.stolen_from);
+    assert(total.steals <= total.stolen);
+}
+
+// ----------------------------------------------------------------------------
+
+static void bounded_mpmc_queue_test()  {
+
+    std::cout << "Running bounded_mpmc_queue_test() ..." << std::endl;
+
+    constexpr std::size_t           n { 200'000 };
+    constexpr std::size_t           producers_n { 3 };
+    constexpr std::size_t           consumers_n { 3 };
+    BoundedMPMCQueue<std::size_t>   queue { 512 };
+    std::vector<std::atomic_int>    seen (n * producers_n);
+    std::atomic<std::size_t>        consumed { 0 };
+    std::vector<std::thread>        threads;
+
+    for (std::size_t p = 0; p < producers_n; ++p)
+        threads.emplace_back([&queue, p]() -> void {
+                                 for (std::size_t i = 0; i < n; ++i)
+                                     while (! queue.try_push(p * n + i))
+                                         std::this_thread::yield();
+                             });
+    for (std::size_t c = 0; c < consumers_n; ++c)
+        threads.emplace_back([&queue, &seen, &consumed]() -> void {
+                                 while (consumed < n * producers_n)  {
+                                     const auto  value = queue.try_pop();
+
+                                     if (value.has_value())  {
+                                         ++seen[*value];
+                                         ++consumed;
+                                     }
+                                     else
+                                         std::this_thread::yield();
+                                 }
+                             });
+    for (auto &thr : threads)
+        thr.join();
+
+    assert(queue.empty());
+    for (const auto &citer : seen)
+        assert(citer == 1);
+}
+
+// ----------------------------------------------------------------------------
+
+static void ring_global_queue_test()  {
+
+    std::cout << "Running ring_global_queue_test() ..." << std::endl;
+
+    constexpr std::size_t       n { 100'003 };
+    constexpr std::size_t       the_sum { (n * (n + 1)) / 2 };
+    std::vector<std::size_t>    vec (n);
+
+    std::iota(vec.begin(), vec.end(), 1);
+
+    // A small ring, so it overflows
+    //
+    ThreadPool                              thr_pool (THREAD_COUNT,
+                                                      PoolOptions { 64 });
+    std::vector<std::future<std::size_t>>   futs;
+
+    futs.reserve(n);
+    for (std::size_t i = 0; i < n; ++i)
+        futs.push_back(thr_pool.dispatch(false,
+                                         [](std::size_t v) -> std::size_t  {
+                                             return (v);
+                                         },
+                                         vec[i]));
+
+    std::size_t result {0};
+
+    for (auto &fut : futs)
+        result += fut.get();
+    assert(result == the_sum);
+    assert(thr_pool.pending_tasks() == 0);
+}
+
+// ----------------------------------------------------------------------------
+
+static void move_only_dispatch_test()  {
+
+    std::cout << "Running move_only_dispatch_test() ..." << std::endl;
+
+    // Small callables are stored inline, big ones on the heap
+    //
+    struct  BigCallable  {
+
+        char    buffer[InlineTask::INLINE_SIZE + 1] { };
+        int     *counter { nullptr };
+
+        void operator () ()  { *counter += 1; }
+    };
+
+    int         counter { 0 };
+    InlineTask  small_task { [&counter]() -> void  { counter += 10; } };
+    InlineTask  big_task { BigCallable { { }, &counter } };
+
+    static_assert(InlineTask::is_inline_v<int (*)()>);
+    static_assert(! InlineTask::is_inline_v<BigCallable>);
+
+    InlineTask  moved_task { std::move(small_task) };
+
+    assert(! small_task);
+    assert(moved_task);
+    moved_task();
+    big_task();
+    assert(counter == 11);
+
+    ThreadPool  thr_pool (THREAD_COUNT);
+
+    // Move-only arguments and std::ref arguments
+    //
+    auto    fut1 = thr_pool.dispatch(false,
+                                     [](const std::unique_ptr<int> &ptr,
+                                        int &out) -> int  {
+                                         out = *ptr * 2;
+                                         return (*ptr);
+                                     },
+                                     std::make_unique<int>(21),
+                                     std::ref(counter));
+
+    assert(fut1.get() == 21);
+    assert(counter == 42);
+
+    // Exceptions end up in the future
+    //
+    auto    fut2 = thr_pool.dispatch(false,
+                                     []() -> void  {
+                                         throw std::runtime_error("oops");
+                                     });
+    bool    caught { false };
+
+    try  {
+        fut2.get();
+    }
+    catch (const std::runtime_error &ex)  {
+        caught = std::string(ex.what()) == "oops";
+    }
+    assert(caught);
+}
+
+// ----------------------------------------------------------------------------
+
+static void post_test()  {
+
+    std::cout << "Running post_test() ..." << std::endl;
+
+    ThreadPool                  thr_pool (THREAD_COUNT);
+    constexpr std::size_t       n { 10'000 };
+    std::atomic<std::size_t>    counter { 0 };
+    std::atomic<std::size_t>    errors { 0 };
+
+    thr_pool.set_exception_handler(
+        [&errors](std::exception_ptr ex_ptr) -> void  {
+            try  {
+                std::rethrow_exception(ex_ptr);
+            }
+            catch (const std::runtime_error &)  {
+                errors += 1;
+            }
+        });
+
+    for (std::size_t i = 0; i < n; ++i)
+        thr_pool.post([&counter](std::size_t v) -> void  {
+                          if (v % 100 == 0)
+                              throw std::runtime_error("post_test()");
+                          counter += 1;
+                      },
+                      i);
+    while (counter + errors < n)
+        std::this_thread::yield();
+    assert(counter == n - n / 100);
+    assert(errors == n / 100);
+}
+
+// ----------------------------------------------------------------------------
+
+static void bulk_dispatch_test()  {
+
+    std::cout << "Running bulk_dispatch_test() ..." << std::endl;
+
+    ThreadPool  thr_pool (THREAD_COUNT);
+
+    // With a generator
+    //
+    constexpr std::size_t   n { 1'000 };
+    auto                    futs1 =
+        thr_pool.dispatch_bulk(n, [](ThreadPool::size_type i)  {
+                                      return ([i]() -> std::size_t  {
+                                          return (std::size_t(i) * 2);
+                                      });
+                                  });
+    std::size_t             result { 0 };
+
+    assert(futs1.size() == n);
+    for (auto &fut : futs1)
+        result += fut.get();
+    assert(result == n * (n - 1));
+
+    // With a range of callables
+    //
+    std::vector<std::function<int()>>   callables;
+
+    for (int i = 0; i < 10; ++i)
+        callables.emplace_back([i]() -> int  { return (i); });
+
+    auto    futs2 = thr_pool.dispatch_bulk(callables);
+
+    assert(callables.size() == 10 && callables[9]);  // They were copied
+    for (int i = 0; i < 10; ++i)
+        assert(futs2[i].get() == i);
+
+    // Fire-and-forget
+    //
+    std::atomic<std::size_t>    counter { 0 };
+
+    thr_pool.post_bulk(n, [&counter](ThreadPool::size_type)  {
+                              return ([&counter]() -> void  { ++counter; });
+                          });
+    while (counter < n)
+        std::this_thread::yield();
+
+    // A negative count is an error, not a huge allocation
+    //
+    bool    caught { false };
+
+    try  {
+        thr_pool.dispatch_bulk(-1, [](ThreadPool::size_type)  {
+                                   return ([]() -> void  {   });
+                               });
+    }
+    catch (const std::runtime_error &)  {
+        caught = true;
+    }
+    assert(caught);
+
+    // parallel_loop copies the arguments for every block
+    //
+    const std::vector<int>  vec (100, 1);
+    auto                    futs3 =
+        thr_pool.parallel_loop(0, 100,
+                               [](int begin, int end,
+                                  const std::vector<int> &v) -> int  {
+                                   return (std::accumulate(v.begin() + begin,
+                                                           v.begin() + end,
+                                                           0));
+                               },
+                               std::vector<int>(vec));
+
+    result = 0;
+    for (auto &fut : futs3)
+        result += fut.get();
+    assert(result == 100);
+}
+
+// ----------------------------------------------------------------------------
+
+static void parking_test()  {
+
+    std::cout << "Running parking_test() ..." << std::endl;
+
+    using namespace std::chrono;
+
+    PoolOptions options { };
+
+    options.spin_count = 0;  // Park as soon as there is nothing to do
+
+    ThreadPool  thr_pool { THREAD_COUNT, options };
+
+    // Let all the threads park
+    //
+    std::this_thread::sleep_for(milliseconds(100));
+    assert(thr_pool.available_threads() == THREAD_COUNT);
+
+    // A parked thread must wake up for a task right away, not on a timeout
+    //
+    const auto  start = steady_clock::now();
+
+    thr_pool.dispatch(false, []() -> void {   }).get();
+    assert(steady_clock::now() - start < milliseconds(500));
+
+    // Tasks queued locally by a pool thread must wake up the parked threads,
+    // so they can steal them
+    //
+    constexpr std::size_t   children { 4 };
+    auto                    fut =
+        thr_pool.dispatch(
+            false,
+            [&thr_pool]() -> std::vector<std::future<std::thread::id>>  {
+                std::vector<std::future<std::thread::id>>   futs;
+
+                for (std::size_t i = 0; i < children; ++i)
+                    futs.push_back(thr_pool.dispatch(
+                        false,
+                        []() -> std::thread::id  {
+                            std::this_thread::sleep_for(milliseconds(200));
+                            return (std::this_thread::get_id());
+                        }));
+                return (futs);
+            });
+    auto                    futs = fut.get();
+    std::vector<std::thread::id>    ids;
+
+    for (auto &f : futs)  ids.push_back(f.get());
+    std::sort(ids.begin(), ids.end());
+    assert(std::unique(ids.begin(), ids.end()) - ids.begin() > 1);
+    assert(steady_clock::now() - start < milliseconds(200 * children));
+}
+
+// ----------------------------------------------------------------------------
+
+static void topology_test()  {
+
+    std::cout << "Running topology_test() ..." << std::endl;
+
+    const std::vector<unsigned int> list {
+        Topology::parse_cpu_list("0-3,8,10-11")
+    };
+
+    assert((list == std::vector<unsigned int> { 0, 1, 2, 3, 8, 10, 11 }));
+    assert(Topology::parse_cpu_list("").empty());
+
+    // 2 nodes, each with 2 L3 caches shared by 2 CPUs
+    //
+    const Topology  topology {
+        Topology::CpuVector {
+            { 0, 0, 0 }, { 1, 0, 0 }, { 2, 0, 2 }, { 3, 0, 2 },
+            { 4, 1, 4 }, { 5, 1, 4 }, { 6, 1, 6 }, { 7, 1, 6 } }
+    };
+
+    assert(topology.node_count() == 2);
+    assert(topology.find(5) && topology.find(5)->l3 == 4);
+    assert(! topology.find(8));
+
+    std::vector<unsigned int>   order;
+
+    for (const CpuInfo &cpu : topology.spread_order())
+        order.push_back(cpu.id);
+    assert((order == std::vector<unsigned int> { 0, 4, 2, 6, 1, 5, 3, 7 }));
+
+    assert(Topology::system().node_count() >= 1);
+    assert(! Topology::system().cpus().empty());
+}
+
+// ----------------------------------------------------------------------------
+
+static void numa_pool_test()  {
+
+    std::cout << "Running numa_pool_test() ..." << std::endl;
+
+    // A made-up 2 node machine. Pinning to CPUs that don't exist here
+    // fails quietly.
+    //
+    const Topology  topology {
+        Topology::CpuVector {
+            { 0, 0, 0 }, { 1, 0, 0 }, { 2, 1, 2 }, { 3, 1, 2 } }
+    };
+    PoolOptions     options { };
+
+    options.affinity = THREAD_AFFINITY::_spread_;
+    options.topology = &topology;
+
+    {
+        ThreadPool  thr_pool { 4, options };
+
+        assert(thr_pool.node_count() == 2);
+
+        auto    fut =
+            thr_pool.dispatch_on_node(1, [](int i) -> int { return (i * 2); },
+                                      21);
+
+        assert(fut.get() == 42);
+
+        bool    caught { false };
+
+        try  {
+            thr_pool.dispatch_on_node(2, []() -> void {   });
+        }
+        catch (const std::runtime_error &)  { caught = true; }
+        assert(caught);
+
+        std::vector<long>   data (100'000);
+
+        std::iota(data.begin(), data.end(), 0L);
+
+        auto    futs =
+            thr_pool.parallel_loop(
+                data.cbegin(), data.cend(),
+                [](auto begin, auto end) -> long  {
+                    return (std::accumulate(begin, end, 0L));
+                });
+        long    sum { 0 };
+
+        for (auto &f : futs)  sum += f.get();
+        assert(sum == 100'000L * 99'999L / 2);
+
+        FORK_JOIN_LEAVES = 0;
+        thr_pool.dispatch(false, fork_join, std::ref(thr_pool), 10).get();
+        assert(FORK_JOIN_LEAVES == 1024);
+        assert(thr_pool.pending_tasks() == 0);
+    }
+
+    // Pin everything to CPU 0 of this machine
+    //
+    options.affinity = THREAD_AFFINITY::_pin_;
+    options.topology = nullptr;
+    options.cpu_set = { 0 };
+
+    ThreadPool  thr_pool { 2, options };
+
+    assert(thr_pool.node_count() == 1);
+
+    const int   cpu = thr_pool.dispatch(false, Topology::current_cpu).get();
+
+    assert(cpu == 0 || cpu == -1);  // -1 if it is not supported
+}
+
+// ----------------------------------------------------------------------------
+
+static void priority_test()  {
+
+    std::cout << "Running priority_test() ..." << std::endl;
+
+    PoolOptions options { };
+
+    options.track_queue_wait = true;
+
+    // One thread, so the order of execution is the order of picks
+    //
+    ThreadPool                  thr_pool { 1, options };
+    std::atomic_bool            go { false };
+    std::atomic<std::size_t>    done { 0 };
+    std::vector<char>           order;
+    std::mutex                  order_mutex;
+    constexpr std::size_t       n { 50 };
+
+    thr_pool.post([&go]() -> void  {
+                      while (! go)  std::this_thread::yield();
+                  });
+
+    const auto  add = [&order, &order_mutex, &done](char c) -> void  {
+        const std::lock_guard<std::mutex>   guard { order_mutex };
+
+        order.push_back(c);
+        ++done;
+    };
+
+    for (std::size_t i = 0; i < n; ++i)  {
+        thr_pool.post(TASK_PRIORITY::_background_, add, 'b');
+        thr_pool.post(add, 'n');
+        thr_pool.post(TASK_PRIORITY::_high_, add, 'h');
+    }
+
+    auto    fut =
+        thr_pool.dispatch(TASK_PRIORITY::_high_, false,
+                          []() -> int { return (7); });
+
+    go = true;
+    assert(fut.get() == 7);
+    while (done < 3 * n)
+        std::this_thread::yield();
+
+    const std::lock_guard<std::mutex>   guard { order_mutex };
+
+    // High priority tasks go first, but the others are not starved
+    //
+    assert(order.front() == 'h');
+
+    const auto  last_high =
+        std::find(order.rbegin(), order.rend(), 'h').base() - order.begin();
+    const auto  first_back =
+        std::find(order.begin(), order.end(), 'b') - order.begin();
+
+    assert(last_high < long(2 * n));
+    assert(first_back < last_high);
+
+    const QueueWaitStats    high =
+        thr_pool.queue_wait_stats(TASK_PRIORITY::_high_);
+    const QueueWaitStats    back =
+        thr_pool.queue_wait_stats(TASK_PRIORITY::_background_);
+
+    assert(high.count == n + 1);
+    assert(back.count == n);
+    assert(thr_pool.queue_wait_stats(TASK_PRIORITY::_normal_).count ==
+           n + 1);
+    assert(high.mean_ns() < back.mean_ns());
+    assert(back.percentile_ns(0.5) <= back.percentile_ns(1.0));
+    assert(back.percentile_ns(1.0) == back.max_ns);
+
+    // Shutdown runs whatever is queued in the high and background lanes
+    //
+    {
+        ThreadPool                      side_pool { 2 };
+        std::promise<void>              gate;
+        const std::shared_future<void>  opened { gate.get_future().share() };
+        std::atomic<std::size_t>        started { 0 };
+        std::atomic<std::size_t>        ran { 0 };
+        std::vector<std::future<void>>  futs;
+
+        for (std::size_t i = 0; i < 2; ++i)
+            futs.push_back(
+                side_pool.dispatch(false, [&opened, &started]() -> void  {
+                                              ++started;
+                                              opened.wait();
+                                          }));
+        while (started < 2)  std::this_thread::yield();
+        for (std::size_t i = 0; i < 100; ++i)  {
+            futs.push_back(
+                side_pool.dispatch(TASK_PRIORITY::_high_, false,
+                                   [&ran]() -> void  { ++ran; }));
+            futs.push_back(
+                side_pool.dispatch(TASK_PRIORITY::_background_, false,
+                                   [&ran]() -> void  { ++ran; }));
+        }
+
+        side_pool.shutdown();
+        gate.set_value();
+        for (auto &fut : futs)  fut.get();
+        assert(ran == 200);
+    }
+
+    bool    caught { false };
+
+    try  {
+        options.priority_weights = { 1, 0, 1 };
+
+        ThreadPool  bad_pool { 1, options };
+    }
+    catch (const std::runtime_error &)  { caught = true; }
+    assert(caught);
+}
+
+// ----------------------------------------------------------------------------
+
+static std::size_t group_fork_join(ThreadPool &thr_pool, std::size_t depth)  {
+
+    if (depth == 0)  return (1);
+
+    std::size_t left { 0 };
+    TaskGroup   group { thr_pool.make_group() };
+
+    group.run([&thr_pool, &left, depth]() -> void  {
+                  left = group_fork_join(thr_pool, depth - 1);
+              });
+
+    const std::size_t   right { group_fork_join(thr_pool, depth - 1) };
+
+    group.wait();
+    return (left + right);
+}
+
+// --------------------------------------
+
+static void task_group_test()  {
+
+    std::cout << "Running task_group_test() ..." << std::endl;
+
+    ThreadPool  thr_pool { THREAD_COUNT };
+
+    // Nested groups waited on inside the pool threads
+    //
+    assert(thr_pool.dispatch(false, group_fork_join,
+                             std::ref(thr_pool), 14).get() == 1 << 14);
+
+    // Waited on by a client thread
+    //
+    {
+        std::atomic<std::size_t>    count { 0 };
+        TaskGroup                   group { thr_pool.make_group() };
+
+        for (std::size_t i = 0; i < 1000; ++i)
+            group.run([&count](std::size_t n) -> void  { count += n; }, i);
+        group.wait();
+        assert(count == 999 * 1000 / 2);
+        assert(group.pending() == 0);
+
+        // The first exception is rethrown once
+        //
+        group.run([]() -> void  { throw std::runtime_error("group"); });
+        group.run([&count]() -> void  { ++count; });
+
+        bool    caught { false };
+
+        try  {
+            group.wait();
+        }
+        catch (const std::runtime_error &ex)  {
+            caught = std::string(ex.what()) == "group";
+        }
+        assert(caught);
+        assert(count == 999 * 1000 / 2 + 1);
+        group.wait();
+    }
+
+    // Without any pool threads, the waiter runs all the tasks itself
+    //
+    ThreadPool          empty_pool { 0 };
+    std::size_t         sum { 0 };
+    std::thread::id     runner { };
+
+    {
+        TaskGroup   group { empty_pool.make_group() };
+
+        group.run([&sum, &runner]() -> void  {
+                      sum += 10;
+                      runner = std::this_thread::get_id();
+                  });
+        group.run([&sum]() -> void  { sum += 5; });
+    }  // The destructor waits
+    assert(sum == 15);
+    assert(runner == std::this_thread::get_id());
+}
+
+// ----------------------------------------------------------------------------
+
+static void continuation_test()  {
+
+    std::cout << "Running continuation_test() ..." << std::endl;
+
+    ThreadPool  thr_pool { THREAD_COUNT };
+
+    auto    str_fut =
+        thr_pool.async([](int x) -> int  { return (x * 2); }, 21)
+                .then([](int x) -> int  { return (x + 1); })
+                .then([](int x) -> std::string  {
+                          return (std::to_string(x));
+                      });
+
+    assert(str_fut.valid());
+    assert(str_fut.get() == "43");
+    assert(! str_fut.valid());
+
+    // Void results and a continuation attached after the fact
+    //
+    std::atomic<int>    count { 0 };
+    auto                void_fut =
+        thr_pool.async([&count]() -> void  { count += 1; });
+
+    void_fut.wait();
+    assert(void_fut.is_ready());
+
+    auto    int_fut =
+        void_fut.then([&count]() -> int  { return (count += 10); });
+
+    assert(! void_fut.valid());
+    assert(int_fut.get() == 11);
+
+    // An exception skips the continuations and comes out of get()
+    //
+    auto    bad_fut =
+        thr_pool.async([]() -> int  { throw std::runtime_error("then"); })
+                .then([&count](int x) -> int  { count += 100; return (x); })
+                .then([&count](int) -> void  { count += 100; });
+    bool    caught { false };
+
+    try  {
+        bad_fut.get();
+    }
+    catch (const std::runtime_error &ex)  {
+        caught = std::string(ex.what()) == "then";
+    }
+    assert(caught);
+    assert(count == 11);
+
+    // A long chain built and waited for on a pool thread
+    //
+    auto    chain = [&thr_pool]() -> std::size_t  {
+        auto    fut = thr_pool.async([]() -> std::size_t  { return (0); });
+
+        for (std::size_t i = 0; i < 10000; ++i)
+            fut = fut.then([](std::size_t n) -> std::size_t  {
+                               return (n + 1);
+                           });
+        return (fut.get());
+    };
+
+    assert(thr_pool.dispatch(false, chain).get() == 10000);
+
+    // A waiter on a pool thread keeps taking new tasks. Here the one it
+    // waits for can't finish, until the last task runs on the waiter's
+    // thread.
+    //
+    {
+        ThreadPool          pair_pool { 2 };
+        std::atomic<bool>   started { false };
+        std::atomic<bool>   released { false };
+        auto                blocked =
+            pair_pool.async([&started, &released]() -> int  {
+                started = true;
+                while (! released)  std::this_thread::yield();
+                return (7);
+            });
+
+        while (! started)  std::this_thread::yield();
+
+        auto    waiter =
+            pair_pool.async([blocked = std::move(blocked)]() mutable -> int  {
+                return (blocked.get());
+            });
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        pair_pool.post([&released]() -> void  { released = true; });
+        assert(waiter.get() == 7);
+    }
+
+    // A continuation attached while another thread shuts the pool down
+    // runs either way
+    //
+    for (std::size_t i = 0; i < 200; ++i)  {
+        ThreadPool  racing_pool { 2 };
+        auto        fut = racing_pool.async([]() -> int  { return (1); });
+
+        fut.wait();
+
+        std::thread stopper { [&racing_pool]() -> void  {
+                                  racing_pool.shutdown();
+                              } };
+        auto        next_fut =
+            fut.then([](int x) -> int  { return (x + 1); });
+
+        assert(next_fut.get() == 2);
+        stopper.join();
+    }
+
+    // A continuation still runs after the pool is shut down
+    //
+    auto    ready_fut = thr_pool.async([]() -> int  { return (5); });
+
+    ready_fut.wait();
+    thr_pool.shutdown();
+    assert(ready_fut.then([](int x) -> int  { return (x * 2); }).get() == 10);
+}
+
+// ----------------------------------------------------------------------------
+
+static void task_graph_test()  {
+
+    std::cout << "Running task_graph_test() ..." << std::endl;
+
+    ThreadPool  thr_pool { THREAD_COUNT };
+
+    // A random DAG. Every node checks that its predecessors are done.
+    //
+    constexpr std::size_t                   n { 2000 };
+    std::vector<std::vector<std::size_t>>   preds (n);
+    std::unique_ptr<std::atomic<int>[]>     done {
+        new std::atomic<int>[n]
+    };
+    std::atomic<std::size_t>                executed { 0 };
+    std::atomic<bool>                       in_order { true };
+    TaskGraph                               graph;
+    std::mt19937                            gen { 1234 };
+
+    for (std::size_t i = 0; i < n; ++i)  {
+        done[i] = 0;
+        graph.add_node([i, &preds, &done, &executed, &in_order]() -> void  {
+                           for (const std::size_t p : preds[i])
+                               if (done[p].load() <= done[i].load())
+                                   in_order = false;
+                           done[i] += 1;
+                           executed += 1;
+                       });
+        for (std::size_t e = 0; i > 0 && e < 3; ++e)  {
+            const std::size_t   from { gen() % i };
+
+            preds[i].push_back(from);
+            graph.add_edge(from, i);
+        }
+    }
+    assert(graph.nodes() == n);
+    assert(graph.edges() == (n - 1) * 3);
+    assert(graph.predecessors(n - 1) == 3);
+
+    thr_pool.run_graph(graph);
+    assert(executed == n);
+    assert(in_order);
+
+    // It may be run again, also from inside a pool thread
+    //
+    thr_pool.dispatch(false,
+                      [&thr_pool, &graph]() -> void  {
+                          thr_pool.run_graph(graph);
+                      }).get();
+    assert(executed == 2 * n);
+    assert(in_order);
+
+    // A diamond, where a failing node stops its successors
+    //
+    TaskGraph           diamond;
+    std::atomic<int>    count { 0 };
+    const auto          top =
+        diamond.add_node([&count]() -> void  { count += 1; });
+    const auto          left =
+        diamond.add_node([]() -> void  { throw std::runtime_error("node"); });
+    const auto          right =
+        diamond.add_node([&count]() -> void  { count += 10; });
+    const auto          bottom =
+        diamond.add_node([&count]() -> void  { count += 100; });
+
+    diamond.add_edge(top, left);
+    diamond.add_edge(top, right);
+    diamond.add_edge(left, bottom);
+    diamond.add_edge(right, bottom);
+
+    bool    caught { false };
+
+    try  {
+        thr_pool.run_graph(diamond);
+    }
+    catch (const std::runtime_error &ex)  {
+        caught = std::string(ex.what()) == "node";
+    }
+    assert(caught);
+    assert(count == 11);
+
+    // Cycles and bad edges are refused
+    //
+    caught = false;
+    diamond.add_edge(bottom, top);
+    try  {
+        thr_pool.run_graph(diamond);
+    }
+    catch (const std::runtime_error &)  {
+        caught = true;
+    }
+    assert(caught);
+    assert(count == 11);
+
+    caught = false;
+    try  {
+        diamond.add_edge(top, top);
+    }
+    catch (const std::runtime_error &)  {
+        caught = true;
+    }
+    assert(caught);
+
+    caught = false;
+    try  {
+        diamond.add_edge(top, 4);
+    }
+    catch (const std::runtime_error &)  {
+        caught = true;
+    }
+    assert(caught);
+
+    // Without any pool threads, the caller runs the whole graph
+    //
+    ThreadPool  empty_pool { 0 };
+    TaskGraph   chain;
+    TaskGraph   nothing;
+    std::string order;
+
+    for (char c = 'a'; c <= 'e'; ++c)  {
+        chain.add_node([&order, c]() -> void  { order += c; });
+        if (c > 'a')  chain.add_edge(chain.nodes() - 2, chain.nodes() - 1);
+    }
+    empty_pool.run_graph(chain);
+    assert(order == "abcde");
+    empty_pool.run_graph(nothing);
+}
+
+// ----------------------------------------------------------------------------
+
+static task<int> twice(int x)  { co_return (x * 2); }
+
+// --------------------------------------
+
+static task<int> hop_and_add(ThreadPool &thr_pool, std::thread::id *where)  {
+
+    co_await thr_pool.schedule();
+    *where = std::this_thread::get_id();
+
+    const int   a { co_await twice(10) };
+
+    co_await thr_pool.schedule(TASK_PRIORITY::_high_);
+
+    const int   b { co_await twice(11) };
+
+    co_return (a + b);
+}
+
+// --------------------------------------
+
+static task<long> await_many(int n)  {
+
+    long    sum { 0 };
+
+    for (int i = 0; i < n; ++i)
+        sum += co_await twice(i);
+    co_return (sum);
+}
+
+// --------------------------------------
+
+static task<> throw_on_pool(ThreadPool &thr_pool)  {
+
+    co_await thr_pool.schedule();
+    throw std::runtime_error("coroutine");
+}
+
+// --------------------------------------
+
+static task<std::unique_ptr<int>> make_unique_int(int x)  {
+
+    co_return (std::make_unique<int>(x));
+}
+
+// --------------------------------------
+
+static task<int> await_moved_from()  {
+
+    auto        original { twice(5) };
+    task<int>   thief { std::move(original) };
+
+    co_return (co_await std::move(original));
+}
+
+// --------------------------------------
+
+static void coroutine_test()  {
+
+    std::cout << "Running coroutine_test() ..." << std::endl;
+
+    ThreadPool      thr_pool { THREAD_COUNT };
+    std::thread::id where { std::this_thread::get_id() };
+
+    assert(sync_wait(hop_and_add(thr_pool, &where)) == 42);
+    assert(where != std::this_thread::get_id());
+
+    // A task doesn't start until it is awaited
+    //
+    auto    lazy { await_many(10000) };
+
+    assert(lazy.valid() && ! lazy.done());
+    assert(sync_wait(std::move(lazy)) == 10000L * 9999L);
+    assert(! lazy.valid());
+
+    assert(*sync_wait(make_unique_int(7)) == 7);
+
+    bool    caught { false };
+
+    try  {
+        sync_wait(throw_on_pool(thr_pool));
+    }
+    catch (const std::runtime_error &ex)  {
+        caught = std::string(ex.what()) == "coroutine";
+    }
+    assert(caught);
+
+    // A pool without threads can't resume anything
+    //
+    ThreadPool  empty_pool { 0 };
+
+    caught = false;
+    try  {
+        sync_wait(throw_on_pool(empty_pool));
+    }
+    catch (const std::runtime_error &ex)  {
+        caught = std::string(ex.what()) != "coroutine";
+    }
+    assert(caught);
+
+    // Awaiting a moved-from task throws like sync_wait() does
+    //
+    caught = false;
+    try  {
+        sync_wait(await_moved_from());
+    }
+    catch (const std::runtime_error &ex)  {
+        caught =
+            std::string(ex.what()).find("not valid") != std::string::npos;
+    }
+    assert(caught);
+}
+
+// ----------------------------------------------------------------------------
+
+static void loop_schedule_test()  {
+
+    std::cout << "Running loop_schedule_test() ..." << std::endl;
+
+    constexpr long              n { 10003 };
+    constexpr long              the_sum { (n * (n + 1)) / 2 };
+    std::vector<long>           vec (n);
+    ThreadPool                  thr_pool { THREAD_COUNT };
+    constexpr LOOP_SCHEDULE     schedules[] {
+        LOOP_SCHEDULE::_static_, LOOP_SCHEDULE::_dynamic_,
+        LOOP_SCHEDULE::_guided_, LOOP_SCHEDULE::_auto_,
+    };
+
+    std::iota(vec.begin(), vec.end(), 1);
+
+    // An irregular body. Later iterations cost more.
+    //
+    auto    sum_iters =
+        [](auto begin, auto end) -> long  {
+            long    sum { 0 };
+
+            for (auto iter = begin; iter != end; ++iter)  {
+                for (long i = 0; i < *iter % 64; ++i)
+                    std::atomic_signal_fence(std::memory_order_seq_cst);
+                sum += *iter;
+            }
+            return (sum);
+        };
+    auto    sum_index =
+        [](long begin, long end, const std::vector<long> &v) -> long  {
+            long    sum { 0 };
+
+            for (long i = begin; i < end; ++i)  sum += v[i];
+            return (sum);
+        };
+    auto    dot =
+        [](auto begin1, auto end1, auto begin2) -> long  {
+            long    sum { 0 };
+
+            for (; begin1 != end1; ++begin1, ++begin2)
+                sum += *begin1 * *begin2;
+            return (sum);
+        };
+
+    for (const LOOP_SCHEDULE schedule : schedules)  {
+        for (const long chunk : { 0L, 1L, 7L, 1000L, 20000L })  {
+            long    result { 0 };
+
+            for (auto &fut : thr_pool.parallel_loop(schedule, chunk,
+                                                    vec.cbegin(), vec.cend(),
+                                                    sum_iters))
+                result += fut.get();
+            assert(result == the_sum);
+
+            auto    futs = thr_pool.parallel_loop(schedule, chunk,
+                                                  0L, n,
+                                                  sum_index, std::cref(vec));
+
+            if (chunk > 0 && (schedule == LOOP_SCHEDULE::_static_ ||
+                              schedule == LOOP_SCHEDULE::_dynamic_))
+                assert(futs.size() == std::size_t((n + chunk - 1) / chunk));
+            result = 0;
+            for (auto &fut : futs)  result += fut.get();
+            assert(result == the_sum);
+
+            // Every index from begin down to end is visited once, as in the
+            // static backward loop
+            //
+            std::vector<std::atomic<int>>   visits (n + 1);
+            std::atomic<bool>               in_order { true };
+
+            for (auto &fut :
+                     thr_pool.parallel_loop(
+                         schedule, chunk,
+                         n, 0L,
+                         [&visits, &in_order](long low, long high) -> void  {
+                             if (low > high)  in_order = false;
+                             for (long i = high; i >= low; --i)
+                                 visits[i] += 1;
+                         }))
+                fut.get();
+            assert(in_order);
+            for (const auto &v : visits)  assert(v == 1);
+
+            result = 0;
+            for (auto &fut : thr_pool.parallel_loop2(schedule, chunk,
+                                                     vec.cbegin(), vec.cend(),
+                                                     vec.cbegin(), vec.cend(),
+                                                     dot))
+                result += fut.get();
+            assert(result == (n * (n + 1) * (2 * n + 1)) / 6);
+        }
+    }
+
+    // Guided chunks shrink, but not below the chunk size
+    //
+    auto    sizes =
+        thr_pool.parallel_loop(LOOP_SCHEDULE::_guided_, 10,
+                               0L, 100000L,
+                               [](long begin, long end) -> long  {
+                                   return (end - begin);
+                               });
+
+    assert(sizes.size() > THREAD_COUNT);
+    assert(sizes.front().get() > 1000);
+    for (std::size_t i = 1; i + 1 < sizes.size(); ++i)
+        assert(sizes[i].get() >= 10);
+
+    // A throwing chunk fails only its own future
+    //
+    auto    futs =
+        thr_pool.parallel_loop(LOOP_SCHEDULE::_dynamic_, 10,
+                               0L, 100L,
+                               [](long begin, long) -> long  {
+                                   if (begin == 50)
+                                       throw std::runtime_error("chunk");
+                                   return (begin);
+                               });
+    bool    caught { false };
+
+    for (auto &fut : futs)  {
+        try  {
+            fut.get();
+        }
+        catch (const std::runtime_error &)  {
+            caught = true;
+        }
+    }
+    assert(caught);
+    assert(thr_pool.parallel_loop(LOOP_SCHEDULE::_dynamic_, 10,
+                                  0L, 0L,
+                                  sum_index, std::cref(vec)).empty());
+}
+
+// ----------------------------------------------------------------------------
+
+static void find_if_test()  {
+
+    std::cout << "Running find_if_test() ..." << std::endl;
+
+    ThreadPool          thr_pool { THREAD_COUNT };
+    constexpr long      n { 10'000'000 };
+    std::vector<long>   data (n);
+
+    std::iota(data.begin(), data.end(), 0L);
+
+    // The lowest match, even if a later chunk matches first
+    //
+    for (const long target : { 0L, 1L, 4'999L, 5'000L, n / 2, n - 1 })  {
+        const auto  is_match =
+            [target](long value) -> bool  {
+                return (value >= target && value % 1'000 == target % 1'000);
+            };
+
+        assert((thr_pool.parallel_find_if(data.begin(), data.end(),
+                                          is_match) ==
+                data.begin() + target));
+        assert(thr_pool.parallel_any_of(data.begin(), data.end(), is_match));
+        assert(! thr_pool.parallel_none_of(data.begin(), data.end(),
+                                           is_match));
+    }
+    assert((thr_pool.parallel_find_if(data.begin(), data.end(),
+                                      [](long value) -> bool  {
+                                          return (value < 0);
+                                      }) == data.end()));
+    assert(thr_pool.parallel_all_of(data.begin(), data.end(),
+                                    [](long value) -> bool  {
+                                        return (value >= 0);
+                                    }));
+    assert(! thr_pool.parallel_all_of(data.begin(), data.end(),
+                                      [](long value) -> bool  {
+                                          return (value != n - 2);
+                                      }));
+    assert(thr_pool.parallel_none_of(data.begin(), data.end(),
+                                     [](long value) -> bool  {
+                                         return (value >= n);
+                                     }));
+    assert(thr_pool.parallel_all_of(data.begin(), data.begin(),
+                                    [](long) -> bool  { return (false); }));
+
+    // A match near the front stops the search. Far fewer elements than the
+    // range are looked at.
+    //
+    std::atomic<long>   calls { 0 };
+
+    assert((thr_pool.parallel_find_if(data.begin(), data.end(),
+                                      [&calls](long value) -> bool  {
+                                          calls.fetch_add(
+                                              1, std::memory_order_relaxed);
+                                          return (value == 1'000);
+                                      }) == data.begin() + 1'000));
+    std::cout << "Predicate calls for a match at 1,000 in " << n
+              << " elements: " << calls.load() << std::endl;
+    assert(calls.load() < n / 10);
+
+    // Exceptions reach the caller
+    //
+    bool    caught { false };
+
+    try  {
+        thr_pool.parallel_any_of(data.begin(), data.end(),
+                                 [](long value) -> bool  {
+                                     if (value == n / 3)
+                                         throw std::runtime_error("bad");
+                                     return (false);
+                                 });
+    }
+    catch (const std::runtime_error &)  {
+        caught = true;
+    }
+    assert(caught);
+}
+
+// ----------------------------------------------------------------------------
+
+static void cancellation_test()  {
+
+    std::cout << "Running cancellation_test() ..." << std::endl;
+
+    ThreadPool          thr_pool { THREAD_COUNT };
+    std::atomic<long>   ran { 0 };
+    const auto          was_cancelled =
+        []<typename T>(std::future<T> &fut) -> bool  {
+            try  {
+                fut.get();
+            }
+            catch (const TaskCancelled &)  {
+                return (true);
+            }
+            return (false);
+        };
+
+    // It keeps all the threads busy until the gate opens. So, whatever is
+    // dispatched after it stays in the queues.
+    //
+    const auto  block_threads =
+        [&thr_pool](std::shared_future<void> gate) -> void  {
+            std::atomic<long>   blocked { 0 };
+
+            for (long i = 0; i < THREAD_COUNT; ++i)
+                thr_pool.dispatch(false,
+                                  [&blocked, gate]() -> void  {
+                                      blocked.fetch_add(1);
+                                      gate.wait();
+                                  });
+            while (blocked.load() < THREAD_COUNT)
+                std::this_thread::yield();
+        };
+
+    // Queued tasks are dropped when cancelled
+    //
+    {
+        std::promise<void>              gate;
+        CancellationSource              source;
+        std::vector<std::future<long>>  futs;
+
+        block_threads(gate.get_future().share());
+        for (long i = 0; i < 100; ++i)
+            futs.push_back(thr_pool.dispatch(source.token(), false,
+                                             [&ran](long x) -> long  {
+                                                 ran.fetch_add(1);
+                                                 return (x);
+                                             },
+                                             i));
+        assert(source.cancel());
+        assert(! source.cancel());
+        gate.set_value();
+        for (auto &fut : futs)
+            assert(was_cancelled(fut));
+        assert(ran.load() == 0);
+
+        // Already cancelled. It is never queued.
+        //
+        auto    fut = thr_pool.dispatch(source.token(), false,
+                                        [&ran]() -> void  {
+                                            ran.fetch_add(1);
+                                        });
+
+        assert(was_cancelled(fut));
+        assert(ran.load() == 0);
+    }
+
+    // A default token is never cancelled
+    //
+    assert(! CancellationToken { }.can_be_cancelled());
+    assert((thr_pool.dispatch(CancellationToken { }, false,
+                              [](long x) -> long  { return (x * 2); },
+                              21).get() == 42));
+
+    // A running task polls its token
+    //
+    {
+        CancellationSource  source;
+        std::atomic<bool>   started { false };
+        auto                fut =
+            thr_pool.dispatch(source.token(), false,
+                              [&started](CancellationToken token) -> long  {
+                                  long  polls { 0 };
+
+                                  started.store(true);
+                                  while (! token.is_cancelled())  {
+                                      polls += 1;
+                                      std::this_thread::yield();
+                                  }
+                                  return (polls);
+                              },
+                              source.token());
+
+        while (! started.load())
+            std::this_thread::yield();
+        source.cancel();
+        assert(fut.get() >= 0);
+    }
+
+    // Loops
+    //
+    {
+        CancellationSource  source;
+        const auto          routine =
+            [&ran](long begin, long end) -> long  {
+                ran.fetch_add(end - begin);
+                return (end - begin);
+            };
+        auto                futs =
+            thr_pool.parallel_loop(source.token(), 0L, 1'000L, routine);
+        long                sum { 0 };
+
+        for (auto &fut : futs)
+            sum += fut.get();
+        assert(sum == 1'000);
+        assert(ran.exchange(0) == 1'000);
+
+        source.cancel();
+        futs = thr_pool.parallel_loop(source.token(),
+                                      LOOP_SCHEDULE::_dynamic_, 10,
+                                      0L, 1'000L,
+                                      routine);
+        for (auto &fut : futs)
+            assert(was_cancelled(fut));
+        assert(ran.load() == 0);
+    }
+
+    // Groups
+    //
+    {
+        std::promise<void>  gate;
+        CancellationSource  source;
+        TaskGroup           group { thr_pool.make_group(source.token()) };
+        bool                caught { false };
+
+        assert(group.token().can_be_cancelled());
+        block_threads(gate.get_future().share());
+        for (long i = 0; i < 50; ++i)
+            group.run([&ran]() -> void  { ran.fetch_add(1); });
+        source.cancel();
+        gate.set_value();
+        try  {
+            group.wait();
+        }
+        catch (const TaskCancelled &)  {
+            caught = true;
+        }
+        assert(caught);
+        assert(ran.load() == 0);
+        assert(group.pending() == 0);
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+static void timer_test()  {
+
+    std::cout << "Running timer_test() ..." << std::endl;
+
+    using namespace std::chrono;
+
+    ThreadPool  thr_pool { THREAD_COUNT };
+
+    // Timers never fire early
+    //
+    const auto  start { steady_clock::now() };
+    auto        [after_id, after_fut] =
+        thr_pool.dispatch_after(milliseconds { 50 },
+                                [start]() -> steady_clock::duration  {
+                                    return (steady_clock::now() - start);
+                                });
+    auto        [at_id, at_fut] =
+        thr_pool.dispatch_at(system_clock::now() + milliseconds { 20 },
+                             [](long x) -> long  { return (x + 1); },
+                             41L);
+
+    assert(at_fut.get() == 42);
+
+    const auto  waited { after_fut.get() };
+
+    std::cout << "A 50 ms timer fired after "
+              << duration_cast<microseconds>(waited).count() << " us"
+              << std::endl;
+    assert(waited >= milliseconds { 50 });
+    assert(! thr_pool.cancel_timer(after_id));  // Already fired
+
+    // Cancelled timers don't run, and their futures know
+    //
+    auto    [late_id, late_fut] =
+        thr_pool.dispatch_after(hours { 1 }, []() -> void  { assert(false); });
+
+    assert(thr_pool.pending_timers() == 1);
+    assert(thr_pool.cancel_timer(late_id));
+    assert(! thr_pool.cancel_timer(late_id));
+    assert(thr_pool.pending_timers() == 0);
+
+    bool    caught { false };
+
+    try  {
+        late_fut.get();
+    }
+    catch (const TaskCancelled &)  {
+        caught = true;
+    }
+    assert(caught);
+
+    // Periodic timers run until they are cancelled
+    //
+    std::atomic<long>   ticks { 0 };
+    const TimerId       every_id {
+        thr_pool.dispatch_every(milliseconds { 5 },
+                                [&ticks]() -> void  { ticks.fetch_add(1); })
+    };
+
+    while (ticks.load() < 10)
+        std::this_thread::sleep_for(milliseconds { 1 });
+    assert(thr_pool.cancel_timer(every_id));
+
+    // A run may have been queued just before cancelling
+    //
+    std::this_thread::sleep_for(milliseconds { 20 });
+
+    const long  ticked { ticks.load() };
+
+    std::this_thread::sleep_for(milliseconds { 20 });
+    assert(ticks.load() == ticked);
+
+    // Lots of timeouts, most of which are cancelled
+    //
+    constexpr long                  n { 100'000 };
+    std::atomic<long>               fired { 0 };
+    std::vector<TimerId>            ids;
+    std::vector<std::future<void>>  futs;
+
+    ids.reserve(n);
+    futs.reserve(n);
+    for (long i = 0; i < n; ++i)  {
+        auto    [id, fut] =
+            thr_pool.dispatch_after(milliseconds { 200 } + microseconds { i },
+                                    [&fired]() -> void  {
+                                        fired.fetch_add(1);
+                                    });
+
+        ids.push_back(id);
+        futs.push_back(std::move(fut));
+    }
+
+    long    cancelled { 0 };
+
+    for (long i = 0; i < n; i += 4)
+        cancelled += thr_pool.cancel_timer(ids[i]);
+    for (auto &fut : futs)
+        try  {
+            fut.get();
+        }
+        catch (const TaskCancelled &)  {   }
+    std::cout << "Of " << n << " timers, " << cancelled
+              << " were cancelled and " << fired.load() << " fired"
+              << std::endl;
+    assert(fired.load() + cancelled == n);
+    assert(thr_pool.pending_timers() == 0);
+}
+
+// ----------------------------------------------------------------------------
+
 int main (int, char *[])  {
 
     repeating_thread_id();
@@ -453,6 +2038,26 @@ int main (int, char *[])  {
     attach_test();
     conditioner_test();
     parallel_sort_test();
+    work_stealing_deque_test();
+    nested_dispatch_test();
+    steal_half_test();
+    bounded_mpmc_queue_test();
+    ring_global_queue_test();
+    move_only_dispatch_test();
+    post_test();
+    bulk_dispatch_test();
+    parking_test();
+    topology_test();
+    numa_pool_test();
+    priority_test();
+    task_group_test();
+    continuation_test();
+    task_graph_test();
+    coroutine_test();
+    loop_schedule_test();
+    find_if_test();
+    cancellation_test();
+    timer_test();
     haphazard();
 
     return (EXIT_SUCCESS);